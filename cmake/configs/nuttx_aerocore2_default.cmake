@@ -56,6 +56,7 @@ set(config_module_list
 	#drivers/test_ppm
 	#lib/rc/rc_tests
 	#modules/commander/commander_tests
+	#modules/navigator/navigator_tests
 	#lib/controllib/controllib_test
 	#modules/mavlink/mavlink_tests
 	#modules/unit_test
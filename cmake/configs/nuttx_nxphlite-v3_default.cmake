@@ -73,6 +73,7 @@ set(config_module_list
 ### NOT Portable YET 	drivers/test_ppm
 	#lib/rc/rc_tests
 	modules/commander/commander_tests
+	modules/navigator/navigator_tests
 	lib/controllib/controllib_test
 	modules/mavlink/mavlink_tests
 	modules/mc_pos_control/mc_pos_control_tests
@@ -81,6 +81,7 @@ set(config_module_list
 	lib/controllib/controllib_test
 	#lib/rc/rc_tests
 	modules/commander/commander_tests
+	modules/navigator/navigator_tests
 	modules/mavlink/mavlink_tests
 	modules/mc_pos_control/mc_pos_control_tests
 	modules/uORB/uORB_tests
@@ -75,6 +75,7 @@ set(config_module_list
 	modules/uORB
 	modules/dataman
 	modules/land_detector
+	modules/latency_mon
 	modules/navigator
 	modules/mavlink
 
@@ -46,6 +46,7 @@ set(config_module_list
 	systemcmds/sd_bench
 	systemcmds/top
 	systemcmds/topic_listener
+	systemcmds/trace
 	systemcmds/tune_control
 	systemcmds/ver
 
@@ -56,6 +57,7 @@ set(config_module_list
 	#drivers/test_ppm
 	lib/rc/rc_tests
 	modules/commander/commander_tests
+	modules/navigator/navigator_tests
 	lib/controllib/controllib_test
 	modules/mavlink/mavlink_tests
 	modules/mc_pos_control/mc_pos_control_tests
@@ -74,6 +76,7 @@ set(config_module_list
 	modules/events
 	#modules/gpio_led
 	modules/land_detector
+	modules/latency_mon
 	modules/load_mon
 	modules/mavlink
 	modules/navigator
@@ -195,3 +198,13 @@ if(REPLAY_FILE)
 	message("Building with uorb publisher rules support")
 	add_definitions(-DORB_USE_PUBLISHER_RULES)
 endif()
+
+# Let the simulator drive the clock (see px4_lockstep_set_time() in px4_time.h),
+# opt-in with 'lockstep=1 make posix_sitl_default'. Lockstep only takes over once
+# HIL_SENSOR messages with timestamps arrive, every step is acknowledged once all
+# tasks are blocked. Needs a simulator waiting for HIL_ACTUATOR_CONTROLS.
+set(LOCKSTEP "$ENV{lockstep}")
+if(LOCKSTEP)
+	message("Building with lockstep scheduler")
+	add_definitions(-DENABLE_LOCKSTEP_SCHEDULER)
+endif()
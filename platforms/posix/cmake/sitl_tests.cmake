@@ -21,6 +21,8 @@ set(tests
 	mavlink
 	mc_pos_control
 	mixer
+	mixer_bench
+	navigator
 	param
 	parameters
 	perf
@@ -36,6 +38,7 @@ if (${CMAKE_SYSTEM_NAME} MATCHES "Darwin")
 	list(REMOVE_ITEM tests
 		hysteresis
 		mixer
+		mixer_bench
 		uorb
 	)
 endif()
@@ -58,6 +61,26 @@ foreach(test_name ${tests})
 	set_tests_properties(${test_name} PROPERTIES PASS_REGULAR_EXPRESSION "${test_name} PASSED")
 endforeach()
 
+# the dataman test again, with the journaled backend
+set(test_name dataman)
+set(dataman_opt "-j rootfs/dataman_journal")
+configure_file(${PX4_SOURCE_DIR}/posix-configs/SITL/init/test/tests_template.in ${PX4_SOURCE_DIR}/posix-configs/SITL/init/test/tests_dataman_journal_generated)
+unset(dataman_opt)
+
+add_test(NAME dataman_journal
+	COMMAND ${PX4_SOURCE_DIR}/Tools/sitl_run.sh
+		$<TARGET_FILE:px4>
+		posix-configs/SITL/init/test
+		none
+		none
+		tests_dataman_journal_generated
+		${PX4_SOURCE_DIR}
+		${PX4_BINARY_DIR}
+	WORKING_DIRECTORY ${SITL_WORKING_DIR})
+
+set_tests_properties(dataman_journal PROPERTIES FAIL_REGULAR_EXPRESSION "dataman FAILED")
+set_tests_properties(dataman_journal PROPERTIES PASS_REGULAR_EXPRESSION "dataman PASSED")
+
 # run arbitrary commands
 set(test_cmds
 	hello
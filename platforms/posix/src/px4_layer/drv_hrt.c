@@ -190,6 +190,15 @@ int hrt_set_absolute_time_offset(int32_t time_diff_us)
  */
 hrt_abstime hrt_absolute_time(void)
 {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+	if (px4_lockstep_active()) {
+		/* the simulator owns the clock, it does not need any delay compensation */
+		return px4_lockstep_get_time();
+	}
+
+#endif
+
 	pthread_mutex_lock(&_hrt_mutex);
 
 	hrt_abstime ret;
@@ -0,0 +1,436 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file lockstep_scheduler.cpp
+ *
+ * Simulated time for SITL. Once the simulator drives the clock with
+ * px4_lockstep_set_time(), hrt_absolute_time(), px4_clock_gettime(),
+ * usleep(), sleep() and the timed waits of the platform layer (semaphores,
+ * work queues, poll) all follow the simulated clock instead of the host.
+ *
+ * PX4 tasks are lockstep participants: every wait of the platform layer
+ * counts them as blocked until they are woken by a timeout or by
+ * px4_lockstep_cond_broadcast(). The simulator acknowledges a step only once
+ * px4_lockstep_wait_idle() found all participants blocked, so every task
+ * gets to finish its work for the simulated time before time moves on.
+ *
+ * Built only with lockstep=1 (ENABLE_LOCKSTEP_SCHEDULER).
+ */
+
+#include <px4_time.h>
+#include <px4_log.h>
+
+#include <errno.h>
+#include <sched.h>
+#include <atomic>
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+namespace
+{
+
+/* a thread blocked in px4_lockstep_cond_timedwait(), lives on the waiter's stack */
+struct TimedWait {
+	pthread_cond_t *cond;
+	pthread_mutex_t *lock;
+	uint64_t time_us;
+	bool participant;	///< counted in _runnable
+	bool timeout;		///< woken by px4_lockstep_set_time()
+	bool woken;		///< woken by px4_lockstep_cond_broadcast()
+	TimedWait *next;
+};
+
+/* protects _timed_waits and _runnable */
+pthread_mutex_t _timed_waits_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t _idle_cond = PTHREAD_COND_INITIALIZER;
+TimedWait *_timed_waits = nullptr;
+
+/* participants not blocked in a lockstep wait */
+int _runnable = 0;
+
+std::atomic<uint64_t> _time_us{0};
+std::atomic<bool> _active{false};
+
+/* host clocks minus the simulated time at activation, keeps px4_clock_gettime() continuous */
+int64_t _monotonic_offset_us = 0;
+int64_t _realtime_offset_us = 0;
+
+__thread bool _participant = false;
+
+/* unregisters participants on exit, including pthread_exit() and cancellation */
+pthread_key_t _participant_key;
+pthread_once_t _participant_key_once = PTHREAD_ONCE_INIT;
+
+int64_t host_time_us(clockid_t clk_id)
+{
+	struct timespec ts;
+	clock_gettime(clk_id, &ts);
+	return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int host_usleep(useconds_t usec)
+{
+	struct timespec ts;
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+
+	while (nanosleep(&ts, &ts) != 0) {
+		if (errno != EINTR) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* called with _timed_waits_mutex held */
+void runnable_add(int count)
+{
+	_runnable += count;
+
+	if (_runnable <= 0) {
+		pthread_cond_broadcast(&_idle_cond);
+	}
+}
+
+void participant_exit(void *)
+{
+	pthread_mutex_lock(&_timed_waits_mutex);
+	runnable_add(-1);
+	pthread_mutex_unlock(&_timed_waits_mutex);
+}
+
+void participant_key_create()
+{
+	pthread_key_create(&_participant_key, participant_exit);
+}
+
+/* called with _timed_waits_mutex held */
+void timed_wait_remove(TimedWait *wait)
+{
+	for (TimedWait **it = &_timed_waits; *it != nullptr; it = &(*it)->next) {
+		if (*it == wait) {
+			*it = wait->next;
+			break;
+		}
+	}
+}
+
+/* a waiter got cancelled in pthread_cond_wait(), which returns with its lock held */
+void timed_wait_cancel(void *arg)
+{
+	TimedWait *wait = (TimedWait *)arg;
+
+	pthread_mutex_lock(&_timed_waits_mutex);
+	timed_wait_remove(wait);
+
+	if (wait->participant && !wait->timeout && !wait->woken) {
+		// nobody counted it as runnable again, participant_exit() will take it off
+		runnable_add(1);
+	}
+
+	pthread_mutex_unlock(&_timed_waits_mutex);
+
+	pthread_mutex_unlock(wait->lock);
+}
+
+} // namespace
+
+void px4_lockstep_task_spawning()
+{
+	pthread_mutex_lock(&_timed_waits_mutex);
+	runnable_add(1);
+	pthread_mutex_unlock(&_timed_waits_mutex);
+}
+
+void px4_lockstep_task_spawn_failed()
+{
+	participant_exit(nullptr);
+}
+
+void px4_lockstep_register_thread()
+{
+	if (_participant) {
+		return;
+	}
+
+	// counted as runnable by px4_lockstep_task_spawning() already
+	pthread_once(&_participant_key_once, participant_key_create);
+
+	_participant = true;
+	pthread_setspecific(_participant_key, &_participant);
+}
+
+void px4_lockstep_unregister_thread()
+{
+	if (!_participant) {
+		return;
+	}
+
+	pthread_setspecific(_participant_key, nullptr);
+	_participant = false;
+
+	participant_exit(nullptr);
+}
+
+void px4_lockstep_set_time(uint64_t time_us)
+{
+	if (!_active.load()) {
+		pthread_mutex_lock(&_timed_waits_mutex);
+
+		if (!_active.load()) {
+			_monotonic_offset_us = host_time_us(CLOCK_MONOTONIC) - (int64_t)time_us;
+			_realtime_offset_us = host_time_us(CLOCK_REALTIME) - (int64_t)time_us;
+			_time_us.store(time_us);
+			_active.store(true);
+			PX4_INFO("lockstep: simulator drives the clock from %llu us", (unsigned long long)time_us);
+		}
+
+		pthread_mutex_unlock(&_timed_waits_mutex);
+	}
+
+	bool retry;
+
+	do {
+		retry = false;
+
+		pthread_mutex_lock(&_timed_waits_mutex);
+
+		if (time_us > _time_us.load()) {
+			_time_us.store(time_us);
+		}
+
+		for (TimedWait *wait = _timed_waits; wait != nullptr; wait = wait->next) {
+			if (wait->timeout || wait->woken || wait->time_us > _time_us.load()) {
+				continue;
+			}
+
+			/*
+			 * The waiter takes _timed_waits_mutex while holding its own lock,
+			 * so only try it here and come back after letting go of ours.
+			 */
+			if (pthread_mutex_trylock(wait->lock) == 0) {
+				wait->timeout = true;
+
+				// runnable from now on, before the simulator can see it idle
+				if (wait->participant) {
+					runnable_add(1);
+				}
+
+				pthread_cond_broadcast(wait->cond);
+				pthread_mutex_unlock(wait->lock);
+
+			} else {
+				retry = true;
+			}
+		}
+
+		pthread_mutex_unlock(&_timed_waits_mutex);
+
+		if (retry) {
+			sched_yield();
+		}
+
+	} while (retry);
+}
+
+void px4_lockstep_wait_idle()
+{
+	pthread_mutex_lock(&_timed_waits_mutex);
+
+	bool warned = false;
+
+	while (_runnable > 0) {
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += 1;
+
+		if (pthread_cond_timedwait(&_idle_cond, &_timed_waits_mutex, &ts) == ETIMEDOUT && !warned) {
+			PX4_WARN("lockstep: %i tasks did not block within 1 s", _runnable);
+			warned = true;
+		}
+	}
+
+	pthread_mutex_unlock(&_timed_waits_mutex);
+}
+
+bool px4_lockstep_active()
+{
+	return _active.load();
+}
+
+uint64_t px4_lockstep_get_time()
+{
+	return _time_us.load();
+}
+
+int px4_lockstep_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *lock, uint64_t time_us)
+{
+	TimedWait wait = {cond, lock, time_us, _participant, false, false, nullptr};
+
+	pthread_mutex_lock(&_timed_waits_mutex);
+
+	if (time_us <= _time_us.load()) {
+		pthread_mutex_unlock(&_timed_waits_mutex);
+		return ETIMEDOUT;
+	}
+
+	wait.next = _timed_waits;
+	_timed_waits = &wait;
+
+	if (wait.participant) {
+		runnable_add(-1);
+	}
+
+	pthread_mutex_unlock(&_timed_waits_mutex);
+
+	/*
+	 * Both flags are only set while holding lock. Other wakeups are ignored,
+	 * nobody accounted for them.
+	 */
+	int ret = 0;
+	pthread_cleanup_push(timed_wait_cancel, &wait);
+
+	while (ret == 0 && !wait.timeout && !wait.woken) {
+		ret = pthread_cond_wait(cond, lock);
+	}
+
+	pthread_cleanup_pop(0);
+
+	pthread_mutex_lock(&_timed_waits_mutex);
+
+	timed_wait_remove(&wait);
+
+	if (ret != 0 && wait.participant && !wait.timeout && !wait.woken) {
+		runnable_add(1);
+	}
+
+	pthread_mutex_unlock(&_timed_waits_mutex);
+
+	if (ret == 0 && !wait.woken) {
+		ret = ETIMEDOUT;
+	}
+
+	return ret;
+}
+
+int px4_lockstep_cond_broadcast(pthread_cond_t *cond)
+{
+	pthread_mutex_lock(&_timed_waits_mutex);
+
+	for (TimedWait *wait = _timed_waits; wait != nullptr; wait = wait->next) {
+		if (wait->cond == cond && !wait->timeout && !wait->woken) {
+			wait->woken = true;
+
+			if (wait->participant) {
+				runnable_add(1);
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&_timed_waits_mutex);
+
+	return pthread_cond_broadcast(cond);
+}
+
+int px4_usleep(useconds_t usec)
+{
+	if (!_active.load()) {
+		return host_usleep(usec);
+	}
+
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+	const uint64_t time_us = _time_us.load() + usec;
+
+	pthread_mutex_lock(&lock);
+
+	while (px4_lockstep_cond_timedwait(&cond, &lock, time_us) != ETIMEDOUT) {
+	}
+
+	pthread_mutex_unlock(&lock);
+
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&lock);
+
+	return 0;
+}
+
+int system_usleep(useconds_t usec)
+{
+	return host_usleep(usec);
+}
+
+/*
+ * Replace usleep() and sleep() of the C library for the whole binary, so that
+ * modules sleeping directly are on the simulated clock as well.
+ */
+int usleep(useconds_t usec)
+{
+	return px4_usleep(usec);
+}
+
+unsigned int sleep(unsigned int sec)
+{
+	px4_usleep((useconds_t)sec * 1000000);
+	return 0;
+}
+
+#if !defined(__PX4_APPLE_LEGACY)
+int px4_clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+	if (!_active.load()) {
+		return clock_gettime(clk_id, tp);
+	}
+
+	int64_t time_us = (int64_t)_time_us.load();
+
+	if (clk_id == CLOCK_REALTIME) {
+		time_us += _realtime_offset_us;
+
+	} else if (clk_id == CLOCK_MONOTONIC) {
+		time_us += _monotonic_offset_us;
+
+	} else {
+		/* CPU time clocks and friends keep running on the host */
+		return clock_gettime(clk_id, tp);
+	}
+
+	tp->tv_sec = time_us / 1000000;
+	tp->tv_nsec = (time_us % 1000000) * 1000;
+	return 0;
+}
+#endif
+
+#endif /* ENABLE_LOCKSTEP_SCHEDULER */
@@ -0,0 +1,381 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_posix_memory.cpp
+ *
+ * Stack high-water marks and heap accounting per task. The unused stack of a
+ * task is painted when it starts, the high-water mark is where the paint was
+ * overwritten. Heap allocations are counted by wrapping the glibc allocator.
+ */
+
+#include <px4_tasks.h>
+#include <px4_posix.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__PX4_LINUX) || defined(__PX4_DARWIN)
+#define PX4_STACK_PAINTING 1
+#endif
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define PX4_SANITIZER 1
+#endif
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define PX4_SANITIZER 1
+#endif
+
+// the sanitizers bring their own allocator
+#if defined(__PX4_LINUX) && defined(__GLIBC__) && !defined(PX4_SANITIZER)
+#define PX4_HEAP_ACCOUNTING 1
+#include <malloc.h>
+#endif
+
+#define PX4_MAX_TASK_MEMORY 64
+
+static constexpr uint32_t STACK_PAINT = 0xdeadbeef;
+
+struct heap_counters {
+	int64_t current;	///< bytes allocated minus bytes freed
+	int64_t peak;
+	uint64_t allocations;
+};
+
+struct task_memory {
+	bool active;
+	char name[16];
+	int stack_requested;	///< stack size passed to px4_task_spawn_cmd()
+	uint8_t *stack_bottom;	///< lowest address of the stack
+	size_t stack_size;
+	heap_counters heap;
+};
+
+static task_memory task_memory_table[PX4_MAX_TASK_MEMORY] = {};
+static heap_counters heap_other = {};		///< threads not started with px4_task_spawn_cmd()
+static pthread_mutex_t task_memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t task_memory_key;
+static pthread_once_t task_memory_key_once = PTHREAD_ONCE_INIT;
+
+static __thread task_memory *current_task = nullptr;
+
+static void task_memory_release(void *ptr)
+{
+	// holding the mutex also keeps the stack mapped while px4_show_task_memory() scans it
+	pthread_mutex_lock(&task_memory_mutex);
+	current_task = nullptr;
+	((task_memory *)ptr)->active = false;
+	pthread_mutex_unlock(&task_memory_mutex);
+}
+
+static void task_memory_key_create()
+{
+	pthread_key_create(&task_memory_key, task_memory_release);
+}
+
+#ifdef PX4_STACK_PAINTING
+static void __attribute__((noinline)) paint_stack(uint8_t **stack_bottom, size_t *stack_size)
+{
+	void *addr = nullptr;
+	size_t size = 0;
+
+#if defined(__PX4_LINUX)
+	pthread_attr_t attr;
+
+	if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+		pthread_attr_getstack(&attr, &addr, &size);
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 27)
+		// before glibc 2.27, the reported stack of a thread starts with its guard page
+		size_t guard_size = 0;
+
+		if (pthread_attr_getguardsize(&attr, &guard_size) == 0 && guard_size < size) {
+			addr = (uint8_t *)addr + guard_size;
+			size -= guard_size;
+		}
+
+#endif
+		pthread_attr_destroy(&attr);
+	}
+
+#else
+	size = pthread_get_stacksize_np(pthread_self());
+	addr = (uint8_t *)pthread_get_stackaddr_np(pthread_self()) - size;
+#endif
+
+	if (addr == nullptr || size == 0) {
+		return;
+	}
+
+	// leave the frame of this function alone
+	uint8_t *limit = (uint8_t *)__builtin_frame_address(0) - 512;
+
+	for (volatile uint32_t *word = (uint32_t *)addr; (uint8_t *)(word + 1) <= limit; word++) {
+		*word = STACK_PAINT;
+	}
+
+	*stack_bottom = (uint8_t *)addr;
+	*stack_size = size;
+}
+
+/** bytes of the stack that were used at some point, from the top */
+static size_t stack_high_water(const task_memory *task)
+{
+	const uint32_t *word = (const uint32_t *)task->stack_bottom;
+	const uint32_t *top = (const uint32_t *)(task->stack_bottom + task->stack_size);
+
+	while (word < top && *word == STACK_PAINT) {
+		word++;
+	}
+
+	return (const uint8_t *)top - (const uint8_t *)word;
+}
+#endif
+
+void px4_task_memory_register(const char *name, int stack_size)
+{
+	pthread_once(&task_memory_key_once, task_memory_key_create);
+
+	uint8_t *stack_bottom = nullptr;
+	size_t stack_size_bytes = 0;
+
+#ifdef PX4_STACK_PAINTING
+	paint_stack(&stack_bottom, &stack_size_bytes);
+#endif
+
+	pthread_mutex_lock(&task_memory_mutex);
+
+	task_memory *task = nullptr;
+
+	for (int i = 0; i < PX4_MAX_TASK_MEMORY; i++) {
+		if (!task_memory_table[i].active) {
+			task = &task_memory_table[i];
+			break;
+		}
+	}
+
+	if (task != nullptr) {
+		memset(task, 0, sizeof(*task));
+		strncpy(task->name, name, sizeof(task->name) - 1);
+		task->stack_requested = stack_size;
+		task->stack_bottom = stack_bottom;
+		task->stack_size = stack_size_bytes;
+		task->active = true;
+	}
+
+	pthread_mutex_unlock(&task_memory_mutex);
+
+	if (task == nullptr) {
+		return;
+	}
+
+	pthread_setspecific(task_memory_key, task);
+	current_task = task;
+}
+
+#ifdef PX4_HEAP_ACCOUNTING
+
+extern "C" {
+	void *__libc_malloc(size_t size);
+	void *__libc_calloc(size_t nmemb, size_t size);
+	void *__libc_realloc(void *ptr, size_t size);
+	void *__libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void *ptr);
+}
+
+static inline heap_counters *current_heap()
+{
+	task_memory *task = current_task;
+	return task ? &task->heap : &heap_other;
+}
+
+static inline void account_alloc(void *ptr)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+
+	heap_counters *heap = current_heap();
+	const int64_t current = __atomic_add_fetch(&heap->current, (int64_t)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+	int64_t peak = __atomic_load_n(&heap->peak, __ATOMIC_RELAXED);
+
+	while (current > peak && !__atomic_compare_exchange_n(&heap->peak, &peak, current, true, __ATOMIC_RELAXED,
+			__ATOMIC_RELAXED)) {
+	}
+
+	__atomic_add_fetch(&heap->allocations, 1, __ATOMIC_RELAXED);
+}
+
+static inline void account_free(void *ptr)
+{
+	if (ptr != nullptr) {
+		__atomic_sub_fetch(&current_heap()->current, (int64_t)malloc_usable_size(ptr), __ATOMIC_RELAXED);
+	}
+}
+
+extern "C" {
+
+	void *malloc(size_t size)
+	{
+		void *ptr = __libc_malloc(size);
+		account_alloc(ptr);
+		return ptr;
+	}
+
+	void *calloc(size_t nmemb, size_t size)
+	{
+		void *ptr = __libc_calloc(nmemb, size);
+		account_alloc(ptr);
+		return ptr;
+	}
+
+	void *realloc(void *ptr, size_t size)
+	{
+		const size_t old_size = ptr ? malloc_usable_size(ptr) : 0;
+		void *new_ptr = __libc_realloc(ptr, size);
+
+		if (new_ptr != nullptr || size == 0) {
+			__atomic_sub_fetch(&current_heap()->current, (int64_t)old_size, __ATOMIC_RELAXED);
+			account_alloc(new_ptr);
+		}
+
+		return new_ptr;
+	}
+
+	void *memalign(size_t alignment, size_t size)
+	{
+		void *ptr = __libc_memalign(alignment, size);
+		account_alloc(ptr);
+		return ptr;
+	}
+
+	void *aligned_alloc(size_t alignment, size_t size)
+	{
+		return memalign(alignment, size);
+	}
+
+	int posix_memalign(void **memptr, size_t alignment, size_t size)
+	{
+		if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+			return EINVAL;
+		}
+
+		void *ptr = memalign(alignment, size);
+
+		if (ptr == nullptr) {
+			return ENOMEM;
+		}
+
+		*memptr = ptr;
+		return 0;
+	}
+
+	void free(void *ptr)
+	{
+		account_free(ptr);
+		__libc_free(ptr);
+	}
+
+}
+
+#endif /* PX4_HEAP_ACCOUNTING */
+
+void px4_show_task_memory()
+{
+	// a stack size argument s gives PX4_STACK_ADJUSTED(s) bytes
+	const int stack_scale = __SIZEOF_POINTER__ >> 2;
+
+	printf("%-16s %8s %8s %8s %5s %8s", "TASK", "REQUEST", "STACK", "USED", "%", "RECOMM");
+#ifdef PX4_HEAP_ACCOUNTING
+	printf(" %10s %10s %8s", "HEAP", "HEAP PEAK", "ALLOCS");
+#endif
+	printf("\n");
+
+	pthread_mutex_lock(&task_memory_mutex);
+
+	for (int i = 0; i < PX4_MAX_TASK_MEMORY; i++) {
+		const task_memory &task = task_memory_table[i];
+
+		if (!task.active) {
+			continue;
+		}
+
+		printf("%-16s %8i", task.name, task.stack_requested);
+
+#ifdef PX4_STACK_PAINTING
+
+		if (task.stack_size > 0) {
+			const size_t used = stack_high_water(&task);
+
+			// 25% margin, at least 1 KB, converted back to a px4_task_spawn_cmd() argument
+			const size_t margin = (used / 4 > 1024) ? used / 4 : 1024;
+			const long needed = (long)(used + margin) - PX4_STACK_OVERHEAD;
+			long recommended = (needed > 0) ? (needed + stack_scale - 1) / stack_scale : 0;
+			recommended = (recommended + 63) & ~63L;
+
+			printf(" %8u %8u %4u%% %8li%s", (unsigned)task.stack_size, (unsigned)used,
+			       (unsigned)(used * 100 / task.stack_size), recommended, (used * 10 > task.stack_size * 9) ? "!" : " ");
+
+		} else
+#endif
+		{
+			printf(" %8s %8s %5s %8s ", "-", "-", "-", "-");
+		}
+
+#ifdef PX4_HEAP_ACCOUNTING
+		printf("%10lli %10lli %8llu", (long long)task.heap.current, (long long)task.heap.peak,
+		       (unsigned long long)task.heap.allocations);
+#endif
+		printf("\n");
+	}
+
+#ifdef PX4_HEAP_ACCOUNTING
+	printf("%-16s %8s %8s %8s %5s %8s  %10lli %10lli %8llu\n", "(other)", "", "", "", "", "",
+	       (long long)heap_other.current, (long long)heap_other.peak, (unsigned long long)heap_other.allocations);
+#endif
+
+	pthread_mutex_unlock(&task_memory_mutex);
+
+	printf("\nRECOMM is the stack size argument for the measured high-water mark plus 25%% (at least 1 KB),\n"
+	       "scaled by %i and offset by %i bytes like px4_task_spawn_cmd() does. ! marks stacks more than 90%% used.\n",
+	       stack_scale, PX4_STACK_OVERHEAD);
+#ifdef PX4_HEAP_ACCOUNTING
+	printf("HEAP is allocated minus freed bytes, memory freed by another task is counted there.\n");
+#endif
+}
@@ -0,0 +1,263 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_posix_placement.cpp
+ *
+ * CPU affinity and SCHED_FIFO priority rules for threads on multi-core Linux
+ * targets. Rules are matched against thread names, so they also cover helper
+ * threads that are not started through px4_task_spawn_cmd() but name
+ * themselves with px4_prctl().
+ */
+
+#include <px4_tasks.h>
+#include <px4_log.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__PX4_LINUX)
+
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define PX4_MAX_PLACEMENT_RULES 16
+
+struct placement_rule {
+	char name[16]; ///< thread name prefix, "*" for all other threads
+	uint64_t cpu_mask;
+	int priority;
+};
+
+static placement_rule placement_rules[PX4_MAX_PLACEMENT_RULES] = {};
+static int placement_rule_count = 0;
+static pthread_mutex_t placement_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* the rule with the longest matching prefix, else "*", else null. Call with placement_mutex held */
+static const placement_rule *find_rule(const char *thread_name)
+{
+	const placement_rule *match = nullptr;
+	size_t match_len = 0;
+
+	for (int i = 0; i < placement_rule_count; i++) {
+		const placement_rule &rule = placement_rules[i];
+		const size_t len = strlen(rule.name);
+
+		if (strcmp(rule.name, "*") == 0) {
+			if (match == nullptr) {
+				match = &rule;
+			}
+
+		} else if (strncmp(thread_name, rule.name, len) == 0 && len > match_len) {
+			match = &rule;
+			match_len = len;
+		}
+	}
+
+	return match;
+}
+
+static int apply_rule(pid_t tid, const placement_rule *rule)
+{
+	int ret = 0;
+
+	if (rule->cpu_mask != 0) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+
+		for (int cpu = 0; cpu < 64; cpu++) {
+			if (rule->cpu_mask & (1ULL << cpu)) {
+				CPU_SET(cpu, &cpus);
+			}
+		}
+
+		if (sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+			ret = -errno;
+		}
+	}
+
+	if (rule->priority >= 0) {
+		struct sched_param param = {};
+		param.sched_priority = rule->priority;
+
+		if (sched_setscheduler(tid, SCHED_FIFO, &param) != 0 && ret == 0) {
+			ret = -errno;
+		}
+	}
+
+	return ret;
+}
+
+int px4_task_set_placement(const char *name, uint64_t cpu_mask, int priority)
+{
+	if (name == nullptr || name[0] == '\0' || strlen(name) >= sizeof(placement_rules[0].name)) {
+		return -EINVAL;
+	}
+
+	if (priority > SCHED_PRIORITY_MAX || (priority >= 0 && priority < SCHED_PRIORITY_MIN)) {
+		return -EINVAL;
+	}
+
+	const long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+	if (num_cpus > 0 && num_cpus < 64 && (cpu_mask >> num_cpus) != 0) {
+		return -EINVAL;
+	}
+
+	pthread_mutex_lock(&placement_mutex);
+
+	placement_rule *rule = nullptr;
+
+	for (int i = 0; i < placement_rule_count; i++) {
+		if (strcmp(placement_rules[i].name, name) == 0) {
+			rule = &placement_rules[i];
+			break;
+		}
+	}
+
+	if (rule == nullptr) {
+		if (placement_rule_count >= PX4_MAX_PLACEMENT_RULES) {
+			pthread_mutex_unlock(&placement_mutex);
+			return -ENOSPC;
+		}
+
+		rule = &placement_rules[placement_rule_count++];
+		strcpy(rule->name, name);
+	}
+
+	rule->cpu_mask = cpu_mask;
+	rule->priority = priority;
+
+	/* move the threads already running which this rule now governs */
+	int ret = 0;
+	DIR *dir = opendir("/proc/self/task");
+
+	if (dir != nullptr) {
+		struct dirent *entry;
+
+		while ((entry = readdir(dir)) != nullptr) {
+			if (entry->d_name[0] == '.') {
+				continue;
+			}
+
+			char path[32 + sizeof(entry->d_name)];
+			char thread_name[16] = {};
+			snprintf(path, sizeof(path), "/proc/self/task/%s/comm", entry->d_name);
+			FILE *comm = fopen(path, "r");
+
+			if (comm == nullptr) {
+				continue;
+			}
+
+			if (fgets(thread_name, sizeof(thread_name), comm) != nullptr) {
+				thread_name[strcspn(thread_name, "\n")] = '\0';
+
+				if (find_rule(thread_name) == rule) {
+					int rv = apply_rule(atoi(entry->d_name), rule);
+
+					if (rv != 0 && ret == 0) {
+						ret = rv;
+					}
+				}
+			}
+
+			fclose(comm);
+		}
+
+		closedir(dir);
+	}
+
+	pthread_mutex_unlock(&placement_mutex);
+
+	return ret;
+}
+
+void px4_task_apply_placement(const char *name)
+{
+	pthread_mutex_lock(&placement_mutex);
+
+	const placement_rule *rule = find_rule(name);
+
+	if (rule != nullptr) {
+		int ret = apply_rule(syscall(SYS_gettid), rule);
+
+		if (ret != 0) {
+			PX4_WARN("placement of %s failed (%s)", name, strerror(-ret));
+		}
+	}
+
+	pthread_mutex_unlock(&placement_mutex);
+}
+
+void px4_show_task_placement()
+{
+	pthread_mutex_lock(&placement_mutex);
+
+	PX4_INFO("Task placement (%d rules):", placement_rule_count);
+
+	for (int i = 0; i < placement_rule_count; i++) {
+		const placement_rule &rule = placement_rules[i];
+		char prio[8] = "-";
+
+		if (rule.priority >= 0) {
+			snprintf(prio, sizeof(prio), "%d", rule.priority);
+		}
+
+		PX4_INFO("   %-16s cpus 0x%llx prio %s", rule.name, (unsigned long long)rule.cpu_mask, prio);
+	}
+
+	pthread_mutex_unlock(&placement_mutex);
+}
+
+#else
+
+int px4_task_set_placement(const char *name, uint64_t cpu_mask, int priority)
+{
+	return -ENOTSUP;
+}
+
+void px4_task_apply_placement(const char *name)
+{
+}
+
+void px4_show_task_placement()
+{
+	PX4_INFO("Task placement is only supported on Linux");
+}
+
+#endif
@@ -58,6 +58,7 @@
 
 #include <px4_tasks.h>
 #include <px4_posix.h>
+#include <px4_time.h>
 #include <systemlib/err.h>
 
 #define MAX_CMD_LEN 100
@@ -80,6 +81,7 @@ static task_entry taskmap[PX4_MAX_TASKS] = {};
 typedef struct {
 	px4_main_t entry;
 	char name[16]; //pthread_setname_np is restricted to 16 chars
+	int stack_size;
 	int argc;
 	char *argv[];
 	// strings are allocated after the struct data
@@ -102,6 +104,14 @@ static void *entry_adapter(void *ptr)
 		PX4_ERR("px4_task_spawn_cmd: failed to set name of thread %d %d\n", rv, errno);
 	}
 
+	px4_task_apply_placement(data->name);
+	px4_task_memory_register(data->name, data->stack_size);
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	// the simulator steps only once all tasks are blocked
+	px4_lockstep_register_thread();
+#endif
+
 	data->entry(data->argc, data->argv);
 	free(ptr);
 	PX4_DEBUG("Before px4_task_exit");
@@ -155,6 +165,7 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 	strncpy(taskdata->name, name, 16);
 	taskdata->name[15] = 0;
 	taskdata->entry = entry;
+	taskdata->stack_size = stack_size;
 	taskdata->argc = argc;
 
 	for (i = 0; i < argc; i++) {
@@ -248,6 +259,11 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 		return -ENOSPC;
 	}
 
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	// runnable from here on, the simulator must not step before the task got to run
+	px4_lockstep_task_spawning();
+#endif
+
 	rv = pthread_create(&taskmap[taskid].pid, &attr, &entry_adapter, (void *) taskdata);
 
 	if (rv != 0) {
@@ -258,6 +274,9 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 
 			if (rv != 0) {
 				PX4_ERR("px4_task_spawn_cmd: failed to create thread %d %d\n", rv, errno);
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+				px4_lockstep_task_spawn_failed();
+#endif
 				taskmap[taskid].isused = false;
 				pthread_attr_destroy(&attr);
 				pthread_mutex_unlock(&task_mutex);
@@ -266,6 +285,9 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 			}
 
 		} else {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+			px4_lockstep_task_spawn_failed();
+#endif
 			pthread_attr_destroy(&attr);
 			pthread_mutex_unlock(&task_mutex);
 			free(taskdata);
@@ -438,6 +460,7 @@ int px4_prctl(int option, const char *arg2, px4_task_t pid)
 #else
 		rv = pthread_setname_np(pthread_self(), arg2);
 #endif
+		px4_task_apply_placement(arg2);
 		break;
 
 	default:
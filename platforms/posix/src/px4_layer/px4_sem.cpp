@@ -45,15 +45,18 @@
 #include <pthread.h>
 #include <errno.h>
 
-#if defined(__PX4_DARWIN) || defined(__PX4_CYGWIN)
+#if defined(__PX4_DARWIN) || defined(__PX4_CYGWIN) || defined(ENABLE_LOCKSTEP_SCHEDULER)
 
 #include <px4_posix.h>
+#include <px4_time.h>
+#include <drivers/drv_hrt.h>
 
 int px4_sem_init(px4_sem_t *s, int pshared, unsigned value)
 {
 	// We do not used the process shared arg
 	(void)pshared;
 	s->value = value;
+	s->wakeups = 0;
 	pthread_cond_init(&(s->wait), NULL);
 	pthread_mutex_init(&(s->lock), NULL);
 
@@ -76,7 +79,18 @@ int px4_sem_wait(px4_sem_t *s)
 	s->value--;
 
 	if (s->value < 0) {
-		ret = pthread_cond_wait(&(s->wait), &(s->lock));
+		do {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+			/* no timeout, but the waiting task counts as blocked for lockstep */
+			ret = px4_lockstep_cond_timedwait(&(s->wait), &(s->lock), UINT64_MAX);
+#else
+			ret = pthread_cond_wait(&(s->wait), &(s->lock));
+#endif
+		} while (ret == 0 && s->wakeups == 0);
+
+		if (ret == 0) {
+			s->wakeups--;
+		}
 
 	} else {
 		ret = 0;
@@ -124,7 +138,43 @@ int px4_sem_timedwait(px4_sem_t *s, const struct timespec *abstime)
 	errno = 0;
 
 	if (s->value < 0) {
-		ret = pthread_cond_timedwait(&(s->wait), &(s->lock), abstime);
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+		const bool lockstep = px4_lockstep_active();
+		uint64_t timeout_us = 0;
+
+		if (lockstep) {
+			/* abstime is on the simulated CLOCK_REALTIME, wait for the same interval of simulated time */
+			struct timespec now;
+			px4_clock_gettime(CLOCK_REALTIME, &now);
+			const uint64_t abstime_us = ts_to_abstime(const_cast<struct timespec *>(abstime));
+			const uint64_t now_us = ts_to_abstime(&now);
+			timeout_us = px4_lockstep_get_time() + (abstime_us > now_us ? abstime_us - now_us : 0);
+		}
+
+#endif
+
+		do {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+			if (lockstep) {
+				ret = px4_lockstep_cond_timedwait(&(s->wait), &(s->lock), timeout_us);
+
+			} else
+#endif
+			{
+				ret = pthread_cond_timedwait(&(s->wait), &(s->lock), abstime);
+			}
+		} while (ret == 0 && s->wakeups == 0);
+
+		if (s->wakeups > 0) {
+			/* a post arrived, possibly racing with the timeout */
+			s->wakeups--;
+			ret = 0;
+
+		} else {
+			/* give the count back, nobody posted for us */
+			s->value++;
+		}
 
 	} else {
 		ret = 0;
@@ -157,7 +207,12 @@ int px4_sem_post(px4_sem_t *s)
 	s->value++;
 
 	if (s->value <= 0) {
+		s->wakeups++;
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+		ret = px4_lockstep_cond_broadcast(&(s->wait));
+#else
 		ret = pthread_cond_signal(&(s->wait));
+#endif
 
 	} else {
 		ret = 0;
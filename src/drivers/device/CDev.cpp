@@ -318,6 +318,17 @@ CDev::poll(file_t *filep, px4_pollfd_struct_t *fds, bool setup)
 	return ret;
 }
 
+pollevent_t
+CDev::poll_check(file_t *filep, px4_pollfd_struct_t *fds)
+{
+	lock();
+	fds->revents = fds->events & poll_state(filep);
+	pollevent_t revents = fds->revents;
+	unlock();
+
+	return revents;
+}
+
 void
 CDev::poll_notify(pollevent_t events)
 {
@@ -75,6 +75,13 @@ public:
 
 	virtual int	init();
 
+	/**
+	 * Get the device name.
+	 *
+	 * @return the file system string of the device handle
+	 */
+	const char	*get_devname() { return _devname; }
+
 	/**
 	 * Handle an open of the device.
 	 *
@@ -160,6 +167,16 @@ public:
 	 */
 	virtual int	poll(file_t *filep, px4_pollfd_struct_t *fds, bool setup);
 
+	/**
+	 * Re-evaluate the events of a poll waiter that stays set up across
+	 * several waits, replacing whatever was reported before.
+	 *
+	 * @param filep		Pointer to the internal file structure.
+	 * @param fds		Poll descriptor previously set up with poll().
+	 * @return		The events now pending for the waiter.
+	 */
+	pollevent_t	poll_check(file_t *filep, px4_pollfd_struct_t *fds);
+
 protected:
 	/**
 	 * Pointer to the default cdev file operations table; useful for
@@ -244,13 +261,6 @@ protected:
 	 */
 	virtual int unregister_class_devname(const char *class_devname, unsigned class_instance);
 
-	/**
-	 * Get the device name.
-	 *
-	 * @return the file system string of the device handle
-	 */
-	const char	*get_devname() { return _devname; }
-
 	/**
 	 * Take the driver lock.
 	 *
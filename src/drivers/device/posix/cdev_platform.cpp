@@ -39,8 +39,10 @@
 
 #include "cdev_platform.hpp"
 
+#include <algorithm>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "vfile.h"
 #include "../CDev.hpp"
@@ -48,6 +50,7 @@
 #include <px4_log.h>
 #include <px4_posix.h>
 #include <px4_time.h>
+#include <px4_trace.h>
 
 #include "DevMgr.hpp"
 
@@ -63,9 +66,62 @@ px4_sem_t lockstep_sem;
 bool sim_lockstep = false;
 volatile bool sim_delay = false;
 
-#define PX4_MAX_FD 350
-static map<string, void *> devmap;
-static device::file_t filemap[PX4_MAX_FD] = {};
+static unordered_map<string, void *> devmap;
+
+// File descriptors index a table of fixed-size blocks that are allocated on
+// demand and never move, so a file_t pointer handed to a driver (or kept by a
+// poll waiter) stays valid while the fd is open. Closed fds go on a free list.
+#define PX4_FD_BLOCK_SIZE 64
+#define PX4_FD_MAX_BLOCKS 256
+static device::file_t *fdblocks[PX4_FD_MAX_BLOCKS] = {};
+static int fdcount = 0; // number of fds ever handed out, all blocks below are allocated
+static vector<int> freefds;
+
+static inline device::file_t &file_at(int fd)
+{
+	return fdblocks[fd / PX4_FD_BLOCK_SIZE][fd % PX4_FD_BLOCK_SIZE];
+}
+
+// Must be called with filemutex locked. Returns -1 if the table is full.
+static int alloc_fd()
+{
+	if (!freefds.empty()) {
+		int fd = freefds.back();
+		freefds.pop_back();
+		return fd;
+	}
+
+	if (fdcount >= PX4_FD_BLOCK_SIZE * PX4_FD_MAX_BLOCKS) {
+		return -1;
+	}
+
+	device::file_t *&block = fdblocks[fdcount / PX4_FD_BLOCK_SIZE];
+
+	if (block == nullptr) {
+		block = new device::file_t[PX4_FD_BLOCK_SIZE];
+
+		if (block == nullptr) {
+			return -1;
+		}
+	}
+
+	return fdcount++;
+}
+
+// Names of all registered devices in sorted order, devmap itself is unordered.
+// Must be called with devmutex locked.
+static vector<const string *> sorted_devices()
+{
+	vector<const string *> names;
+	names.reserve(devmap.size());
+
+	for (const auto &dev : devmap) {
+		names.push_back(&dev.first);
+	}
+
+	sort(names.begin(), names.end(), [](const string * a, const string * b) { return *a < *b; });
+	return names;
+}
 
 extern "C" {
 
@@ -92,11 +148,11 @@ extern "C" {
 	static device::CDev *get_vdev(int fd)
 	{
 		pthread_mutex_lock(&filemutex);
-		bool valid = (fd < PX4_MAX_FD && fd >= 0 && filemap[fd].vdev);
+		bool valid = (fd < fdcount && fd >= 0 && file_at(fd).vdev);
 		device::CDev *dev;
 
 		if (valid) {
-			dev = (device::CDev *)(filemap[fd].vdev);
+			dev = (device::CDev *)(file_at(fd).vdev);
 
 		} else {
 			dev = nullptr;
@@ -179,17 +235,24 @@ extern "C" {
 
 			pthread_mutex_lock(&filemutex);
 
-			for (i = 0; i < PX4_MAX_FD; ++i) {
-				if (filemap[i].vdev == nullptr) {
-					filemap[i] = device::file_t(flags, dev);
-					break;
-				}
+			i = alloc_fd();
+
+			if (i >= 0) {
+				file_at(i) = device::file_t(flags, dev);
 			}
 
 			pthread_mutex_unlock(&filemutex);
 
-			if (i < PX4_MAX_FD) {
-				ret = dev->open(&filemap[i]);
+			if (i >= 0) {
+				ret = dev->open(&file_at(i));
+
+				if (ret < 0) {
+					// give the slot back, the device refused the open
+					pthread_mutex_lock(&filemutex);
+					file_at(i).vdev = nullptr;
+					freefds.push_back(i);
+					pthread_mutex_unlock(&filemutex);
+				}
 
 			} else {
 
@@ -231,9 +294,10 @@ extern "C" {
 
 		if (dev) {
 			pthread_mutex_lock(&filemutex);
-			ret = dev->close(&filemap[fd]);
+			ret = dev->close(&file_at(fd));
 
-			filemap[fd].vdev = nullptr;
+			file_at(fd).vdev = nullptr;
+			freefds.push_back(fd);
 
 			pthread_mutex_unlock(&filemutex);
 			PX4_DEBUG("px4_close fd = %d", fd);
@@ -258,7 +322,7 @@ extern "C" {
 
 		if (dev) {
 			PX4_DEBUG("px4_read fd = %d", fd);
-			ret = dev->read(&filemap[fd], (char *)buffer, buflen);
+			ret = dev->read(&file_at(fd), (char *)buffer, buflen);
 
 		} else {
 			ret = -EINVAL;
@@ -280,7 +344,7 @@ extern "C" {
 
 		if (dev) {
 			PX4_DEBUG("px4_write fd = %d", fd);
-			ret = dev->write(&filemap[fd], (const char *)buffer, buflen);
+			ret = dev->write(&file_at(fd), (const char *)buffer, buflen);
 
 		} else {
 			ret = -EINVAL;
@@ -302,7 +366,7 @@ extern "C" {
 		device::CDev *dev = get_vdev(fd);
 
 		if (dev) {
-			ret = dev->ioctl(&filemap[fd], cmd, arg);
+			ret = dev->ioctl(&file_at(fd), cmd, arg);
 
 		} else {
 			ret = -EINVAL;
@@ -315,6 +379,49 @@ extern "C" {
 		return ret;
 	}
 
+	/*
+	 * Block on a poll semaphore for up to timeout ms, forever if timeout is
+	 * negative. Returns 0 when posted, -ETIMEDOUT or another negative error.
+	 */
+	static int poll_sem_wait(px4_sem_t *sem, int timeout)
+	{
+		int ret = 0;
+
+		if (timeout > 0) {
+
+			// Get the current time
+			struct timespec ts;
+			// FIXME: check if QURT should probably be using CLOCK_MONOTONIC
+			px4_clock_gettime(CLOCK_REALTIME, &ts);
+
+			// Calculate an absolute time in the future
+			const unsigned billion = (1000 * 1000 * 1000);
+			unsigned tdiff = timeout;
+			uint64_t nsecs = ts.tv_nsec + (tdiff * 1000 * 1000);
+			ts.tv_sec += nsecs / billion;
+			nsecs -= (nsecs / billion) * billion;
+			ts.tv_nsec = nsecs;
+
+			// Execute a blocking wait for that time in the future
+			errno = 0;
+			ret = px4_sem_timedwait(sem, &ts);
+#if !defined(__PX4_DARWIN) && !defined(__PX4_CYGWIN) && !defined(ENABLE_LOCKSTEP_SCHEDULER)
+			// sem_timedwait() reports through errno, the px4_sem_t emulation returns the error
+			ret = errno;
+#endif
+
+			// Ensure ret is negative on failure
+			if (ret > 0) {
+				ret = -ret;
+			}
+
+		} else if (timeout < 0) {
+			px4_sem_wait(sem);
+		}
+
+		return ret;
+	}
+
 	int px4_poll(px4_pollfd_struct_t *fds, nfds_t nfds, int timeout)
 	{
 		if (nfds == 0) {
@@ -363,7 +470,7 @@ extern "C" {
 			// If fd is valid
 			if (dev) {
 				PX4_DEBUG("%s: px4_poll: CDev->poll(setup) %d", thread_name, fds[i].fd);
-				ret = dev->poll(&filemap[fds[i].fd], &fds[i], true);
+				ret = dev->poll(&file_at(fds[i].fd), &fds[i], true);
 
 				if (ret < 0) {
 					PX4_WARN("%s: px4_poll() error: %s",
@@ -380,39 +487,10 @@ extern "C" {
 		// If any FD can be polled, lock the semaphore and
 		// check for new data
 		if (fd_pollable) {
-			if (timeout > 0) {
-
-				// Get the current time
-				struct timespec ts;
-				// FIXME: check if QURT should probably be using CLOCK_MONOTONIC
-				px4_clock_gettime(CLOCK_REALTIME, &ts);
-
-				// Calculate an absolute time in the future
-				const unsigned billion = (1000 * 1000 * 1000);
-				unsigned tdiff = timeout;
-				uint64_t nsecs = ts.tv_nsec + (tdiff * 1000 * 1000);
-				ts.tv_sec += nsecs / billion;
-				nsecs -= (nsecs / billion) * billion;
-				ts.tv_nsec = nsecs;
-
-				// Execute a blocking wait for that time in the future
-				errno = 0;
-				ret = px4_sem_timedwait(&sem, &ts);
-#ifndef __PX4_DARWIN
-				ret = errno;
-#endif
-
-				// Ensure ret is negative on failure
-				if (ret > 0) {
-					ret = -ret;
-				}
-
-				if (ret && ret != -ETIMEDOUT) {
-					PX4_WARN("%s: px4_poll() sem error", thread_name);
-				}
+			ret = poll_sem_wait(&sem, timeout);
 
-			} else if (timeout < 0) {
-				px4_sem_wait(&sem);
+			if (ret && ret != -ETIMEDOUT) {
+				PX4_WARN("%s: px4_poll() sem error", thread_name);
 			}
 
 			// We have waited now (or not, depending on timeout),
@@ -424,7 +502,7 @@ extern "C" {
 				// If fd is valid
 				if (dev) {
 					PX4_DEBUG("%s: px4_poll: CDev->poll(teardown) %d", thread_name, fds[i].fd);
-					ret = dev->poll(&filemap[fds[i].fd], &fds[i], false);
+					ret = dev->poll(&file_at(fds[i].fd), &fds[i], false);
 
 					if (ret < 0) {
 						PX4_WARN("%s: px4_poll() 2nd poll fail", thread_name);
@@ -432,6 +510,7 @@ extern "C" {
 					}
 
 					if (fds[i].revents) {
+						px4_trace_instant(PX4_TRACE_WAKEUP, dev->get_devname());
 						count += 1;
 					}
 				}
@@ -445,6 +524,131 @@ extern "C" {
 		return (count) ? count : ret;
 	}
 
+	/*
+	 * Re-check the state of every fd in a poll set and write the pending
+	 * events back to the caller's array. Returns the number of ready fds.
+	 */
+	static int pollset_check(px4_pollset_t *set)
+	{
+		int count = 0;
+
+		for (nfds_t i = 0; i < set->nfds; ++i) {
+			px4_pollfd_struct_t &reg = set->registered[i];
+			pollevent_t revents = 0;
+
+			// priv is the file the fd was set up with, nullptr if it was not
+			device::file_t *filep = (device::file_t *)reg.priv;
+
+			if (filep && filep->vdev) {
+				revents = ((device::CDev *)filep->vdev)->poll_check(filep, &reg);
+			}
+
+			set->fds[i].revents = revents;
+
+			if (revents) {
+				px4_trace_instant(PX4_TRACE_WAKEUP, ((device::CDev *)filep->vdev)->get_devname());
+				count += 1;
+			}
+		}
+
+		return count;
+	}
+
+	int px4_pollset_init(px4_pollset_t *set, px4_pollfd_struct_t *fds, nfds_t nfds)
+	{
+		set->fds = fds;
+		set->nfds = nfds;
+		// zeroed so that px4_pollset_destroy() skips entries not set up yet when setup fails
+		set->registered = new px4_pollfd_struct_t[nfds]();
+
+		if (set->registered == nullptr) {
+			return -ENOMEM;
+		}
+
+		px4_sem_init(&set->sem, 0, 0);
+
+		// sem use case is a signal
+		px4_sem_setprotocol(&set->sem, SEM_PRIO_NONE);
+
+		for (nfds_t i = 0; i < nfds; ++i) {
+			px4_pollfd_struct_t &reg = set->registered[i];
+			reg.fd      = fds[i].fd;
+			reg.events  = fds[i].events;
+			reg.revents = 0;
+			reg.sem     = &set->sem;
+			reg.priv    = nullptr;
+			fds[i].revents = 0;
+
+			device::CDev *dev = get_vdev(reg.fd);
+
+			// Register interest with the device once, it stays until px4_pollset_destroy()
+			if (dev) {
+				int ret = dev->poll(&file_at(reg.fd), &reg, true);
+
+				if (ret < 0) {
+					PX4_WARN("px4_pollset_init() setup of fd %d failed", reg.fd);
+					reg.priv = nullptr;
+					px4_pollset_destroy(set);
+					return ret;
+				}
+			}
+		}
+
+		return PX4_OK;
+	}
+
+	int px4_pollset_wait(px4_pollset_t *set, int timeout)
+	{
+		// A set whose setup failed degrades to one-shot polls
+		if (set->registered == nullptr) {
+			return px4_poll(set->fds, set->nfds, timeout);
+		}
+
+		while (sim_delay) {
+			usleep(100);
+		}
+
+		// Wakeups posted since the last wait are stale, the state is re-checked below
+		while (px4_sem_trywait(&set->sem) == 0) {
+		}
+
+		int count = pollset_check(set);
+		int ret = 0;
+
+		if (count == 0 && timeout != 0) {
+			ret = poll_sem_wait(&set->sem, timeout);
+
+			if (ret && ret != -ETIMEDOUT) {
+				PX4_WARN("px4_pollset_wait() sem error");
+			}
+
+			count = pollset_check(set);
+		}
+
+		// Return the positive count if present, 0 on timeout
+		// and the negative error number if failed
+		return (count || ret == -ETIMEDOUT) ? count : ret;
+	}
+
+	void px4_pollset_destroy(px4_pollset_t *set)
+	{
+		if (set->registered == nullptr) {
+			return;
+		}
+
+		for (nfds_t i = 0; i < set->nfds; ++i) {
+			device::file_t *filep = (device::file_t *)set->registered[i].priv;
+
+			if (filep && filep->vdev) {
+				((device::CDev *)filep->vdev)->poll(filep, &set->registered[i], false);
+			}
+		}
+
+		px4_sem_destroy(&set->sem);
+		delete[] set->registered;
+		set->registered = nullptr;
+	}
+
 	int px4_fsync(int fd)
 	{
 		return 0;
@@ -468,9 +672,9 @@ extern "C" {
 
 		pthread_mutex_lock(&devmutex);
 
-		for (const auto &dev : devmap) {
-			if (strncmp(dev.first.c_str(), "/dev/", 5) == 0) {
-				PX4_INFO("   %s", dev.first.c_str());
+		for (const string *dev : sorted_devices()) {
+			if (strncmp(dev->c_str(), "/dev/", 5) == 0) {
+				PX4_INFO("   %s", dev->c_str());
 			}
 		}
 
@@ -497,9 +701,9 @@ extern "C" {
 
 		pthread_mutex_lock(&devmutex);
 
-		for (const auto &dev : devmap) {
-			if (strncmp(dev.first.c_str(), "/obj/", 5) == 0) {
-				PX4_INFO("   %s", dev.first.c_str());
+		for (const string *dev : sorted_devices()) {
+			if (strncmp(dev->c_str(), "/obj/", 5) == 0) {
+				PX4_INFO("   %s", dev->c_str());
 			}
 		}
 
@@ -512,10 +716,10 @@ extern "C" {
 
 		pthread_mutex_lock(&devmutex);
 
-		for (const auto &dev : devmap) {
-			if (strncmp(dev.first.c_str(), "/obj/", 5) != 0 &&
-			    strncmp(dev.first.c_str(), "/dev/", 5) != 0) {
-				PX4_INFO("   %s", dev.first.c_str());
+		for (const string *dev : sorted_devices()) {
+			if (strncmp(dev->c_str(), "/obj/", 5) != 0 &&
+			    strncmp(dev->c_str(), "/dev/", 5) != 0) {
+				PX4_INFO("   %s", dev->c_str());
 			}
 		}
 
@@ -40,6 +40,33 @@
 #include "ringbuffer.h"
 #include <string.h>
 
+/*
+ * The producer publishes an item by storing _head with release semantics
+ * after the item was copied in, and the consumer loads it with acquire
+ * semantics before copying the item out. The same holds for _tail in the
+ * other direction, so a slot is never reused before it has been read.
+ */
+// FIXME - clang crashes on this get() call
+#ifdef __PX4_QURT
+#define __PX4_SBCAP my_sync_bool_compare_and_swap
+#define RB_LOAD(p)		(*(volatile unsigned *)(p))
+#define RB_STORE(p, v)		(*(volatile unsigned *)(p) = (v))
+static inline bool my_sync_bool_compare_and_swap(volatile unsigned *a, unsigned b, unsigned c)
+{
+	if (*a == b) {
+		*a = c;
+		return true;
+	}
+
+	return false;
+}
+
+#else
+#define __PX4_SBCAP __sync_bool_compare_and_swap
+#define RB_LOAD(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RB_STORE(p, v)		__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
 namespace ringbuffer
 {
 
@@ -47,8 +74,8 @@ RingBuffer::RingBuffer(unsigned num_items, size_t item_size) :
 	_num_items(num_items),
 	_item_size(item_size),
 	_buf(new char[(_num_items + 1) * item_size]),
-	_head(_num_items),
-	_tail(_num_items)
+	_head(0),
+	_tail(0)
 {}
 
 RingBuffer::~RingBuffer()
@@ -61,19 +88,42 @@ RingBuffer::~RingBuffer()
 unsigned
 RingBuffer::_next(unsigned index)
 {
-	return (0 == index) ? _num_items : (index - 1);
+	return (index == _num_items) ? 0 : (index + 1);
+}
+
+unsigned
+RingBuffer::_distance(unsigned from, unsigned to)
+{
+	return (to >= from) ? (to - from) : (to + _num_items + 1 - from);
+}
+
+void
+RingBuffer::_copy_out(void *vals, unsigned index, unsigned num)
+{
+	/* the storage holds _num_items + 1 slots, copy up to its end and then from the start */
+	unsigned first = _num_items + 1 - index;
+
+	if (first > num) {
+		first = num;
+	}
+
+	memcpy(vals, &_buf[index * _item_size], first * _item_size);
+
+	if (num > first) {
+		memcpy((char *)vals + first * _item_size, &_buf[0], (num - first) * _item_size);
+	}
 }
 
 bool
 RingBuffer::empty()
 {
-	return _tail == _head;
+	return RB_LOAD(&_tail) == RB_LOAD(&_head);
 }
 
 bool
 RingBuffer::full()
 {
-	return _next(_head) == _tail;
+	return _next(RB_LOAD(&_head)) == RB_LOAD(&_tail);
 }
 
 unsigned
@@ -85,23 +135,23 @@ RingBuffer::size()
 void
 RingBuffer::flush()
 {
-	while (!empty()) {
-		get(nullptr);
+	while (get_n(nullptr, _num_items) != 0) {
 	}
 }
 
 bool
 RingBuffer::put(const void *val, size_t val_size)
 {
-	unsigned next = _next(_head);
+	unsigned head = RB_LOAD(&_head);
+	unsigned next = _next(head);
 
-	if (next != _tail) {
+	if (next != RB_LOAD(&_tail)) {
 		if ((val_size == 0) || (val_size > _item_size)) {
 			val_size = _item_size;
 		}
 
-		memcpy(&_buf[_head * _item_size], val, val_size);
-		_head = next;
+		memcpy(&_buf[head * _item_size], val, val_size);
+		RB_STORE(&_head, next);
 		return true;
 
 	} else {
@@ -109,6 +159,37 @@ RingBuffer::put(const void *val, size_t val_size)
 	}
 }
 
+unsigned
+RingBuffer::put_n(const void *vals, unsigned num)
+{
+	unsigned head = RB_LOAD(&_head);
+	unsigned space = _num_items - _distance(RB_LOAD(&_tail), head);
+
+	if (num > space) {
+		num = space;
+	}
+
+	if (num == 0) {
+		return 0;
+	}
+
+	unsigned first = _num_items + 1 - head;
+
+	if (first > num) {
+		first = num;
+	}
+
+	memcpy(&_buf[head * _item_size], vals, first * _item_size);
+
+	if (num > first) {
+		memcpy(&_buf[0], (const char *)vals + first * _item_size, (num - first) * _item_size);
+	}
+
+	/* make the whole batch visible at once */
+	RB_STORE(&_head, (head + num) % (_num_items + 1));
+	return num;
+}
+
 bool
 RingBuffer::put(int8_t val)
 {
@@ -246,53 +327,65 @@ RingBuffer::force(double val)
 	return force(&val, sizeof(val));
 }
 
-// FIXME - clang crashes on this get() call
-#ifdef __PX4_QURT
-#define __PX4_SBCAP my_sync_bool_compare_and_swap
-static inline bool my_sync_bool_compare_and_swap(volatile unsigned *a, unsigned b, unsigned c)
+bool
+RingBuffer::get(void *val, size_t val_size)
 {
-	if (*a == b) {
-		*a = c;
-		return true;
+	unsigned candidate;
+	unsigned next;
+
+	if ((val_size == 0) || (val_size > _item_size)) {
+		val_size = _item_size;
 	}
 
-	return false;
-}
+	do {
+		/* decide which element we think we're going to read */
+		candidate = RB_LOAD(&_tail);
 
-#else
-#define __PX4_SBCAP __sync_bool_compare_and_swap
-#endif
-bool
-RingBuffer::get(void *val, size_t val_size)
-{
-	if (_tail != _head) {
-		unsigned candidate;
-		unsigned next;
+		/* a force() may have emptied the buffer under us */
+		if (candidate == RB_LOAD(&_head)) {
+			return false;
+		}
 
-		if ((val_size == 0) || (val_size > _item_size)) {
-			val_size = _item_size;
+		/* and what the corresponding next index will be */
+		next = _next(candidate);
+
+		/* go ahead and read from this index */
+		if (val != nullptr) {
+			memcpy(val, &_buf[candidate * _item_size], val_size);
 		}
 
-		do {
-			/* decide which element we think we're going to read */
-			candidate = _tail;
+		/* if the tail pointer didn't change, we got our item */
+	} while (!__PX4_SBCAP(&_tail, candidate, next));
 
-			/* and what the corresponding next index will be */
-			next = _next(candidate);
+	return true;
+}
 
-			/* go ahead and read from this index */
-			if (val != nullptr) {
-				memcpy(val, &_buf[candidate * _item_size], val_size);
-			}
+unsigned
+RingBuffer::get_n(void *vals, unsigned num)
+{
+	unsigned candidate;
+	unsigned available;
 
-			/* if the tail pointer didn't change, we got our item */
-		} while (!__PX4_SBCAP(&_tail, candidate, next));
+	do {
+		candidate = RB_LOAD(&_tail);
+		available = _distance(candidate, RB_LOAD(&_head));
 
-		return true;
+		if (available > num) {
+			available = num;
+		}
 
-	} else {
-		return false;
-	}
+		if (available == 0) {
+			return 0;
+		}
+
+		if (vals != nullptr) {
+			_copy_out(vals, candidate, available);
+		}
+
+		/* if the tail pointer didn't change, we got the whole batch */
+	} while (!__PX4_SBCAP(&_tail, candidate, (candidate + available) % (_num_items + 1)));
+
+	return available;
 }
 
 bool
@@ -369,11 +462,11 @@ RingBuffer::space()
 	 * re-try the copy.
 	 */
 	do {
-		head = _head;
-		tail = _tail;
-	} while (head != _head);
+		head = RB_LOAD(&_head);
+		tail = RB_LOAD(&_tail);
+	} while (head != RB_LOAD(&_head));
 
-	return (tail >= head) ? (_num_items - (tail - head)) : (head - tail - 1);
+	return _num_items - _distance(tail, head);
 }
 
 unsigned
@@ -399,8 +492,8 @@ RingBuffer::resize(unsigned new_size)
 	old_buffer = _buf;
 	_buf = new_buffer;
 	_num_items = new_size;
-	_head = new_size;
-	_tail = new_size;
+	_head = 0;
+	_tail = 0;
 	delete[] old_buffer;
 	return true;
 }
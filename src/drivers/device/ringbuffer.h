@@ -35,6 +35,10 @@
  * @file ringbuffer.h
  *
  * A flexible ringbuffer class.
+ *
+ * The buffer is lock-free for one producer and one consumer. The producer
+ * may additionally discard the oldest item through force(), which is why
+ * the removal point is advanced with compare-and-swap.
  */
 
 #pragma once
@@ -43,6 +47,15 @@
 #include <stdint.h>
 #include <stdio.h>
 
+/*
+ * Padding that keeps the insertion and removal points on separate cache
+ * lines, so producer and consumer running on different cores do not
+ * bounce the same line. Not needed on the single core MCU targets.
+ */
+#if defined(__PX4_POSIX)
+#define RINGBUFFER_CACHE_LINE_SIZE	64
+#endif
+
 namespace ringbuffer __EXPORT
 {
 
@@ -109,6 +122,27 @@ public:
 	bool			get(float &val);
 	bool			get(double &val);
 
+	/**
+	 * Put a batch of items into the buffer.
+	 *
+	 * The items are copied in at most two contiguous blocks and made
+	 * visible to the consumer at once.
+	 *
+	 * @param vals		Array of num items of the buffer's item size
+	 * @param num		Number of items to put
+	 * @return		the number of items put, less than num if the buffer filled up
+	 */
+	unsigned		put_n(const void *vals, unsigned num);
+
+	/**
+	 * Get a batch of items from the buffer, oldest first.
+	 *
+	 * @param vals		Array with room for num items, or nullptr to discard them
+	 * @param num		Maximum number of items to get
+	 * @return		the number of items got, zero if the buffer was empty
+	 */
+	unsigned		get_n(void *vals, unsigned num);
+
 	/*
 	 * Get the number of slots free in the buffer.
 	 *
@@ -166,11 +200,31 @@ private:
 	unsigned		_num_items;
 	const size_t		_item_size;
 	char			*_buf;
-	volatile unsigned	_head;	/**< insertion point in _item_size units */
-	volatile unsigned	_tail;	/**< removal point in _item_size units */
+#if defined(RINGBUFFER_CACHE_LINE_SIZE)
+	char			_pad0[RINGBUFFER_CACHE_LINE_SIZE];
+#endif
+	unsigned		_head;	/**< insertion point in _item_size units, only written by the producer */
+#if defined(RINGBUFFER_CACHE_LINE_SIZE)
+	char			_pad1[RINGBUFFER_CACHE_LINE_SIZE];
+#endif
+	unsigned		_tail;	/**< removal point in _item_size units */
+#if defined(RINGBUFFER_CACHE_LINE_SIZE)
+	char			_pad2[RINGBUFFER_CACHE_LINE_SIZE];
+#endif
 
 	unsigned		_next(unsigned index);
 
+	/**
+	 * Number of items between two indices.
+	 */
+	unsigned		_distance(unsigned from, unsigned to);
+
+	/**
+	 * Copy num items starting at index from the buffer, wrapping around
+	 * the end of the storage.
+	 */
+	void			_copy_out(void *vals, unsigned index, unsigned num);
+
 	/* we don't want this class to be copied */
 	RingBuffer(const RingBuffer &);
 	RingBuffer operator=(const RingBuffer &);
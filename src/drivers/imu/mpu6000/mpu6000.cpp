@@ -90,7 +90,8 @@
 #include <drivers/device/integrator.h>
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <uORB/topics/sensor_gyro_fifo.h>
+#include <mathlib/math/filter/LowPassFilter2pVector3.hpp>
 #include <lib/conversion/rotation.h>
 
 #include "mpu6000.h"
@@ -131,7 +132,7 @@ class MPU6000 : public device::CDev
 {
 public:
 	MPU6000(device::Device *interface, const char *path_accel, const char *path_gyro, enum Rotation rotation,
-		int device_type);
+		int device_type, bool use_fifo = false, bool publish_fifo = false);
 	virtual ~MPU6000();
 
 	virtual int		init();
@@ -208,16 +209,13 @@ private:
 	perf_counter_t		_reset_retries;
 	perf_counter_t		_duplicates;
 	perf_counter_t		_controller_latency_perf;
+	perf_counter_t		_fifo_overflows;
 
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
-	math::LowPassFilter2p	_gyro_filter_x;
-	math::LowPassFilter2p	_gyro_filter_y;
-	math::LowPassFilter2p	_gyro_filter_z;
+	math::LowPassFilter2pVector3	_accel_filter;
+	math::LowPassFilter2pVector3	_gyro_filter;
 
 	Integrator		_accel_int;
 	Integrator		_gyro_int;
@@ -228,7 +226,7 @@ private:
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
 #define MPU6000_CHECKED_PRODUCT_ID_INDEX 0
-#define MPU6000_NUM_CHECKED_REGISTERS 10
+#define MPU6000_NUM_CHECKED_REGISTERS 11
 	static const uint8_t	_checked_registers[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_values[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_next;
@@ -244,6 +242,30 @@ private:
 	uint16_t		_last_accel[3];
 	bool			_got_duplicate;
 
+	// FIFO mode: drain all samples the device buffered since the last
+	// cycle instead of reading only the latest data registers
+	bool			_fifo_enabled;
+	bool			_publish_fifo;
+	MPUFIFOReport		_fifo_report;
+	hrt_abstime		_fifo_last_timestamp;
+
+	struct sensor_gyro_fifo_s	_gyro_fifo;
+	orb_advert_t		_gyro_fifo_topic;
+	int			_gyro_fifo_orb_class_instance;
+
+	/**
+	 * One measurement, converted to host byte order.
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
 	/**
 	 * Start automatic measurement.
 	 */
@@ -319,6 +341,26 @@ private:
 	 */
 	int			measure();
 
+	/**
+	 * Drain the FIFO and run every buffered sample through process_report().
+	 */
+	int			measure_fifo();
+
+	/**
+	 * Scale, filter and integrate one raw sample and publish it.
+	 *
+	 * @param report	The raw measurement, will be rotated in place.
+	 * @param timestamp	Time the sample was taken.
+	 * @param last		True for the last sample of a measurement cycle,
+	 *			which is always pushed to the report buffers.
+	 */
+	void			process_report(Report &report, hrt_abstime timestamp, bool last);
+
+	/**
+	 * Clear the FIFO and restart filling it.
+	 */
+	void			fifo_reset();
+
 	/**
 	 * Read a register from the MPU6000
 	 *
@@ -436,6 +478,7 @@ const uint8_t MPU6000::_checked_registers[MPU6000_NUM_CHECKED_REGISTERS] = { MPU
 									     MPUREG_ACCEL_CONFIG,
 									     MPUREG_INT_ENABLE,
 									     MPUREG_INT_PIN_CFG,
+									     MPUREG_FIFO_EN,
 									     MPUREG_ICM_UNDOC1
 									   };
 
@@ -475,7 +518,7 @@ private:
 extern "C" { __EXPORT int mpu6000_main(int argc, char *argv[]); }
 
 MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *path_gyro, enum Rotation rotation,
-		 int device_type) :
+		 int device_type, bool use_fifo, bool publish_fifo) :
 	CDev("MPU6000", path_accel),
 	_interface(interface),
 	_device_type(device_type),
@@ -510,14 +553,11 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 	_reset_retries(perf_alloc(PC_COUNT, "mpu6k_reset")),
 	_duplicates(perf_alloc(PC_COUNT, "mpu6k_duplicates")),
 	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
+	_fifo_overflows(perf_alloc(PC_COUNT, "mpu6k_fifo_oflow")),
 	_register_wait(0),
 	_reset_wait(0),
-	_accel_filter_x(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_x(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_y(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_z(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_accel_filter(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_gyro_filter(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
 	_accel_int(1000000 / MPU6000_ACCEL_MAX_OUTPUT_RATE),
 	_gyro_int(1000000 / MPU6000_GYRO_MAX_OUTPUT_RATE, true),
 	_rotation(rotation),
@@ -525,7 +565,14 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 	_in_factory_test(false),
 	_last_temperature(0),
 	_last_accel{},
-	_got_duplicate(false)
+	_got_duplicate(false),
+	_fifo_enabled(use_fifo),
+	_publish_fifo(use_fifo && publish_fifo),
+	_fifo_report{},
+	_fifo_last_timestamp(0),
+	_gyro_fifo{},
+	_gyro_fifo_topic(nullptr),
+	_gyro_fifo_orb_class_instance(-1)
 {
 	// disable debug() calls
 	_debug_enabled = false;
@@ -619,6 +666,7 @@ MPU6000::~MPU6000()
 	perf_free(_good_transfers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_overflows);
 }
 
 int
@@ -667,6 +715,14 @@ MPU6000::init()
 		return ret;
 	}
 
+	/* the FIFO layout and 8kHz output are only handled for these parts, and I2C is too slow to drain it */
+	if (_fifo_enabled && (is_i2c() || !(_device_type == MPU_DEVICE_TYPE_MPU6000
+					    || _device_type == MPU_DEVICE_TYPE_ICM20608))) {
+		PX4_WARN("FIFO mode not supported on this device, using register reads");
+		_fifo_enabled = false;
+		_publish_fifo = false;
+	}
+
 	ret = -EIO;
 
 	if (reset() != OK) {
@@ -695,9 +751,8 @@ MPU6000::init()
 	if (accel_cut_ph != PARAM_INVALID && param_get(accel_cut_ph, &accel_cut) == PX4_OK) {
 		PX4_INFO("accel cutoff set to %.2f Hz", double(accel_cut));
 
-		_accel_filter_x.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_y.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_z.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
+		_accel_filter.set_cutoff_frequency(_fifo_enabled ? MPU6000_FIFO_SAMPLE_RATE : MPU6000_ACCEL_DEFAULT_RATE,
+						   accel_cut);
 
 	} else {
 		PX4_ERR("IMU_ACCEL_CUTOFF param invalid");
@@ -709,14 +764,24 @@ MPU6000::init()
 	if (gyro_cut_ph != PARAM_INVALID && param_get(gyro_cut_ph, &gyro_cut) == PX4_OK) {
 		PX4_INFO("gyro cutoff set to %.2f Hz", double(gyro_cut));
 
-		_gyro_filter_x.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_y.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_z.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
+		_gyro_filter.set_cutoff_frequency(_fifo_enabled ? MPU6000_FIFO_SAMPLE_RATE : MPU6000_GYRO_DEFAULT_RATE,
+						  gyro_cut);
 
 	} else {
 		PX4_ERR("IMU_GYRO_CUTOFF param invalid");
 	}
 
+	// optional notch against motor vibrations
+	float gyro_notch_freq = 0.0f;
+	float gyro_notch_bw = 0.0f;
+
+	if (param_get(param_find("IMU_GYRO_NF_FREQ"), &gyro_notch_freq) == PX4_OK &&
+	    param_get(param_find("IMU_GYRO_NF_BW"), &gyro_notch_bw) == PX4_OK &&
+	    gyro_notch_freq > 0.0f) {
+		PX4_INFO("gyro notch set to %.2f Hz", double(gyro_notch_freq));
+		_gyro_filter.set_notch_frequency(0, gyro_notch_freq, gyro_notch_bw);
+	}
+
 	/* do CDev init for the gyro device node, keep it optional */
 	ret = _gyro->init();
 
@@ -847,6 +912,18 @@ int MPU6000::reset()
 		write_checked_reg(MPUREG_ICM_UNDOC1, MPUREG_ICM_UNDOC1_VALUE);
 	}
 
+	// FIFO => accel, temp and gyro, in MPUFIFOSample order
+	if (_fifo_enabled) {
+		write_checked_reg(MPUREG_FIFO_EN, BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN |
+				  BIT_XG_FIFO_EN | BIT_YG_FIFO_EN | BIT_ZG_FIFO_EN);
+		usleep(1000);
+		write_checked_reg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_USER_CTRL_FIFO_EN);
+		fifo_reset();
+
+	} else {
+		write_checked_reg(MPUREG_FIFO_EN, 0);
+	}
+
 	// Oscillator set
 	// write_reg(MPUREG_PWR_MGMT_1,MPU_CLK_SEL_PLLGYROZ);
 	usleep(1000);
@@ -934,6 +1011,13 @@ MPU6000::probe()
 void
 MPU6000::_set_sample_rate(unsigned desired_sample_rate_hz)
 {
+	if (_fifo_enabled) {
+		/* the FIFO is filled at the full gyro output rate */
+		write_checked_reg(MPUREG_SMPLRT_DIV, 0);
+		_sample_rate = MPU6000_FIFO_SAMPLE_RATE;
+		return;
+	}
+
 	if (desired_sample_rate_hz == 0 ||
 	    desired_sample_rate_hz == GYRO_SAMPLERATE_DEFAULT ||
 	    desired_sample_rate_hz == ACCEL_SAMPLERATE_DEFAULT) {
@@ -961,7 +1045,11 @@ MPU6000::_set_dlpf_filter(uint16_t frequency_hz)
 	/*
 	   choose next highest filter frequency available
 	 */
-	if (frequency_hz == 0) {
+	if (_fifo_enabled) {
+		/* only this setting gives 8kHz gyro output without aliasing */
+		filter = MPU_GYRO_DLPF_CFG_256HZ_NOLPF2;
+
+	} else if (frequency_hz == 0) {
 		filter = MPU_GYRO_DLPF_CFG_2100HZ_NOLPF;
 
 	} else if (frequency_hz <= 5) {
@@ -1402,25 +1490,26 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 						return -EINVAL;
 					}
 
+					/* in FIFO mode the device must be drained before it overflows */
+					if (_fifo_enabled && ticks > (1000000 * MPU6000_FIFO_MAX_SAMPLES) / MPU6000_FIFO_SAMPLE_RATE) {
+						return -EINVAL;
+					}
+
 					// adjust filters
-					float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-					float sample_rate = 1.0e6f / ticks;
+					float cutoff_freq_hz = _accel_filter.get_cutoff_freq();
+					float sample_rate = _fifo_enabled ? MPU6000_FIFO_SAMPLE_RATE : 1.0e6f / ticks;
 					_set_dlpf_filter(cutoff_freq_hz);
 
 					if (is_icm_device()) {
 						_set_icm_acc_dlpf_filter(cutoff_freq_hz);
 					}
 
-					_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
+					_accel_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 
 
-					float cutoff_freq_hz_gyro = _gyro_filter_x.get_cutoff_freq();
+					float cutoff_freq_hz_gyro = _gyro_filter.get_cutoff_freq();
 					_set_dlpf_filter(cutoff_freq_hz_gyro);
-					_gyro_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
+					_gyro_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
 
 					/* update interval for next measurement */
 					/* XXX this is a bit shady, but no other way to adjust... */
@@ -1692,6 +1781,10 @@ MPU6000::start()
 	_accel_reports->flush();
 	_gyro_reports->flush();
 
+	if (_fifo_enabled) {
+		fifo_reset();
+	}
+
 	if (!is_i2c()) {
 		/* start polling at the specified rate */
 		hrt_call_every(&_call,
@@ -1848,17 +1941,13 @@ MPU6000::measure()
 		return OK;
 	}
 
+	if (_fifo_enabled) {
+		return measure_fifo();
+	}
+
 	struct MPUReport mpu_report;
 
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	Report report;
 
 	/* start measuring */
 	perf_begin(_sample_perf);
@@ -1937,7 +2026,155 @@ MPU6000::measure()
 		return OK;
 	}
 
+	process_report(report, hrt_absolute_time(), true);
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+	return OK;
+}
+
+void
+MPU6000::fifo_reset()
+{
+	write_reg(MPUREG_USER_CTRL, BIT_I2C_IF_DIS | BIT_USER_CTRL_FIFO_EN | BIT_USER_CTRL_FIFO_RESET);
+	_fifo_last_timestamp = 0;
+}
+
+int
+MPU6000::measure_fifo()
+{
+	/* start measuring */
+	perf_begin(_sample_perf);
+
+	uint8_t count_bytes[2];
+
+	if (_interface->read(MPU6000_HIGH_SPEED_OP(MPUREG_FIFO_COUNTH), count_bytes, sizeof(count_bytes)) !=
+	    sizeof(count_bytes)) {
+		perf_end(_sample_perf);
+		return -EIO;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+	const unsigned fifo_count = (count_bytes[0] << 8) | count_bytes[1];
+
+	if (fifo_count > MPU6000_FIFO_SIZE - sizeof(MPUFIFOSample) || fifo_count % sizeof(MPUFIFOSample) != 0) {
+		// the FIFO overflowed, or we lost track of the sample
+		// boundaries. Either way the data can not be trusted
+		perf_count(_fifo_overflows);
+		fifo_reset();
+		perf_end(_sample_perf);
+		return OK;
+	}
+
+	const unsigned available = fifo_count / sizeof(MPUFIFOSample);
+
+	/*
+	  the SPI interface treats transfers shorter than an MPUReport
+	  as register reads, so always read at least two samples and
+	  leave a single sample for the next cycle.
+	 */
+	if (available < 2) {
+		perf_end(_sample_perf);
+		return OK;
+	}
+
+	const unsigned samples = math::min(available, (unsigned)MPU6000_FIFO_MAX_SAMPLES);
+	const unsigned transfer_size = 1 + samples * sizeof(MPUFIFOSample);
+
+	if (_interface->read(MPU6000_HIGH_SPEED_OP(MPUREG_FIFO_R_W), (uint8_t *)&_fifo_report, transfer_size) !=
+	    (int)transfer_size) {
+		perf_end(_sample_perf);
+		return -EIO;
+	}
+
+	check_registers();
 
+	/*
+	  the newest sample in the FIFO was taken at most one sample
+	  interval before now. Spread the older ones back from there,
+	  and keep to the previous batch's grid while it is within a
+	  sample interval, so the jitter of this callout does not show
+	  up as jitter in the sample times.
+	 */
+	const hrt_abstime interval = 1000000 / MPU6000_FIFO_SAMPLE_RATE;
+	const hrt_abstime expected = _fifo_last_timestamp + interval;
+	hrt_abstime timestamp = now - (available - 1) * interval;
+
+	if (_fifo_last_timestamp != 0 && timestamp + interval > expected && timestamp < expected + interval) {
+		timestamp = expected;
+	}
+
+	_gyro_fifo.samples = 0;
+
+	// like a single report in measure(), a whole batch counts as one cycle of _register_wait
+	const bool register_wait = (_register_wait != 0);
+	bool good_transfer = false;
+
+	for (unsigned i = 0; i < samples; i++, timestamp += interval) {
+		MPUFIFOSample &sample = _fifo_report.samples[i];
+		Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+
+		report.temp = int16_t_from_bytes(sample.temp);
+
+		report.gyro_x = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z = int16_t_from_bytes(sample.gyro_z);
+
+		if (report.accel_x == 0 &&
+		    report.accel_y == 0 &&
+		    report.accel_z == 0 &&
+		    report.temp == 0 &&
+		    report.gyro_x == 0 &&
+		    report.gyro_y == 0 &&
+		    report.gyro_z == 0) {
+			// all zero data - probably a SPI bus error
+			perf_count(_bad_transfers);
+			continue;
+		}
+
+		perf_count(_good_transfers);
+		good_transfer = true;
+
+		if (register_wait) {
+			// we are waiting for some good transfers before using
+			// the sensor again, don't return any data yet
+			continue;
+		}
+
+		process_report(report, timestamp, i == samples - 1);
+		_fifo_last_timestamp = timestamp;
+	}
+
+	if (register_wait && good_transfer) {
+		_register_wait--;
+	}
+
+	if (_publish_fifo && _gyro_fifo.samples > 0 && !(_pub_blocked)) {
+		_gyro_fifo.timestamp = _fifo_last_timestamp;
+		_gyro_fifo.device_id = _gyro->_device_id.devid;
+		_gyro_fifo.dt = interval;
+
+		if (_gyro_fifo_topic == nullptr) {
+			_gyro_fifo_topic = orb_advertise_multi(ORB_ID(sensor_gyro_fifo), &_gyro_fifo,
+							       &_gyro_fifo_orb_class_instance, ORB_PRIO_HIGH);
+
+		} else {
+			orb_publish(ORB_ID(sensor_gyro_fifo), _gyro_fifo_topic, &_gyro_fifo);
+		}
+	}
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+	return OK;
+}
+
+void
+MPU6000::process_report(Report &report, hrt_abstime timestamp, bool last)
+{
 	/*
 	 * Swap axes and negate y
 	 */
@@ -1964,7 +2201,7 @@ MPU6000::measure()
 	/*
 	 * Adjust and scale results to m/s^2.
 	 */
-	grb.timestamp = arb.timestamp = hrt_absolute_time();
+	grb.timestamp = arb.timestamp = timestamp;
 
 	// report the error count as the sum of the number of bad
 	// transfers and bad register reads. This allows the higher
@@ -2005,9 +2242,11 @@ MPU6000::measure()
 	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
 	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
 
-	arb.x = _accel_filter_x.apply(x_in_new);
-	arb.y = _accel_filter_y.apply(y_in_new);
-	arb.z = _accel_filter_z.apply(z_in_new);
+	float accel_filtered[3] = {x_in_new, y_in_new, z_in_new};
+	_accel_filter.apply(accel_filtered);
+	arb.x = accel_filtered[0];
+	arb.y = accel_filtered[1];
+	arb.z = accel_filtered[2];
 
 	math::Vector<3> aval(x_in_new, y_in_new, z_in_new);
 	math::Vector<3> aval_integrated;
@@ -2048,9 +2287,11 @@ MPU6000::measure()
 	float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
 	float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
 
-	grb.x = _gyro_filter_x.apply(x_gyro_in_new);
-	grb.y = _gyro_filter_y.apply(y_gyro_in_new);
-	grb.z = _gyro_filter_z.apply(z_gyro_in_new);
+	float gyro_filtered[3] = {x_gyro_in_new, y_gyro_in_new, z_gyro_in_new};
+	_gyro_filter.apply(gyro_filtered);
+	grb.x = gyro_filtered[0];
+	grb.y = gyro_filtered[1];
+	grb.z = gyro_filtered[2];
 
 	math::Vector<3> gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
 	math::Vector<3> gval_integrated;
@@ -2069,8 +2310,21 @@ MPU6000::measure()
 	/* return device ID */
 	grb.device_id = _gyro->_device_id.devid;
 
-	_accel_reports->force(&arb);
-	_gyro_reports->force(&grb);
+	if (_publish_fifo && _gyro_fifo.samples < MPU6000_FIFO_MAX_SAMPLES) {
+		_gyro_fifo.x[_gyro_fifo.samples] = x_gyro_in_new;
+		_gyro_fifo.y[_gyro_fifo.samples] = y_gyro_in_new;
+		_gyro_fifo.z[_gyro_fifo.samples] = z_gyro_in_new;
+		_gyro_fifo.samples++;
+	}
+
+	/* in FIFO mode only the newest sample of a batch is of interest to readers */
+	if (last || accel_notify) {
+		_accel_reports->force(&arb);
+	}
+
+	if (last || gyro_notify) {
+		_gyro_reports->force(&grb);
+	}
 
 	/* notify anyone waiting for data */
 	if (accel_notify) {
@@ -2092,10 +2346,6 @@ MPU6000::measure()
 		/* publish it */
 		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
 	}
-
-	/* stop measuring */
-	perf_end(_sample_perf);
-	return OK;
 }
 
 void
@@ -2109,6 +2359,8 @@ MPU6000::print_info()
 	perf_print_counter(_good_transfers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
+	perf_print_counter(_fifo_overflows);
+	::printf("FIFO mode: %s\n", _fifo_enabled ? (_publish_fifo ? "on, publishing batches" : "on") : "off");
 	_accel_reports->print_info("accel queue");
 	_gyro_reports->print_info("gyro queue");
 	::printf("checked_next: %u\n", _checked_next);
@@ -2125,10 +2377,15 @@ MPU6000::print_info()
 	}
 
 	::printf("temperature: %.1f\n", (double)_last_temperature);
-	float accel_cut = _accel_filter_x.get_cutoff_freq();
+	float accel_cut = _accel_filter.get_cutoff_freq();
 	::printf("accel cutoff set to %10.2f Hz\n", double(accel_cut));
-	float gyro_cut = _gyro_filter_x.get_cutoff_freq();
+	float gyro_cut = _gyro_filter.get_cutoff_freq();
 	::printf("gyro cutoff set to %10.2f Hz\n", double(gyro_cut));
+	float gyro_notch = _gyro_filter.get_notch_freq(0);
+
+	if (gyro_notch > 0.0f) {
+		::printf("gyro notch set to %10.2f Hz\n", double(gyro_notch));
+	}
 }
 
 void
@@ -2262,8 +2519,10 @@ struct mpu6000_bus_option {
 #define NUM_BUS_OPTIONS (sizeof(bus_options)/sizeof(bus_options[0]))
 
 
-void	start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type);
-bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type);
+void	start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type, bool use_fifo,
+	      bool publish_fifo);
+bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type, bool use_fifo,
+		  bool publish_fifo);
 void	stop(enum MPU6000_BUS busid);
 void	test(enum MPU6000_BUS busid);
 static struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid);
@@ -2293,7 +2552,8 @@ struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid)
  * start driver for a specific bus option
  */
 bool
-start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type)
+start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type, bool use_fifo,
+	  bool publish_fifo)
 {
 	int fd = -1;
 
@@ -2315,7 +2575,7 @@ start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int
 		return false;
 	}
 
-	bus.dev = new MPU6000(interface, bus.accelpath, bus.gyropath, rotation, device_type);
+	bus.dev = new MPU6000(interface, bus.accelpath, bus.gyropath, rotation, device_type, use_fifo, publish_fifo);
 
 	if (bus.dev == nullptr) {
 		delete interface;
@@ -2367,7 +2627,7 @@ fail:
  * or failed to detect the sensor.
  */
 void
-start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type)
+start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type, bool use_fifo, bool publish_fifo)
 {
 
 	bool started = false;
@@ -2388,7 +2648,7 @@ start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type
 			continue;
 		}
 
-		started |= start_bus(bus_options[i], rotation, range, device_type);
+		started |= start_bus(bus_options[i], rotation, range, device_type, use_fifo, publish_fifo);
 	}
 
 	exit(started ? 0 : 1);
@@ -2612,6 +2872,8 @@ usage()
 	warnx("    -T 6000|20608|20602 (default 6000)");
 	warnx("    -R rotation");
 	warnx("    -a accel range (in g)");
+	warnx("    -F read all samples from the FIFO (SPI, 6000|20608 only)");
+	warnx("    -B publish FIFO gyro batches (with -F)");
 }
 
 } // namespace
@@ -2624,9 +2886,11 @@ mpu6000_main(int argc, char *argv[])
 	int ch;
 	enum Rotation rotation = ROTATION_NONE;
 	int accel_range = MPU6000_ACCEL_DEFAULT_RANGE_G;
+	bool use_fifo = false;
+	bool publish_fifo = false;
 
 	/* jump over start/off/etc and look at options first */
-	while ((ch = getopt(argc, argv, "T:XISsZzR:a:")) != EOF) {
+	while ((ch = getopt(argc, argv, "T:XISsZzR:a:FB")) != EOF) {
 		switch (ch) {
 		case 'X':
 			busid = MPU6000_BUS_I2C_EXTERNAL;
@@ -2664,6 +2928,14 @@ mpu6000_main(int argc, char *argv[])
 			accel_range = atoi(optarg);
 			break;
 
+		case 'F':
+			use_fifo = true;
+			break;
+
+		case 'B':
+			publish_fifo = true;
+			break;
+
 		default:
 			mpu6000::usage();
 			exit(0);
@@ -2677,7 +2949,7 @@ mpu6000_main(int argc, char *argv[])
 
 	 */
 	if (!strcmp(verb, "start")) {
-		mpu6000::start(busid, rotation, accel_range, device_type);
+		mpu6000::start(busid, rotation, accel_range, device_type, use_fifo, publish_fifo);
 	}
 
 	if (!strcmp(verb, "stop")) {
@@ -143,6 +143,18 @@
 #define BIT_RAW_RDY_EN			0x01
 #define BIT_I2C_IF_DIS			0x10
 #define BIT_INT_STATUS_DATA		0x01
+#define BIT_INT_STATUS_FIFO_OFLOW	0x10
+
+// FIFO_EN
+#define BIT_TEMP_FIFO_EN		0x80
+#define BIT_XG_FIFO_EN			0x40
+#define BIT_YG_FIFO_EN			0x20
+#define BIT_ZG_FIFO_EN			0x10
+#define BIT_ACCEL_FIFO_EN		0x08
+
+// USER_CTRL
+#define BIT_USER_CTRL_FIFO_EN		0x40
+#define BIT_USER_CTRL_FIFO_RESET	0x04
 
 #define MPU_WHOAMI_6000			0x68
 #define ICM_WHOAMI_20602		0x12
@@ -212,6 +224,11 @@
 
 #define MPU6000_DEFAULT_ONCHIP_FILTER_FREQ			42
 
+/* in FIFO mode the gyro runs unfiltered at 8kHz and the accel samples are repeated */
+#define MPU6000_FIFO_SIZE				1024
+#define MPU6000_FIFO_SAMPLE_RATE			8000
+#define MPU6000_FIFO_MAX_SAMPLES			16
+
 #define MPU6000_ONE_G					9.80665f
 
 #ifdef PX4_SPI_BUS_EXT
@@ -238,6 +255,28 @@ struct MPUReport {
 	uint8_t		gyro_y[2];
 	uint8_t		gyro_z[2];
 };
+
+/**
+ * One FIFO entry with FIFO_EN set to accel, temp and all gyro axes,
+ * in the order the device pushes them.
+ */
+struct MPUFIFOSample {
+	uint8_t		accel_x[2];
+	uint8_t		accel_y[2];
+	uint8_t		accel_z[2];
+	uint8_t		temp[2];
+	uint8_t		gyro_x[2];
+	uint8_t		gyro_y[2];
+	uint8_t		gyro_z[2];
+};
+
+/**
+ * Burst read of the FIFO data register, including command byte.
+ */
+struct MPUFIFOReport {
+	uint8_t		cmd;
+	MPUFIFOSample	samples[MPU6000_FIFO_MAX_SAMPLES];
+};
 #pragma pack(pop)
 
 #define MPU_MAX_READ_BUFFER_SIZE (sizeof(MPUReport) + 1)
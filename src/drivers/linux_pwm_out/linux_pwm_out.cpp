@@ -306,6 +306,15 @@ void task_main(int argc, char *argv[])
 				_outputs.output[i] = NAN;
 			}
 
+			/* the outputs are based on the newest sample of the mixed control groups */
+			_outputs.timestamp_sample = 0;
+
+			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+				if (_controls_subs[i] >= 0 && _controls[i].timestamp_sample > _outputs.timestamp_sample) {
+					_outputs.timestamp_sample = _controls[i].timestamp_sample;
+				}
+			}
+
 			const uint16_t reverse_mask = 0;
 			uint16_t disarmed_pwm[actuator_outputs_s::NUM_ACTUATOR_OUTPUTS];
 			uint16_t min_pwm[actuator_outputs_s::NUM_ACTUATOR_OUTPUTS];
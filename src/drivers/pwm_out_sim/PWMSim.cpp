@@ -214,6 +214,14 @@ PWMSim::run()
 			unsigned num_outputs = _mixers->mix(&_actuator_outputs.output[0], _num_outputs);
 			_actuator_outputs.noutputs = num_outputs;
 			_actuator_outputs.timestamp = hrt_absolute_time();
+			_actuator_outputs.timestamp_sample = 0;
+
+			/* the outputs are based on the newest sample of the mixed control groups */
+			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+				if (_control_subs[i] >= 0 && _controls[i].timestamp_sample > _actuator_outputs.timestamp_sample) {
+					_actuator_outputs.timestamp_sample = _controls[i].timestamp_sample;
+				}
+			}
 
 			/* disable unused ports by setting their output to NaN */
 			for (size_t i = 0; i < sizeof(_actuator_outputs.output) / sizeof(_actuator_outputs.output[0]); i++) {
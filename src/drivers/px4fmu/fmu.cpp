@@ -1340,6 +1340,13 @@ PX4FMU::cycle()
 				actuator_outputs.timestamp = hrt_absolute_time();
 				actuator_outputs.noutputs = mixed_num_outputs;
 
+				/* the outputs are based on the newest sample of the mixed control groups */
+				for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+					if (_control_subs[i] > 0 && _controls[i].timestamp_sample > actuator_outputs.timestamp_sample) {
+						actuator_outputs.timestamp_sample = _controls[i].timestamp_sample;
+					}
+				}
+
 				// zero unused outputs
 				for (size_t i = 0; i < mixed_num_outputs; ++i) {
 					actuator_outputs.output[i] = pwm_limited[i];
@@ -98,6 +98,48 @@ void Block::updateParams()
 	}
 }
 
+bool Block::updateParamsChanged(uint32_t instance)
+{
+	bool updated = true;
+
+	if (_param_update_instance_valid) {
+		updated = updateParamsChangedSince(_param_update_instance);
+
+	} else {
+		updateParams();
+	}
+
+	_param_update_instance = instance;
+	_param_update_instance_valid = true;
+
+	return updated;
+}
+
+bool Block::updateParamsChangedSince(uint32_t instance)
+{
+	BlockParamBase *param = getParams().getHead();
+	int count = 0;
+	bool updated = false;
+
+	while (param != nullptr) {
+		if (count++ > maxParamsPerBlock) {
+			char name[blockNameLengthMax];
+			getName(name, blockNameLengthMax);
+			PX4_ERR("exceeded max params for block: %s", name);
+			break;
+		}
+
+		if (param->changedSince(instance)) {
+			param->update();
+			updated = true;
+		}
+
+		param = param->getSibling();
+	}
+
+	return updated;
+}
+
 void Block::updateSubscriptions()
 {
 	uORB::SubscriptionNode *sub = getSubscriptions().getHead();
@@ -171,6 +213,27 @@ void SuperBlock::updateChildParams()
 	}
 }
 
+bool SuperBlock::updateChildParamsChangedSince(uint32_t instance)
+{
+	Block *child = getChildren().getHead();
+	int count = 0;
+	bool updated = false;
+
+	while (child != nullptr) {
+		if (count++ > maxChildrenPerBlock) {
+			char name[blockNameLengthMax];
+			getName(name, blockNameLengthMax);
+			PX4_ERR("exceeded max children for block: %s", name);
+			break;
+		}
+
+		updated |= child->updateParamsChangedSince(instance);
+		child = child->getSibling();
+	}
+
+	return updated;
+}
+
 void SuperBlock::updateChildSubscriptions()
 {
 	Block *child = getChildren().getHead();
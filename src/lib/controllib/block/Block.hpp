@@ -63,6 +63,7 @@ class __EXPORT Block : public ListNode<Block *>
 {
 public:
 	friend class BlockParamBase;
+	friend class SuperBlock;
 
 	Block(SuperBlock *parent, const char *name);
 	virtual ~Block() = default;
@@ -77,6 +78,15 @@ public:
 
 	virtual void updateParams();
 	virtual void updateSubscriptions();
+
+	/**
+	 * Update only the parameters that changed since the previous call, given the instance
+	 * of the parameter_update that was received. The first call updates all parameters.
+	 * Overrides of updateParams() are only called on the first call.
+	 *
+	 * @return true if any parameter was updated
+	 */
+	bool updateParamsChanged(uint32_t instance);
 	virtual void updatePublications();
 
 	virtual void setDt(float dt) { _dt = dt; }
@@ -84,6 +94,8 @@ public:
 
 protected:
 
+	virtual bool updateParamsChangedSince(uint32_t instance);
+
 	SuperBlock *getParent() { return _parent; }
 	List<uORB::SubscriptionNode *> &getSubscriptions() { return _subscriptions; }
 	List<uORB::PublicationNode *> &getPublications() { return _publications; }
@@ -96,6 +108,9 @@ protected:
 	List<uORB::SubscriptionNode *> _subscriptions;
 	List<uORB::PublicationNode *> _publications;
 	List<BlockParamBase *> _params;
+
+	uint32_t _param_update_instance{0};
+	bool _param_update_instance_valid{false};
 };
 
 class __EXPORT SuperBlock :
@@ -136,8 +151,18 @@ public:
 	}
 
 protected:
+	bool updateParamsChangedSince(uint32_t instance) override
+	{
+		bool updated = Block::updateParamsChangedSince(instance);
+
+		if (getChildren().getHead() != nullptr) { updated |= updateChildParamsChangedSince(instance); }
+
+		return updated;
+	}
+
 	List<Block *> &getChildren() { return _children; }
 	void updateChildParams();
+	bool updateChildParamsChangedSince(uint32_t instance);
 	void updateChildSubscriptions();
 	void updateChildPublications();
 
@@ -65,6 +65,9 @@ public:
 	virtual bool update() = 0;
 	const char *getName() const { return param_name(_handle); }
 
+	// Check if the parameter changed after the given parameter_update instance (@see param_changed_since())
+	bool changedSince(uint32_t instance) const { return param_changed_since(_handle, instance); }
+
 protected:
 	param_t _handle{PARAM_INVALID};
 };
@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file LowPassFilter2pVector3.cpp
+ */
+
+#include "LowPassFilter2pVector3.hpp"
+
+#include <cmath>
+#include <string.h>
+
+namespace math
+{
+
+void LowPassFilter2pVector3::set_cutoff_frequency(float sample_freq, float cutoff_freq)
+{
+	_sample_freq = sample_freq;
+	_cutoff_freq = cutoff_freq;
+
+	Stage &lp = _stages[0];
+
+	if (_cutoff_freq <= 0.0f || _sample_freq <= 0.0f) {
+		// no filtering
+		lp.enabled = false;
+
+	} else {
+		// same design as LowPassFilter2p
+		float fr = sample_freq / _cutoff_freq;
+		float ohm = tanf(M_PI_F / fr);
+		float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+		lp.b0 = ohm * ohm / c;
+		lp.b1 = 2.0f * lp.b0;
+		lp.b2 = lp.b0;
+		lp.a1 = 2.0f * (ohm * ohm - 1.0f) / c;
+		lp.a2 = (1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c;
+		lp.enabled = true;
+	}
+
+	for (unsigned i = 0; i < MAX_NOTCH_STAGES; i++) {
+		update_notch(i);
+	}
+}
+
+bool LowPassFilter2pVector3::set_notch_frequency(unsigned index, float notch_freq, float bandwidth)
+{
+	if (index >= MAX_NOTCH_STAGES) {
+		return false;
+	}
+
+	_notch_freq[index] = notch_freq;
+	_notch_bandwidth[index] = bandwidth;
+	update_notch(index);
+	return true;
+}
+
+void LowPassFilter2pVector3::update_notch(unsigned index)
+{
+	Stage &notch = _stages[1 + index];
+	const float notch_freq = _notch_freq[index];
+	const float bandwidth = _notch_bandwidth[index];
+
+	// the notch has to be below the Nyquist frequency
+	if (notch_freq <= 0.0f || bandwidth <= 0.0f || notch_freq >= 0.5f * _sample_freq) {
+		notch.enabled = false;
+		return;
+	}
+
+	const float alpha = tanf(M_PI_F * bandwidth / _sample_freq);
+	const float beta = -cosf(2.0f * M_PI_F * notch_freq / _sample_freq);
+	const float a0_inv = 1.0f / (alpha + 1.0f);
+
+	notch.b0 = a0_inv;
+	notch.b1 = 2.0f * beta * a0_inv;
+	notch.b2 = a0_inv;
+	notch.a1 = notch.b1;
+	notch.a2 = (1.0f - alpha) * a0_inv;
+
+	if (!notch.enabled) {
+		// start from a clean state, the notch has unity gain at DC
+		memset(notch.delay_element_1, 0, sizeof(notch.delay_element_1));
+		memset(notch.delay_element_2, 0, sizeof(notch.delay_element_2));
+		notch.enabled = true;
+	}
+}
+
+void LowPassFilter2pVector3::apply_stage(Stage &stage, float sample[3])
+{
+	for (unsigned axis = 0; axis < 3; axis++) {
+		float delay_element_0 = sample[axis] - stage.delay_element_1[axis] * stage.a1 - stage.delay_element_2[axis] * stage.a2;
+
+		if (!PX4_ISFINITE(delay_element_0)) {
+			// don't allow bad values to propagate via the filter
+			delay_element_0 = sample[axis];
+		}
+
+		sample[axis] = delay_element_0 * stage.b0 + stage.delay_element_1[axis] * stage.b1 +
+			       stage.delay_element_2[axis] * stage.b2;
+
+		stage.delay_element_2[axis] = stage.delay_element_1[axis];
+		stage.delay_element_1[axis] = delay_element_0;
+	}
+}
+
+void LowPassFilter2pVector3::apply(float samples[][3], unsigned num_samples)
+{
+	for (unsigned n = 0; n < num_samples; n++) {
+		for (unsigned s = 0; s < 1 + MAX_NOTCH_STAGES; s++) {
+			if (_stages[s].enabled) {
+				apply_stage(_stages[s], samples[n]);
+			}
+		}
+	}
+}
+
+void LowPassFilter2pVector3::reset(float sample[3])
+{
+	for (unsigned s = 0; s < 1 + MAX_NOTCH_STAGES; s++) {
+		Stage &stage = _stages[s];
+		const float gain = stage.b0 + stage.b1 + stage.b2;
+
+		for (unsigned axis = 0; axis < 3; axis++) {
+			// every stage has unity DC gain, so in steady state each one sees the same input
+			const float dval = (stage.enabled && fabsf(gain) > 0.0f) ? sample[axis] / gain : 0.0f;
+			stage.delay_element_1[axis] = dval;
+			stage.delay_element_2[axis] = dval;
+		}
+	}
+
+	apply(sample);
+}
+
+} // namespace math
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file LowPassFilter2pVector3.hpp
+ *
+ * Second order low pass filter for the three axes of an inertial sensor, followed by
+ * optional notch stages. Filtering all axes (and all samples of a FIFO read) in one loop
+ * shares the coefficient loads and keeps the filter state in registers, which makes
+ * filtering at the full sensor rate affordable.
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+
+namespace math
+{
+class __EXPORT LowPassFilter2pVector3
+{
+public:
+	static constexpr unsigned MAX_NOTCH_STAGES = 2;
+
+	LowPassFilter2pVector3(float sample_freq, float cutoff_freq)
+	{
+		set_cutoff_frequency(sample_freq, cutoff_freq);
+	}
+
+	/**
+	 * Change the sample and low pass cutoff frequency. Enabled notch stages are
+	 * updated to the new sample frequency as well.
+	 *
+	 * @param cutoff_freq	cutoff frequency in Hz, 0 disables the low pass
+	 */
+	void set_cutoff_frequency(float sample_freq, float cutoff_freq);
+
+	/**
+	 * Configure a notch stage, which is applied after the low pass.
+	 *
+	 * @param index		notch stage, 0 ... MAX_NOTCH_STAGES - 1
+	 * @param notch_freq	center frequency in Hz, 0 disables the stage
+	 * @param bandwidth	bandwidth in Hz
+	 * @return		false if the index is invalid
+	 */
+	bool set_notch_frequency(unsigned index, float notch_freq, float bandwidth);
+
+	/**
+	 * Filter one sample in place.
+	 *
+	 * @param sample	x, y and z value
+	 */
+	void apply(float sample[3]) { apply((float (*)[3])sample, 1); }
+
+	/**
+	 * Filter a block of consecutive samples in place, e.g. all samples of a FIFO read.
+	 *
+	 * @param samples	x, y and z value of each sample, oldest first
+	 */
+	void apply(float samples[][3], unsigned num_samples);
+
+	/**
+	 * Reset the filter state to the steady state of this value and filter it.
+	 */
+	void reset(float sample[3]);
+
+	float get_cutoff_freq() const { return _cutoff_freq; }
+	float get_sample_freq() const { return _sample_freq; }
+	float get_notch_freq(unsigned index) const { return (index < MAX_NOTCH_STAGES) ? _notch_freq[index] : 0.0f; }
+
+private:
+	/** direct form II biquad, with the state of each axis */
+	struct Stage {
+		float b0{0.0f};
+		float b1{0.0f};
+		float b2{0.0f};
+		float a1{0.0f};
+		float a2{0.0f};
+		float delay_element_1[3] {};	// buffered sample -1
+		float delay_element_2[3] {};	// buffered sample -2
+		bool enabled{false};
+	};
+
+	void update_notch(unsigned index);
+
+	static void apply_stage(Stage &stage, float sample[3]);
+
+	float _sample_freq{0.0f};
+	float _cutoff_freq{0.0f};
+	float _notch_freq[MAX_NOTCH_STAGES] {};
+	float _notch_bandwidth[MAX_NOTCH_STAGES] {};
+
+	Stage _stages[1 + MAX_NOTCH_STAGES];	///< low pass, then the notch stages
+};
+
+} // namespace math
@@ -292,6 +292,67 @@ def generate_mixer_multirotor_header(geometries_list, use_normalized_mix=False,
 
     return buf.getvalue()
 
+def generate_mixer_multirotor_static_header(geometries_list):
+    '''
+    Generate C++ header file with one struct per geometry, holding the normalized mix as
+    constexpr structure-of-arrays columns. This allows the compiler to generate a fully
+    unrolled mixer for each geometry, with the rotor count and scales known at compile time.
+    The values are printed exactly as in the runtime tables (same format, converted from double),
+    so both give identical results.
+    '''
+    from io import StringIO
+    buf = StringIO()
+
+    def write_column(name, values):
+        buf.write(u"\tstatic constexpr float {}[rotor_count] = {{ {} }};\n".format(
+            name, ", ".join(u"{:9f}".format(v) for v in values)))
+
+    # Print Header
+    buf.write(u"/*\n")
+    buf.write(u"* This file is automatically generated by px_generate_mixers.py - do not edit.\n")
+    buf.write(u"*/\n")
+    buf.write(u"\n")
+    buf.write(u"#ifndef _MIXER_MULTI_STATIC_TABLES\n")
+    buf.write(u"#define _MIXER_MULTI_STATIC_TABLES\n")
+    buf.write(u"\n")
+
+    buf.write(u"namespace multirotor_static\n")
+    buf.write(u"{\n")
+    buf.write(u"namespace {\n\n")
+
+    for geometry in geometries_list:
+        mix = geometry['mix']['B_px']
+        name = geometry['info']['name']
+
+        buf.write(u"// {} (text key {})\n".format(geometry['info']['description'], geometry['info']['key']))
+        buf.write(u"struct {} {{\n".format(name))
+        buf.write(u"\tstatic constexpr unsigned rotor_count = {};\n".format(len(mix)))
+        write_column(u"roll_scale", [row[0] for row in mix])
+        write_column(u"pitch_scale", [row[1] for row in mix])
+        write_column(u"yaw_scale", [row[2] for row in mix])
+        # Upward thrust is positive TODO: to remove this, adapt PX4 to use NED correctly
+        write_column(u"thrust_scale", [-row[5] for row in mix])
+        buf.write(u"};\n")
+
+        for column in ['roll_scale', 'pitch_scale', 'yaw_scale', 'thrust_scale']:
+            buf.write(u"constexpr float {}::{}[];\n".format(name, column))
+
+        buf.write(u"\n")
+
+    buf.write(u"} // anonymous namespace\n")
+    buf.write(u"} // namespace multirotor_static\n\n")
+
+    # Print list of geometries, to be expanded with a macro taking (enum value, struct name)
+    buf.write(u"#define MULTIROTOR_STATIC_GEOMETRIES(X) \\\n")
+    for geometry in geometries_list:
+        buf.write(u"\tX({}, {}) \\\n".format(geometry['info']['name'].upper(), geometry['info']['name']))
+    buf.write(u"\n")
+
+    # Print footer
+    buf.write(u"#endif /* _MIXER_MULTI_STATIC_TABLES */\n\n")
+
+    return buf.getvalue()
+
 
 if __name__ == '__main__':
     import argparse
@@ -314,6 +375,8 @@ if __name__ == '__main__':
                         action='store_true')
     parser.add_argument('--sixdof', help='Use 6dof mixers',
                         action='store_true')
+    parser.add_argument('--static', help='Generate per-geometry mixer tables known at compile time (normalized mix)',
+                        action='store_true')
     args = parser.parse_args()
 
     # Find toml files
@@ -379,9 +442,12 @@ if __name__ == '__main__':
                     key_i, name_i, name_j))
 
     # Generate header file
-    header = generate_mixer_multirotor_header(geometries_list,
-                                              use_normalized_mix=args.normalize,
-                                              use_6dof=args.sixdof)
+    if args.static:
+        header = generate_mixer_multirotor_static_header(geometries_list)
+    else:
+        header = generate_mixer_multirotor_header(geometries_list,
+                                                  use_normalized_mix=args.normalize,
+                                                  use_6dof=args.sixdof)
 
     if args.outputfile is not None:
         # Write header file
@@ -345,6 +345,14 @@ public:
 	 *
 	 * R: <geometry> <roll scale> <pitch scale> <yaw scale> <deadband>
 	 *
+	 * Allocation Mixer
+	 * ................
+	 *
+	 * The allocation mixer uses the same geometries and definition as the
+	 * multirotor mixer, but resolves saturation by control allocation:
+	 *
+	 * A: <geometry> <roll scale> <pitch scale> <yaw scale> <deadband>
+	 *
 	 * Helicopter Mixer
 	 * ................
 	 *
@@ -667,7 +675,7 @@ public:
 		uint16_t value;
 	};
 
-private:
+protected:
 	float				_roll_scale;
 	float				_pitch_scale;
 	float				_yaw_scale;
@@ -678,16 +686,152 @@ private:
 	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low);
 	saturation_status _saturation_status;
 
+	/**
+	 * Parse a multirotor style mixer definition line.
+	 *
+	 * @param tag			Mixer type character the line must start with.
+	 * @param buf			Buffer containing the text description.
+	 * @param buflen		Length of the buffer in bytes, adjusted
+	 *				to reflect the bytes consumed.
+	 * @param geometry		Set to the parsed geometry.
+	 * @param scales		Set to the roll, pitch, yaw scales and the idle speed.
+	 * @return			true if the line was valid.
+	 */
+	static bool			parse_text(char tag, const char *buf, unsigned &buflen, MultirotorGeometry &geometry,
+			float scales[4]);
+
+	/**
+	 * Apply the thrust model and scale normalized [0,1] outputs to the range idle_speed...1.
+	 */
+	void				scale_outputs(unsigned rotor_count, float *outputs);
+
+	/**
+	 * Apply slew rate limiting and update the saturation status of all rotors (step 5 of mix()).
+	 */
+	void				limit_outputs(float *outputs);
+
+	MultirotorGeometry		_geometry;
 	unsigned			_rotor_count;
 	const Rotor			*_rotors;
 
+	/*
+	 * Rotor scales as structure-of-arrays columns (copied from _rotors), so that every
+	 * mixing pass is a branch-free multiply-add over all rotors which the compiler can vectorize.
+	 * All columns live in a single allocation owned by _mix_data.
+	 */
+	float				*_roll_scales = nullptr;
+	float				*_pitch_scales = nullptr;
+	float				*_yaw_scales = nullptr;
+	float				*_thrust_scales = nullptr;
+
+private:
+	/**
+	 * Mix roll, pitch, yaw and thrust to the rotor outputs, including thrust boost, yaw limiting
+	 * and scaling to the idle speed range (steps 1-4 of mix()).
+	 *
+	 * @param STATIC_ROTOR_COUNT	rotor count if known at compile time (loops are unrolled), 0 otherwise
+	 * @param dynamic_rotor_count	rotor count used if STATIC_ROTOR_COUNT is 0
+	 */
+	template<unsigned STATIC_ROTOR_COUNT>
+	void mix_rotors(unsigned dynamic_rotor_count, const float *roll_scales, const float *pitch_scales,
+			const float *yaw_scales, const float *thrust_scales, float roll, float pitch, float yaw, float thrust,
+			float *outputs);
+
 	float 				*_outputs_prev = nullptr;
+	float				*_mix_data = nullptr;
+	float				*_roll_pitch_out = nullptr;	/**< roll/pitch part of the current mix, reused by all passes */
 
 	/* do not allow to copy due to ptr data members */
 	MultirotorMixer(const MultirotorMixer &);
 	MultirotorMixer operator=(const MultirotorMixer &);
 };
 
+/**
+ * Multi-rotor mixer using control allocation.
+ *
+ * Uses the same geometries and definition as MultirotorMixer, but resolves saturation by
+ * the redistributed pseudo-inverse: rotors exceeding their range are clamped, and the
+ * remaining roll, pitch and thrust demand is allocated to the unsaturated rotors, prioritizing
+ * roll and pitch over thrust. Yaw is added afterwards as far as the rotors have headroom left. The control effectiveness matrix is computed once when the mixer is
+ * loaded, and the number of redistribution iterations is bounded, so the execution time of
+ * mix() is deterministic.
+ */
+class __EXPORT AllocationMixer : public MultirotorMixer
+{
+public:
+	/**
+	 * Constructor.
+	 *
+	 * See MultirotorMixer::MultirotorMixer() for the parameters.
+	 */
+	AllocationMixer(ControlCallback control_cb,
+			uintptr_t cb_handle,
+			MultirotorGeometry geometry,
+			float roll_scale,
+			float pitch_scale,
+			float yaw_scale,
+			float idle_speed);
+	~AllocationMixer();
+
+	/**
+	 * Factory method.
+	 *
+	 * Given a pointer to a buffer containing a text description of the mixer,
+	 * returns a pointer to a new instance of the mixer.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param buf			Buffer containing a text description of
+	 *				the mixer.
+	 * @param buflen		Length of the buffer in bytes, adjusted
+	 *				to reflect the bytes consumed.
+	 * @return			A new AllocationMixer instance, or nullptr
+	 *				if the text format is bad.
+	 */
+	static AllocationMixer		*from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf,
+			unsigned &buflen);
+
+	virtual unsigned		mix(float *outputs, unsigned space);
+
+	/**
+	 * Maximum number of redistribution steps per mix() call. Every step
+	 * clamps at least one rotor, rotors still violating their range
+	 * afterwards are clipped.
+	 */
+	static constexpr unsigned	MAX_ITERATIONS = 4;
+
+private:
+	/**
+	 * Solve the 4x4 system a * x = b in place by Gaussian elimination with partial pivoting.
+	 *
+	 * @return			false if the system is singular.
+	 */
+	static bool			solve4(float a[4][4], float b[4]);
+
+	/**
+	 * Allocate the demand by the redistributed pseudo-inverse, outputs end up in range [0,1].
+	 */
+	void				redistribute(const float demand[4], float *outputs);
+
+	/**
+	 * Add as much of the yaw demand to the outputs as fits without saturating a rotor.
+	 */
+	void				add_yaw(float yaw, float *outputs);
+
+	/*
+	 * Control effectiveness matrix (pseudo-inverse of the rotor mix), 4 rows of _rotor_count
+	 * columns, followed by the per rotor allocation workspace. Single allocation owned by _alloc_data.
+	 */
+	float				*_alloc_data = nullptr;
+	float				*_effectiveness[4] = {};
+	float				*_free = nullptr;		/**< 1 if the rotor is unsaturated, 0 if clamped */
+
+	/* do not allow to copy due to ptr data members */
+	AllocationMixer(const AllocationMixer &);
+	AllocationMixer operator=(const AllocationMixer &);
+};
+
 /** helicopter swash servo mixer */
 struct mixer_heli_servo_s {
 	float angle;
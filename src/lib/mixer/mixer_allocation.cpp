@@ -0,0 +1,356 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2012-2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mixer_allocation.cpp
+ *
+ * Multi-rotor mixer based on control allocation with a redistributed pseudo-inverse.
+ */
+#include <px4_config.h>
+#include <stdint.h>
+#include <float.h>
+#include <string.h>
+#include <math.h>
+
+#include <mathlib/math/Limits.hpp>
+
+#include "mixer.h"
+
+#define debug(fmt, args...)	do { } while(0)
+//#define debug(fmt, args...)	do { printf("[mixer] " fmt "\n", ##args); } while(0)
+
+namespace
+{
+
+/*
+ * Priority of roll, pitch, yaw and thrust if the demand cannot be met because of saturation.
+ * Only relevant once too few rotors are left unsaturated to control all four axes. Yaw is
+ * allocated separately afterwards, its weight only keeps the first pass from adding yaw.
+ */
+constexpr float axis_weight[4] = { 1.0f, 1.0f, 0.01f, 0.1f };
+
+/* damping of the least squares solutions, keeps them bounded for rank deficient geometries */
+constexpr float damping = 1e-4f;
+
+}
+
+AllocationMixer::AllocationMixer(ControlCallback control_cb,
+				 uintptr_t cb_handle,
+				 MultirotorGeometry geometry,
+				 float roll_scale,
+				 float pitch_scale,
+				 float yaw_scale,
+				 float idle_speed) :
+	MultirotorMixer(control_cb, cb_handle, geometry, roll_scale, pitch_scale, yaw_scale, idle_speed),
+	_alloc_data(new float[5 * _rotor_count])
+{
+	for (unsigned k = 0; k < 4; k++) {
+		_effectiveness[k] = &_alloc_data[k * _rotor_count];
+	}
+
+	_free = &_alloc_data[4 * _rotor_count];
+
+	/*
+	 * The mix maps roll, pitch, yaw and thrust to the rotors (u = B * v), the control effectiveness
+	 * maps the rotors back (v = E * u). E is the pseudo-inverse of B: E = (B^T * B)^-1 * B^T.
+	 */
+	const float *mix[4] = { _roll_scales, _pitch_scales, _yaw_scales, _thrust_scales };
+	float btb[4][4];
+
+	for (unsigned k = 0; k < 4; k++) {
+		for (unsigned l = 0; l < 4; l++) {
+			btb[k][l] = (k == l) ? FLT_EPSILON : 0.0f;
+
+			for (unsigned i = 0; i < _rotor_count; i++) {
+				btb[k][l] += mix[k][i] * mix[l][i];
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		float a[4][4];
+		float column[4] = { mix[0][i], mix[1][i], mix[2][i], mix[3][i] };
+
+		memcpy(a, btb, sizeof(a));
+
+		if (!solve4(a, column)) {
+			memset(column, 0, sizeof(column));
+		}
+
+		for (unsigned k = 0; k < 4; k++) {
+			_effectiveness[k][i] = column[k];
+		}
+
+		_free[i] = 1.0f;
+	}
+}
+
+AllocationMixer::~AllocationMixer()
+{
+	if (_alloc_data != nullptr) {
+		delete[] _alloc_data;
+	}
+}
+
+AllocationMixer *
+AllocationMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+{
+	MultirotorGeometry geometry;
+	float s[4];
+
+	if (!parse_text('A', buf, buflen, geometry, s)) {
+		return nullptr;
+	}
+
+	debug("adding allocation mixer");
+
+	return new AllocationMixer(
+		       control_cb,
+		       cb_handle,
+		       geometry,
+		       s[0],
+		       s[1],
+		       s[2],
+		       s[3]);
+}
+
+bool
+AllocationMixer::solve4(float a[4][4], float b[4])
+{
+	for (unsigned col = 0; col < 4; col++) {
+		/* partial pivoting */
+		unsigned pivot = col;
+
+		for (unsigned row = col + 1; row < 4; row++) {
+			if (fabsf(a[row][col]) > fabsf(a[pivot][col])) {
+				pivot = row;
+			}
+		}
+
+		if (fabsf(a[pivot][col]) < FLT_EPSILON * FLT_EPSILON) {
+			return false;
+		}
+
+		if (pivot != col) {
+			for (unsigned k = 0; k < 4; k++) {
+				float tmp = a[col][k];
+				a[col][k] = a[pivot][k];
+				a[pivot][k] = tmp;
+			}
+
+			float tmp = b[col];
+			b[col] = b[pivot];
+			b[pivot] = tmp;
+		}
+
+		for (unsigned row = col + 1; row < 4; row++) {
+			const float f = a[row][col] / a[col][col];
+
+			for (unsigned k = col; k < 4; k++) {
+				a[row][k] -= f * a[col][k];
+			}
+
+			b[row] -= f * b[col];
+		}
+	}
+
+	/* back substitution */
+	for (int row = 3; row >= 0; row--) {
+		for (unsigned k = row + 1; k < 4; k++) {
+			b[row] -= a[row][k] * b[k];
+		}
+
+		b[row] /= a[row][row];
+	}
+
+	return true;
+}
+
+void
+AllocationMixer::redistribute(const float demand[4], float *outputs)
+{
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] = demand[0] * _roll_scales[i] + demand[1] * _pitch_scales[i] +
+			     demand[2] * _yaw_scales[i] + demand[3] * _thrust_scales[i];
+		_free[i] = 1.0f;
+	}
+
+	for (unsigned iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+		bool clamped = false;
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (_free[i] > 0.0f && (outputs[i] < 0.0f || outputs[i] > 1.0f)) {
+				outputs[i] = math::constrain(outputs[i], 0.0f, 1.0f);
+				_free[i] = 0.0f;
+				clamped = true;
+			}
+		}
+
+		if (!clamped) {
+			break;
+		}
+
+		/* demand left for the free rotors, and their weighted effectiveness E_f * E_f^T * W */
+		float remaining[4];
+		float a[4][4];
+
+		for (unsigned k = 0; k < 4; k++) {
+			remaining[k] = demand[k];
+
+			for (unsigned i = 0; i < _rotor_count; i++) {
+				remaining[k] -= (1.0f - _free[i]) * _effectiveness[k][i] * outputs[i];
+			}
+
+			for (unsigned l = 0; l < 4; l++) {
+				float sum = 0.0f;
+
+				for (unsigned i = 0; i < _rotor_count; i++) {
+					sum += _free[i] * _effectiveness[k][i] * _effectiveness[l][i];
+				}
+
+				// the damping must not be weighted, W would cancel out of the solution otherwise
+				a[k][l] = sum * axis_weight[l] + ((k == l) ? damping : 0.0f);
+			}
+		}
+
+		/*
+		 * minimizes (E_f * u_f - remaining)^T * W * (E_f * u_f - remaining) + damping * |u_f|^2:
+		 * u_f = E_f^T * W * (E_f * E_f^T * W + damping * I)^-1 * remaining
+		 */
+		if (!solve4(a, remaining)) {
+			break;
+		}
+
+		for (unsigned k = 0; k < 4; k++) {
+			remaining[k] *= axis_weight[k];
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (_free[i] > 0.0f) {
+				outputs[i] = _effectiveness[0][i] * remaining[0] + _effectiveness[1][i] * remaining[1] +
+					     _effectiveness[2][i] * remaining[2] + _effectiveness[3][i] * remaining[3];
+			}
+		}
+	}
+
+	/* rotors still out of range after the last iteration are clipped */
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] = math::constrain(outputs[i], 0.0f, 1.0f);
+	}
+}
+
+void
+AllocationMixer::add_yaw(float yaw, float *outputs)
+{
+	/* yaw still missing after the roll, pitch and thrust allocation */
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		yaw -= _effectiveness[2][i] * outputs[i];
+	}
+
+	/* largest fraction of it that fits into the headroom of every rotor */
+	float scale = 1.0f;
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		const float delta = yaw * _yaw_scales[i];
+
+		if (delta > FLT_EPSILON) {
+			scale = math::min(scale, (1.0f - outputs[i]) / delta);
+
+		} else if (delta < -FLT_EPSILON) {
+			scale = math::min(scale, -outputs[i] / delta);
+		}
+	}
+
+	scale = math::max(scale, 0.0f);
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] = math::constrain(outputs[i] + scale * yaw * _yaw_scales[i], 0.0f, 1.0f);
+	}
+}
+
+unsigned
+AllocationMixer::mix(float *outputs, unsigned space)
+{
+	/* Summary of mixing strategy:
+	1) mix roll, pitch, yaw and thrust with the unconstrained pseudo-inverse. If no rotor
+		saturates, this is the result.
+	2) otherwise allocate roll, pitch and thrust without yaw: clamp the rotors violating the
+		range [0,1], subtract their contribution from the demand and allocate the rest to the
+		unclamped rotors by a least squares solution weighted by the axis priorities.
+		Repeat at most MAX_ITERATIONS times.
+	3) add as much of the yaw demand as fits into the headroom left on every rotor.
+	4) scale all outputs to range [idle_speed,1], apply slew rate limiting
+	*/
+
+	const float demand[4] = {
+		math::constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f),
+		math::constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f),
+		math::constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f),
+		math::constrain(get_control(0, 3), 0.0f, 1.0f)
+	};
+
+	// clean out class variable used to capture saturation
+	_saturation_status.value = 0;
+
+	float min_out = 1.0f;
+	float max_out = 0.0f;
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] = demand[0] * _roll_scales[i] + demand[1] * _pitch_scales[i] +
+			     demand[2] * _yaw_scales[i] + demand[3] * _thrust_scales[i];
+		min_out = (outputs[i] < min_out) ? outputs[i] : min_out;
+		max_out = (outputs[i] > max_out) ? outputs[i] : max_out;
+	}
+
+	// capture saturation
+	if (min_out < 0.0f) {
+		_saturation_status.flags.motor_neg = true;
+	}
+
+	if (max_out > 1.0f) {
+		_saturation_status.flags.motor_pos = true;
+	}
+
+	if (min_out < 0.0f || max_out > 1.0f) {
+		const float demand_no_yaw[4] = { demand[0], demand[1], 0.0f, demand[3] };
+
+		redistribute(demand_no_yaw, outputs);
+		add_yaw(demand[2], outputs);
+	}
+
+	scale_outputs(_rotor_count, outputs);
+
+	limit_outputs(outputs);
+
+	return _rotor_count;
+}
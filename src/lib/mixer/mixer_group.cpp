@@ -258,6 +258,13 @@ MixerGroup::load_from_buf(const char *buf, unsigned &buflen)
 			m = MultirotorMixer::from_text(_control_cb, _cb_handle, p, resid);
 			break;
 
+#ifdef MIXER_ALLOCATION
+
+		case 'A':
+			m = AllocationMixer::from_text(_control_cb, _cb_handle, p, resid);
+			break;
+#endif
+
 		case 'H':
 			m = HelicopterMixer::from_text(_control_cb, _cb_handle, p, resid);
 			break;
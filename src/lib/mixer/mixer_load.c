@@ -98,6 +98,14 @@ int load_mixer_file(const char *fname, char *buf, unsigned maxlen)
 			}
 		}
 
+		/* the parsers expect every line to be terminated, which the last line of a file may not be */
+		size_t len = strlen(line);
+
+		if (line[len - 1] != '\n' && len < sizeof(line) - 1) {
+			line[len] = '\n';
+			line[len + 1] = '\0';
+		}
+
 		/* if the line is too long to fit in the buffer, bail */
 		if ((strlen(line) + strlen(buf) + 1) >= maxlen) {
 			warnx("line too long");
@@ -60,6 +60,11 @@
 // #include "mixer_multirotor.generated.h"
 #include "mixer_multirotor_normalized.generated.h"
 
+#ifdef MIXER_MULTIROTOR_STATIC
+// Per-geometry tables known at compile time, generated by px_generate_mixers.py --static
+#include "mixer_multirotor_static.generated.h"
+#endif
+
 #define debug(fmt, args...)	do { } while(0)
 //#define debug(fmt, args...)	do { printf("[mixer] " fmt "\n", ##args); } while(0)
 //#include <debug.h>
@@ -84,11 +89,27 @@ MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
 	_idle_speed(-1.0f + idle_speed * 2.0f),	/* shift to output range here to avoid runtime calculation */
 	_delta_out_max(0.0f),
 	_thrust_factor(0.0f),
+	_geometry(geometry),
 	_rotor_count(_config_rotor_count[(MultirotorGeometryUnderlyingType)geometry]),
 	_rotors(_config_index[(MultirotorGeometryUnderlyingType)geometry]),
-	_outputs_prev(new float[_rotor_count])
+	_outputs_prev(new float[_rotor_count]),
+	_mix_data(new float[5 * _rotor_count])
 {
 	memset(_outputs_prev, _idle_speed, _rotor_count * sizeof(float));
+
+	_roll_scales = &_mix_data[0];
+	_pitch_scales = &_mix_data[_rotor_count];
+	_yaw_scales = &_mix_data[2 * _rotor_count];
+	_thrust_scales = &_mix_data[3 * _rotor_count];
+	_roll_pitch_out = &_mix_data[4 * _rotor_count];
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		_roll_scales[i] = _rotors[i].roll_scale;
+		_pitch_scales[i] = _rotors[i].pitch_scale;
+		_yaw_scales[i] = _rotors[i].yaw_scale;
+		_thrust_scales[i] = _rotors[i].thrust_scale;
+		_roll_pitch_out[i] = 0.0f;
+	}
 }
 
 MultirotorMixer::~MultirotorMixer()
@@ -96,40 +117,46 @@ MultirotorMixer::~MultirotorMixer()
 	if (_outputs_prev != nullptr) {
 		delete[] _outputs_prev;
 	}
+
+	if (_mix_data != nullptr) {
+		delete[] _mix_data;
+	}
 }
 
-MultirotorMixer *
-MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+bool
+MultirotorMixer::parse_text(char tag, const char *buf, unsigned &buflen, MultirotorGeometry &geometry, float scales[4])
 {
-	MultirotorGeometry geometry = MultirotorGeometry::MAX_GEOMETRY;
+	char type;
 	char geomname[8];
 	int s[4];
 	int used;
 
 	/* enforce that the mixer ends with a new line */
 	if (!string_well_formed(buf, buflen)) {
-		return nullptr;
+		return false;
 	}
 
-	if (sscanf(buf, "R: %7s %d %d %d %d%n", geomname, &s[0], &s[1], &s[2], &s[3], &used) != 5) {
+	if (sscanf(buf, "%c: %7s %d %d %d %d%n", &type, geomname, &s[0], &s[1], &s[2], &s[3], &used) != 6 || type != tag) {
 		debug("multirotor parse failed on '%s'", buf);
-		return nullptr;
+		return false;
 	}
 
 	if (used > (int)buflen) {
 		debug("OVERFLOW: multirotor spec used %d of %u", used, buflen);
-		return nullptr;
+		return false;
 	}
 
 	buf = skipline(buf, buflen);
 
 	if (buf == nullptr) {
 		debug("no line ending, line is incomplete");
-		return nullptr;
+		return false;
 	}
 
 	debug("remaining in buf: %d, first char: %c", buflen, buf[0]);
 
+	geometry = MultirotorGeometry::MAX_GEOMETRY;
+
 	for (MultirotorGeometryUnderlyingType i = 0; i < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY;
 	     i++) {
 		if (!strcmp(geomname, _config_key[i])) {
@@ -140,65 +167,96 @@ MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handl
 
 	if (geometry == MultirotorGeometry::MAX_GEOMETRY) {
 		debug("unrecognised geometry '%s'", geomname);
+		return false;
+	}
+
+	for (unsigned i = 0; i < 4; i++) {
+		scales[i] = s[i] / 10000.0f;
+	}
+
+	return true;
+}
+
+MultirotorMixer *
+MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+{
+	MultirotorGeometry geometry;
+	float s[4];
+
+	if (!parse_text('R', buf, buflen, geometry, s)) {
 		return nullptr;
 	}
 
-	debug("adding multirotor mixer '%s'", geomname);
+	debug("adding multirotor mixer");
 
 	return new MultirotorMixer(
 		       control_cb,
 		       cb_handle,
 		       geometry,
-		       s[0] / 10000.0f,
-		       s[1] / 10000.0f,
-		       s[2] / 10000.0f,
-		       s[3] / 10000.0f);
+		       s[0],
+		       s[1],
+		       s[2],
+		       s[3]);
 }
 
-unsigned
-MultirotorMixer::mix(float *outputs, unsigned space)
+void
+MultirotorMixer::scale_outputs(unsigned rotor_count, float *outputs)
 {
-	/* Summary of mixing strategy:
-	1) mix roll, pitch and thrust without yaw.
-	2) if some outputs violate range [0,1] then try to shift all outputs to minimize violation ->
-		increase or decrease total thrust (boost). The total increase or decrease of thrust is limited
-		(max_thrust_diff). If after the shift some outputs still violate the bounds then scale roll & pitch.
-		In case there is violation at the lower and upper bound then try to shift such that violation is equal
-		on both sides.
-	3) mix in yaw and scale if it leads to limit violation.
-	4) scale all outputs to range [idle_speed,1]
-	*/
+	/*
+		implement simple model for static relationship between applied motor pwm and motor thrust
+		model: thrust = (1 - _thrust_factor) * PWM + _thrust_factor * PWM^2
+		this model assumes normalized input / output in the range [0,1] so this is the right place
+		to do it as at this stage the outputs are in that range.
+	 */
+	if (_thrust_factor > 0.0f) {
+		for (unsigned i = 0; i < rotor_count; i++) {
+			outputs[i] = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor) + sqrtf((1.0f - _thrust_factor) *
+					(1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
+							_thrust_factor));
+		}
+	}
 
-	float		roll    = math::constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
-	float		pitch   = math::constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
-	float		yaw     = math::constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
-	float		thrust  = math::constrain(get_control(0, 3), 0.0f, 1.0f);
+	// scale outputs to range idle_speed...1
+	const float idle_speed = _idle_speed;
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		outputs[i] = math::constrain(idle_speed + (outputs[i] * (1.0f - idle_speed)), idle_speed, 1.0f);
+	}
+}
+
+template<unsigned STATIC_ROTOR_COUNT>
+inline void
+MultirotorMixer::mix_rotors(unsigned dynamic_rotor_count, const float *roll_scales, const float *pitch_scales,
+			    const float *yaw_scales, const float *thrust_scales, float roll, float pitch, float yaw, float thrust,
+			    float *outputs)
+{
 	float		min_out = 1.0f;
 	float		max_out = 0.0f;
 
-	// clean out class variable used to capture saturation
-	_saturation_status.value = 0;
+	/*
+	 * The passes over the rotors below operate on the structure-of-arrays columns. Apart from the
+	 * yaw limiting pass (where each rotor may reduce the yaw demand for the following ones) they
+	 * are free of loop-carried dependencies and branches, so they compile to vector multiply-adds.
+	 * If the rotor count is a compile-time constant, they are fully unrolled with the scales folded in.
+	 */
+	const unsigned rotor_count = (STATIC_ROTOR_COUNT > 0) ? STATIC_ROTOR_COUNT : dynamic_rotor_count;
+	float *__restrict roll_pitch_out = _roll_pitch_out;
+	float *__restrict out = outputs;
 
 	// thrust boost parameters
 	float thrust_increase_factor = 1.5f;
 	float thrust_decrease_factor = 0.6f;
 
 	/* perform initial mix pass yielding unbounded outputs, ignore yaw */
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		float out = roll * _rotors[i].roll_scale +
-			    pitch * _rotors[i].pitch_scale +
-			    thrust * _rotors[i].thrust_scale;
-
-		/* calculate min and max output values */
-		if (out < min_out) {
-			min_out = out;
-		}
-
-		if (out > max_out) {
-			max_out = out;
-		}
+	for (unsigned i = 0; i < rotor_count; i++) {
+		roll_pitch_out[i] = roll * roll_scales[i] + pitch * pitch_scales[i];
+		out[i] = roll_pitch_out[i] + thrust * thrust_scales[i];
+	}
 
-		outputs[i] = out;
+	/* calculate min and max output values */
+	for (unsigned i = 0; i < rotor_count; i++) {
+		min_out = (out[i] < min_out) ? out[i] : min_out;
+		max_out = (out[i] > max_out) ? out[i] : max_out;
 	}
 
 	float boost = 0.0f;		// value added to demanded thrust (can also be negative)
@@ -261,34 +319,31 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	float thrust_reduction = 0.0f;
 
 	// mix again but now with thrust boost, scale roll/pitch and also add yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		float out = (roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale) * roll_pitch_scale +
-			    yaw * _rotors[i].yaw_scale +
-			    (thrust + boost) * _rotors[i].thrust_scale;
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float out_i = roll_pitch_out[i] * roll_pitch_scale +
+			      yaw * yaw_scales[i] +
+			      (thrust + boost) * thrust_scales[i];
 
 		// scale yaw if it violates limits. inform about yaw limit reached
-		if (out < 0.0f) {
-			if (fabsf(_rotors[i].yaw_scale) <= FLT_EPSILON) {
+		if (out_i < 0.0f) {
+			if (fabsf(yaw_scales[i]) <= FLT_EPSILON) {
 				yaw = 0.0f;
 
 			} else {
-				yaw = -((roll * _rotors[i].roll_scale + pitch * _rotors[i].pitch_scale) *
-					roll_pitch_scale + thrust + boost) / _rotors[i].yaw_scale;
+				yaw = -(roll_pitch_out[i] * roll_pitch_scale + thrust + boost) / yaw_scales[i];
 			}
 
-		} else if (out > 1.0f) {
+		} else if (out_i > 1.0f) {
 			// allow to reduce thrust to get some yaw response
-			float prop_reduction = fminf(0.15f, out - 1.0f);
+			float prop_reduction = fminf(0.15f, out_i - 1.0f);
 			// keep the maximum requested reduction
 			thrust_reduction = fmaxf(thrust_reduction, prop_reduction);
 
-			if (fabsf(_rotors[i].yaw_scale) <= FLT_EPSILON) {
+			if (fabsf(yaw_scales[i]) <= FLT_EPSILON) {
 				yaw = 0.0f;
 
 			} else {
-				yaw = (1.0f - ((roll * _rotors[i].roll_scale + pitch * _rotors[i].pitch_scale) *
-					       roll_pitch_scale + (thrust - thrust_reduction) + boost)) / _rotors[i].yaw_scale;
+				yaw = (1.0f - (roll_pitch_out[i] * roll_pitch_scale + (thrust - thrust_reduction) + boost)) / yaw_scales[i];
 			}
 		}
 	}
@@ -296,29 +351,75 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	// Apply collective thrust reduction, the maximum for one prop
 	thrust -= thrust_reduction;
 
-	// add yaw and scale outputs to range idle_speed...1
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = (roll * _rotors[i].roll_scale +
-			      pitch * _rotors[i].pitch_scale) * roll_pitch_scale +
-			     yaw * _rotors[i].yaw_scale +
-			     (thrust + boost) * _rotors[i].thrust_scale;
-
-		/*
-			implement simple model for static relationship between applied motor pwm and motor thrust
-			model: thrust = (1 - _thrust_factor) * PWM + _thrust_factor * PWM^2
-			this model assumes normalized input / output in the range [0,1] so this is the right place
-			to do it as at this stage the outputs are in that range.
-		 */
-		if (_thrust_factor > 0.0f) {
-			outputs[i] = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor) + sqrtf((1.0f - _thrust_factor) *
-					(1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
-							_thrust_factor));
-		}
+	// add yaw
+	const float thrust_boosted = thrust + boost;
 
-		outputs[i] = math::constrain(_idle_speed + (outputs[i] * (1.0f - _idle_speed)), _idle_speed, 1.0f);
+	for (unsigned i = 0; i < rotor_count; i++) {
+		out[i] = roll_pitch_out[i] * roll_pitch_scale +
+			 yaw * yaw_scales[i] +
+			 thrust_boosted * thrust_scales[i];
+	}
+
+	scale_outputs(rotor_count, out);
+}
 
+unsigned
+MultirotorMixer::mix(float *outputs, unsigned space)
+{
+	/* Summary of mixing strategy:
+	1) mix roll, pitch and thrust without yaw.
+	2) if some outputs violate range [0,1] then try to shift all outputs to minimize violation ->
+		increase or decrease total thrust (boost). The total increase or decrease of thrust is limited
+		(max_thrust_diff). If after the shift some outputs still violate the bounds then scale roll & pitch.
+		In case there is violation at the lower and upper bound then try to shift such that violation is equal
+		on both sides.
+	3) mix in yaw and scale if it leads to limit violation.
+	4) scale all outputs to range [idle_speed,1]
+	*/
+
+	float		roll    = math::constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
+	float		pitch   = math::constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
+	float		yaw     = math::constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
+	float		thrust  = math::constrain(get_control(0, 3), 0.0f, 1.0f);
+
+	// clean out class variable used to capture saturation
+	_saturation_status.value = 0;
+
+#ifdef MIXER_MULTIROTOR_STATIC
+
+	// use the mixer generated for the geometry, with the rotor count and scales known at compile time
+	switch (_geometry) {
+#define MIX_STATIC_GEOMETRY(geometry_enum, geometry_name) \
+	case MultirotorGeometry::geometry_enum: \
+		mix_rotors<multirotor_static::geometry_name::rotor_count>(multirotor_static::geometry_name::rotor_count, \
+				multirotor_static::geometry_name::roll_scale, multirotor_static::geometry_name::pitch_scale, \
+				multirotor_static::geometry_name::yaw_scale, multirotor_static::geometry_name::thrust_scale, \
+				roll, pitch, yaw, thrust, outputs); \
+		break;
+
+		MULTIROTOR_STATIC_GEOMETRIES(MIX_STATIC_GEOMETRY)
+
+#undef MIX_STATIC_GEOMETRY
+
+	default:
+		mix_rotors<0>(_rotor_count, _roll_scales, _pitch_scales, _yaw_scales, _thrust_scales, roll, pitch, yaw, thrust,
+			      outputs);
+		break;
 	}
 
+#else
+	mix_rotors<0>(_rotor_count, _roll_scales, _pitch_scales, _yaw_scales, _thrust_scales, roll, pitch, yaw, thrust,
+		      outputs);
+#endif /* MIXER_MULTIROTOR_STATIC */
+
+	limit_outputs(outputs);
+
+	return _rotor_count;
+}
+
+void
+MultirotorMixer::limit_outputs(float *outputs)
+{
 	/* slew rate limiting and saturation checking */
 	for (unsigned i = 0; i < _rotor_count; i++) {
 		bool clipping_high = false;
@@ -356,8 +457,6 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 
 	// this will force the caller of the mixer to always supply new slew rate values, otherwise no slew rate limiting will happen
 	_delta_out_max = 0.0f;
-
-	return _rotor_count;
 }
 
 /*
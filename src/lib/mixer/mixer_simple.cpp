@@ -178,6 +178,12 @@ SimpleMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, c
 		goto out;
 	}
 
+	/* same limit as check(), also keeps MIXER_SIMPLE_SIZE() from overflowing */
+	if (inputs > 32) {
+		debug("simple mixer with too many inputs: %u", inputs);
+		goto out;
+	}
+
 	buf = skipline(buf, buflen);
 
 	if (buf == nullptr) {
@@ -46,6 +46,7 @@
 #include <px4_module.h>
 #include <px4_posix.h>
 #include <px4_tasks.h>
+#include <px4_time.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -76,6 +77,9 @@ __END_DECLS
 static ssize_t _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			   size_t count);
 static ssize_t _file_read(dm_item_t item, unsigned index, void *buf, size_t count);
+static ssize_t _file_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+				 const void *buf, size_t item_size);
+static ssize_t _file_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size);
 static int  _file_clear(dm_item_t item);
 static int  _file_restart(dm_reset_reason reason);
 static int _file_initialize(unsigned max_offset);
@@ -85,6 +89,9 @@ static void _file_shutdown();
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			  size_t count);
 static ssize_t _ram_read(dm_item_t item, unsigned index, void *buf, size_t count);
+static ssize_t _ram_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+				const void *buf, size_t item_size);
+static ssize_t _ram_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size);
 static int  _ram_clear(dm_item_t item);
 static int  _ram_restart(dm_reset_reason reason);
 static int _ram_initialize(unsigned max_offset);
@@ -97,6 +104,8 @@ static void _ram_shutdown();
 static ssize_t _ram_flash_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 				size_t count);
 static ssize_t _ram_flash_read(dm_item_t item, unsigned index, void *buf, size_t count);
+static ssize_t _ram_flash_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+				      const void *buf, size_t item_size);
 static int  _ram_flash_clear(dm_item_t item);
 static int  _ram_flash_restart(dm_reset_reason reason);
 static int _ram_flash_initialize(unsigned max_offset);
@@ -104,9 +113,29 @@ static void _ram_flash_shutdown();
 static int _ram_flash_wait(px4_sem_t *sem);
 #endif
 
+/* Private Journaled File based Operations */
+#define JOURNAL_BUFFER_SIZE 2048	/* pending journal records, committed with one write and sync */
+#define JOURNAL_COMMIT_TIMEOUT_USEC 100000	/* maximum time a record stays uncommitted */
+#define JOURNAL_CHECKPOINT_SIZE (64 * 1024)	/* journal size at which the data file is synced and the journal restarted */
+
+static ssize_t _journal_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
+			      size_t count);
+static ssize_t _journal_read(dm_item_t item, unsigned index, void *buf, size_t count);
+static ssize_t _journal_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+				    const void *buf, size_t item_size);
+static ssize_t _journal_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size);
+static int  _journal_clear(dm_item_t item);
+static int  _journal_restart(dm_reset_reason reason);
+static int _journal_initialize(unsigned max_offset);
+static void _journal_shutdown();
+static int _journal_wait(px4_sem_t *sem);
+
 typedef struct dm_operations_t {
 	ssize_t (*write)(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count);
 	ssize_t (*read)(dm_item_t item, unsigned index, void *buf, size_t count);
+	ssize_t (*write_range)(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+			       const void *buf, size_t item_size);
+	ssize_t (*read_range)(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size);
 	int (*clear)(dm_item_t item);
 	int (*restart)(dm_reset_reason reason);
 	int (*initialize)(unsigned max_offset);
@@ -117,6 +146,8 @@ typedef struct dm_operations_t {
 static dm_operations_t dm_file_operations = {
 	.write   = _file_write,
 	.read    = _file_read,
+	.write_range = _file_write_range,
+	.read_range = _file_read_range,
 	.clear   = _file_clear,
 	.restart = _file_restart,
 	.initialize = _file_initialize,
@@ -127,6 +158,8 @@ static dm_operations_t dm_file_operations = {
 static dm_operations_t dm_ram_operations = {
 	.write   = _ram_write,
 	.read    = _ram_read,
+	.write_range = _ram_write_range,
+	.read_range = _ram_read_range,
 	.clear   = _ram_clear,
 	.restart = _ram_restart,
 	.initialize = _ram_initialize,
@@ -138,6 +171,8 @@ static dm_operations_t dm_ram_operations = {
 static dm_operations_t dm_ram_flash_operations = {
 	.write   = _ram_flash_write,
 	.read    = _ram_flash_read,
+	.write_range = _ram_flash_write_range,
+	.read_range = _ram_read_range,
 	.clear   = _ram_flash_clear,
 	.restart = _ram_flash_restart,
 	.initialize = _ram_flash_initialize,
@@ -146,6 +181,18 @@ static dm_operations_t dm_ram_flash_operations = {
 };
 #endif
 
+static dm_operations_t dm_journal_operations = {
+	.write   = _journal_write,
+	.read    = _journal_read,
+	.write_range = _journal_write_range,
+	.read_range = _journal_read_range,
+	.clear   = _journal_clear,
+	.restart = _journal_restart,
+	.initialize = _journal_initialize,
+	.shutdown = _journal_shutdown,
+	.wait = _journal_wait,
+};
+
 static dm_operations_t *g_dm_ops;
 
 static struct {
@@ -165,6 +212,17 @@ static struct {
 			hrt_abstime flush_timeout_usec;
 		} ram_flash;
 #endif
+		struct {
+			int fd;
+			/* sync above with file backend */
+			int journal_fd;
+			uint8_t *buffer;
+			unsigned buffer_used;
+			unsigned journal_size;
+			hrt_abstime commit_timeout_usec;
+			unsigned commits;
+			unsigned checkpoints;
+		} journal;
 	};
 	bool running;
 } dm_operations_data;
@@ -173,6 +231,8 @@ static struct {
 typedef enum {
 	dm_write_func = 0,
 	dm_read_func,
+	dm_write_range_func,
+	dm_read_range_func,
 	dm_clear_func,
 	dm_restart_func,
 	dm_number_of_funcs
@@ -199,6 +259,21 @@ typedef struct {
 			void *buf;
 			size_t count;
 		} read_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned num_items;
+			dm_persitence_t persistence;
+			const void *buf;
+			size_t item_size;
+		} write_range_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned num_items;
+			void *buf;
+			size_t item_size;
+		} read_range_params;
 		struct {
 			dm_item_t item;
 		} clear_params;
@@ -240,6 +315,9 @@ static const unsigned g_per_item_size[DM_KEY_NUM_KEYS] = {
 /* Table of offset for index 0 of each item type */
 static unsigned int g_key_offsets[DM_KEY_NUM_KEYS];
 
+/* Buffer for the records of a range of items, so that a range can be transferred with few file operations */
+static uint8_t g_file_range_buffer[512];
+
 /* Item type lock mutexes */
 static px4_sem_t *g_item_locks[DM_KEY_NUM_KEYS];
 static px4_sem_t g_sys_state_mutex_mission;
@@ -252,6 +330,7 @@ static const char *default_device_path = PX4_ROOTFSDIR"/dataman";
 static const char *default_device_path = PX4_ROOTFSDIR"/fs/microsd/dataman";
 #endif
 static char *k_data_manager_device_path = nullptr;
+static char *k_data_manager_journal_path = nullptr;
 
 #if defined(FLASH_BASED_DATAMAN)
 static const dm_sector_descriptor_t *k_dataman_flash_sector = nullptr;
@@ -261,6 +340,7 @@ static enum {
 	BACKEND_NONE = 0,
 	BACKEND_FILE,
 	BACKEND_RAM,
+	BACKEND_JOURNAL,
 #if defined(FLASH_BASED_DATAMAN)
 	BACKEND_RAM_FLASH,
 #endif
@@ -668,6 +748,209 @@ _ram_flash_read(dm_item_t item, unsigned index, void *buf, size_t count)
 }
 #endif
 
+/* Limit a range of items to the items that exist for this item type */
+static unsigned
+limit_range(dm_item_t item, unsigned index, unsigned num_items)
+{
+	const unsigned max_index = g_per_item_max_index[item];
+
+	return (num_items > max_index - index) ? max_index - index : num_items;
+}
+
+/* Write consecutive items to the data manager RAM buffer */
+static ssize_t
+_ram_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence, const void *buf,
+		 size_t item_size)
+{
+	/* Get the offset for the first item, this also validates the item type */
+	if (calculate_offset(item, index) < 0) {
+		return -1;
+	}
+
+	num_items = limit_range(item, index, num_items);
+
+	const uint8_t *data = (const uint8_t *)buf;
+	unsigned i;
+
+	for (i = 0; i < num_items; i++) {
+		ssize_t ret = _ram_write(item, index + i, persistence, data + i * item_size, item_size);
+
+		if (ret != (ssize_t)item_size) {
+			/* report the error if not even the first item could be written */
+			if (i == 0) {
+				return ret < 0 ? ret : -1;
+			}
+
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Write consecutive items to the data manager file with a single seek, write and sync */
+static ssize_t
+_file_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence, const void *buf,
+		  size_t item_size)
+{
+	/* Get the offset for the first item */
+	int offset = calculate_offset(item, index);
+
+	/* If item type or index out of range, return error */
+	if (offset < 0) {
+		return -1;
+	}
+
+	/* Make sure caller has not given us more data than we can handle */
+	if (item_size > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	num_items = limit_range(item, index, num_items);
+
+	const unsigned record_size = g_per_item_size[item];
+	const unsigned records_per_chunk = sizeof(g_file_range_buffer) / record_size;
+	const uint8_t *data = (const uint8_t *)buf;
+	unsigned done = 0;
+
+	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
+		return -1;
+	}
+
+	/* The items are stored back to back, so a whole chunk of them is written at once */
+	while (done < num_items) {
+		const unsigned chunk = (num_items - done < records_per_chunk) ? num_items - done : records_per_chunk;
+
+		memset(g_file_range_buffer, 0, chunk * record_size);
+
+		for (unsigned i = 0; i < chunk; i++) {
+			uint8_t *record = &g_file_range_buffer[i * record_size];
+			record[0] = item_size;
+			record[1] = persistence;
+			memcpy(record + DM_SECTOR_HDR_SIZE, data + (done + i) * item_size, item_size);
+		}
+
+		ssize_t len = write(dm_operations_data.file.fd, g_file_range_buffer, chunk * record_size);
+
+		if (len != (ssize_t)(chunk * record_size)) {
+			break;
+		}
+
+		done += chunk;
+	}
+
+	/* Make sure data is written to physical media, once for all items */
+	fsync(dm_operations_data.file.fd);
+
+	if (done == 0 && num_items > 0) {
+		return -1;
+	}
+
+	return done;
+}
+
+#if defined(FLASH_BASED_DATAMAN)
+static ssize_t
+_ram_flash_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+		       const void *buf, size_t item_size)
+{
+	ssize_t ret = _ram_write_range(item, index, num_items, persistence, buf, item_size);
+
+	if (ret < 1) {
+		return ret;
+	}
+
+	if (persistence == DM_PERSIST_POWER_ON_RESET) {
+		_ram_flash_update_flush_timeout();
+	}
+
+	return ret;
+}
+#endif
+
+/* Retrieve consecutive items from the data manager RAM buffer */
+static ssize_t
+_ram_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size)
+{
+	/* Get the offset for the first item, this also validates the item type */
+	if (calculate_offset(item, index) < 0) {
+		return -1;
+	}
+
+	/* Make sure the caller hasn't asked for more data than we can handle */
+	if (item_size > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	num_items = limit_range(item, index, num_items);
+
+	uint8_t *data = (uint8_t *)buf;
+	unsigned i;
+
+	/* Stop at the first item that is empty or of a different size */
+	for (i = 0; i < num_items; i++) {
+		if (_ram_read(item, index + i, data + i * item_size, item_size) != (ssize_t)item_size) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Retrieve consecutive items from the data manager file with a single seek and one read per chunk */
+static ssize_t
+_file_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size)
+{
+	/* Get the offset for the first item */
+	int offset = calculate_offset(item, index);
+
+	/* If item type or index out of range, return error */
+	if (offset < 0) {
+		return -1;
+	}
+
+	/* Make sure the caller hasn't asked for more data than we can handle */
+	if (item_size > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	num_items = limit_range(item, index, num_items);
+
+	const unsigned record_size = g_per_item_size[item];
+	const unsigned records_per_chunk = sizeof(g_file_range_buffer) / record_size;
+	uint8_t *data = (uint8_t *)buf;
+	unsigned done = 0;
+
+	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
+		return -1;
+	}
+
+	while (done < num_items) {
+		const unsigned chunk = (num_items - done < records_per_chunk) ? num_items - done : records_per_chunk;
+
+		ssize_t len = read(dm_operations_data.file.fd, g_file_range_buffer, chunk * record_size);
+
+		/* Check for read error */
+		if (len < 0) {
+			return (done > 0) ? (ssize_t)done : -errno;
+		}
+
+		for (unsigned i = 0; i < chunk; i++) {
+			const uint8_t *record = &g_file_range_buffer[i * record_size];
+
+			/* Stop at the end of the file and at the first item that is empty or of a different size */
+			if ((ssize_t)(i * record_size + DM_SECTOR_HDR_SIZE + item_size) > len || record[0] != item_size) {
+				return done;
+			}
+
+			memcpy(data + done * item_size, record + DM_SECTOR_HDR_SIZE, item_size);
+			done++;
+		}
+	}
+
+	return done;
+}
+
 static int  _ram_clear(dm_item_t item)
 {
 	int i;
@@ -1079,6 +1362,482 @@ _ram_flash_wait(px4_sem_t *sem)
 }
 #endif
 
+/* Each journal record is a header followed by the item as it is stored in the data manager file
+ * (DM_SECTOR_HDR_SIZE prefix and user data). Records are appended to a RAM buffer and committed to the
+ * journal file with a single write and sync, either when the buffer is full or after JOURNAL_COMMIT_TIMEOUT_USEC.
+ * Only after a commit the items are written to the data manager file, without syncing it. The data manager file
+ * is synced at a checkpoint, after which the journal is restarted. At startup, all valid records of the journal
+ * are applied to the data manager file again, so a power loss can only lose the records that were not committed.
+ */
+#define JOURNAL_RECORD_MAGIC 0xD4
+
+typedef struct {
+	uint8_t magic;
+	uint8_t item;
+	uint16_t index;
+	uint16_t length;	/* length of the stored item, including DM_SECTOR_HDR_SIZE */
+	uint16_t reserved;
+	uint32_t crc;		/* CRC32 of the header (with crc set to 0) and the stored item */
+} journal_record_hdr_t;
+
+static uint32_t
+_journal_crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+	crc = ~crc;
+
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+		}
+	}
+
+	return ~crc;
+}
+
+static uint32_t
+_journal_record_crc(const journal_record_hdr_t *hdr, const uint8_t *data)
+{
+	journal_record_hdr_t tmp = *hdr;
+	tmp.crc = 0;
+
+	uint32_t crc = _journal_crc32(0, (const uint8_t *)&tmp, sizeof(tmp));
+	return _journal_crc32(crc, data, hdr->length);
+}
+
+/* Validate a record header read from the journal */
+static bool
+_journal_record_valid(const journal_record_hdr_t *hdr)
+{
+	return hdr->magic == JOURNAL_RECORD_MAGIC && hdr->item < DM_KEY_NUM_KEYS
+	       && hdr->index < g_per_item_max_index[hdr->item]
+	       && hdr->length >= DM_SECTOR_HDR_SIZE && hdr->length <= g_per_item_size[hdr->item];
+}
+
+/* Write the item of a journal record to its place in the data manager file, without syncing */
+static int
+_journal_apply_record(const journal_record_hdr_t *hdr, const uint8_t *data)
+{
+	int offset = calculate_offset((dm_item_t)hdr->item, hdr->index);
+
+	if (offset < 0 || lseek(dm_operations_data.journal.fd, offset, SEEK_SET) != offset) {
+		return -1;
+	}
+
+	if (write(dm_operations_data.journal.fd, data, hdr->length) != hdr->length) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Sync the data manager file and start over with an empty journal */
+static int
+_journal_checkpoint()
+{
+	/* The journal is the only durable copy of its records until the data manager file is synced */
+	if (fsync(dm_operations_data.journal.fd) != 0) {
+		PX4_ERR("Could not sync data manager file, keeping the journal");
+		return -1;
+	}
+
+	if (dm_operations_data.journal.journal_fd >= 0) {
+		close(dm_operations_data.journal.journal_fd);
+	}
+
+	dm_operations_data.journal.journal_fd = open(k_data_manager_journal_path, O_RDWR | O_CREAT | O_TRUNC | O_BINARY,
+						PX4_O_MODE_666);
+
+	if (dm_operations_data.journal.journal_fd < 0) {
+		PX4_ERR("Could not open data manager journal %s", k_data_manager_journal_path);
+		return -1;
+	}
+
+	fsync(dm_operations_data.journal.journal_fd);
+	dm_operations_data.journal.journal_size = 0;
+	dm_operations_data.journal.checkpoints++;
+
+	return 0;
+}
+
+/* Commit the pending records to the journal with one write and sync, then apply them to the data manager file.
+ * The records stay pending until they are durable, a failed commit is retried with the next one. */
+static int
+_journal_commit()
+{
+	const unsigned used = dm_operations_data.journal.buffer_used;
+
+	if (used == 0) {
+		return 0;
+	}
+
+	if (dm_operations_data.journal.journal_fd < 0
+	    || write(dm_operations_data.journal.journal_fd, dm_operations_data.journal.buffer, used) != (ssize_t)used
+	    || fsync(dm_operations_data.journal.journal_fd) != 0) {
+		PX4_ERR("Data manager journal commit failed");
+
+		/* Drop what made it into the journal, the retry appends at the same place */
+		if (dm_operations_data.journal.journal_fd >= 0
+		    && (ftruncate(dm_operations_data.journal.journal_fd, dm_operations_data.journal.journal_size) != 0
+			|| lseek(dm_operations_data.journal.journal_fd, dm_operations_data.journal.journal_size, SEEK_SET) < 0)) {
+			PX4_ERR("Could not truncate data manager journal");
+		}
+
+		/* Don't retry right away from _journal_wait() */
+		dm_operations_data.journal.commit_timeout_usec = hrt_absolute_time() + JOURNAL_COMMIT_TIMEOUT_USEC;
+		return -1;
+	}
+
+	dm_operations_data.journal.buffer_used = 0;
+	dm_operations_data.journal.commit_timeout_usec = 0;
+	dm_operations_data.journal.journal_size += used;
+	dm_operations_data.journal.commits++;
+
+	/* Now that the records are durable, the data manager file can be updated */
+	int result = 0;
+	unsigned pos = 0;
+
+	while (pos < used) {
+		journal_record_hdr_t hdr;
+		memcpy(&hdr, &dm_operations_data.journal.buffer[pos], sizeof(hdr));
+		pos += sizeof(hdr);
+
+		if (_journal_apply_record(&hdr, &dm_operations_data.journal.buffer[pos]) < 0) {
+			result = -1;
+		}
+
+		pos += hdr.length;
+	}
+
+	if (dm_operations_data.journal.journal_size >= JOURNAL_CHECKPOINT_SIZE) {
+		_journal_checkpoint();
+	}
+
+	return result;
+}
+
+/* Find the newest pending record of an item, returns the offset of its data in the buffer or -1 */
+static int
+_journal_find_pending(dm_item_t item, unsigned index)
+{
+	int found = -1;
+	unsigned pos = 0;
+
+	while (pos < dm_operations_data.journal.buffer_used) {
+		journal_record_hdr_t hdr;
+		memcpy(&hdr, &dm_operations_data.journal.buffer[pos], sizeof(hdr));
+		pos += sizeof(hdr);
+
+		if (hdr.item == item && hdr.index == index) {
+			found = pos;
+		}
+
+		pos += hdr.length;
+	}
+
+	return found;
+}
+
+/* Append an item to the pending journal records */
+static ssize_t
+_journal_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	/* Get the offset for this item, this also validates the item type and index */
+	if (calculate_offset(item, index) < 0) {
+		return -1;
+	}
+
+	/* Make sure caller has not given us more data than we can handle */
+	if (count > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	journal_record_hdr_t hdr;
+	hdr.magic = JOURNAL_RECORD_MAGIC;
+	hdr.item = item;
+	hdr.index = index;
+	hdr.length = count + DM_SECTOR_HDR_SIZE;
+	hdr.reserved = 0;
+
+	/* Commit the pending records first if this one does not fit anymore */
+	if (dm_operations_data.journal.buffer_used + sizeof(hdr) + hdr.length > JOURNAL_BUFFER_SIZE) {
+		if (_journal_commit() < 0) {
+			return -1;
+		}
+	}
+
+	if (dm_operations_data.journal.buffer_used == 0) {
+		dm_operations_data.journal.commit_timeout_usec = hrt_absolute_time() + JOURNAL_COMMIT_TIMEOUT_USEC;
+	}
+
+	/* Store the item the same way as in the data manager file, prefixed with length and persistence level */
+	uint8_t *data = &dm_operations_data.journal.buffer[dm_operations_data.journal.buffer_used + sizeof(hdr)];
+	data[0] = count;
+	data[1] = persistence;
+	data[2] = 0;
+	data[3] = 0;
+
+	if (count > 0) {
+		memcpy(data + DM_SECTOR_HDR_SIZE, buf, count);
+	}
+
+	hdr.crc = _journal_record_crc(&hdr, data);
+	memcpy(&dm_operations_data.journal.buffer[dm_operations_data.journal.buffer_used], &hdr, sizeof(hdr));
+	dm_operations_data.journal.buffer_used += sizeof(hdr) + hdr.length;
+
+	/* The mission state completes a mission transaction, don't leave it pending */
+	if (item == DM_KEY_MISSION_STATE || item == DM_KEY_COMPAT) {
+		if (_journal_commit() < 0) {
+			return -1;
+		}
+	}
+
+	return count;
+}
+
+/* Retrieve an item, pending records take precedence over the data manager file */
+static ssize_t
+_journal_read(dm_item_t item, unsigned index, void *buf, size_t count)
+{
+	/* Get the offset for this item, this also validates the item type and index */
+	if (calculate_offset(item, index) < 0) {
+		return -1;
+	}
+
+	/* Make sure the caller hasn't asked for more data than we can handle */
+	if (count > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	int pending = _journal_find_pending(item, index);
+
+	if (pending < 0) {
+		return _file_read(item, index, buf, count);
+	}
+
+	const uint8_t *data = &dm_operations_data.journal.buffer[pending];
+
+	/* See if we got data */
+	if (data[0] > 0) {
+		/* We got more than requested!!! */
+		if (data[0] > count) {
+			return -1;
+		}
+
+		memcpy(buf, data + DM_SECTOR_HDR_SIZE, data[0]);
+	}
+
+	/* Return the number of bytes of caller data read */
+	return data[0];
+}
+
+/* Append consecutive items to the pending journal records */
+static ssize_t
+_journal_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence,
+		     const void *buf, size_t item_size)
+{
+	/* Get the offset for the first item, this also validates the item type */
+	if (calculate_offset(item, index) < 0) {
+		return -1;
+	}
+
+	num_items = limit_range(item, index, num_items);
+
+	const uint8_t *data = (const uint8_t *)buf;
+	unsigned i;
+
+	for (i = 0; i < num_items; i++) {
+		ssize_t ret = _journal_write(item, index + i, persistence, data + i * item_size, item_size);
+
+		if (ret != (ssize_t)item_size) {
+			/* report the error if not even the first item could be written */
+			if (i == 0) {
+				return ret < 0 ? ret : -1;
+			}
+
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Retrieve consecutive items from the data manager file, committing pending records of this item type first */
+static ssize_t
+_journal_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size)
+{
+	unsigned pos = 0;
+
+	while (pos < dm_operations_data.journal.buffer_used) {
+		journal_record_hdr_t hdr;
+		memcpy(&hdr, &dm_operations_data.journal.buffer[pos], sizeof(hdr));
+
+		if (hdr.item == item) {
+			_journal_commit();
+			break;
+		}
+
+		pos += sizeof(hdr) + hdr.length;
+	}
+
+	return _file_read_range(item, index, num_items, buf, item_size);
+}
+
+static int
+_journal_clear(dm_item_t item)
+{
+	/* Replaying older records after a clear would bring the cleared items back */
+	if (_journal_commit() < 0 || _journal_checkpoint() < 0) {
+		return -1;
+	}
+
+	return _file_clear(item);
+}
+
+static int
+_journal_restart(dm_reset_reason reason)
+{
+	if (_journal_commit() < 0 || _journal_checkpoint() < 0) {
+		return -1;
+	}
+
+	return _file_restart(reason);
+}
+
+/* Apply all valid records of the journal to the data manager file and start over with an empty journal */
+static int
+_journal_recover()
+{
+	dm_operations_data.journal.fd = open(k_data_manager_device_path, O_RDWR | O_CREAT | O_BINARY, PX4_O_MODE_666);
+
+	if (dm_operations_data.journal.fd < 0) {
+		return -1;
+	}
+
+	dm_operations_data.journal.journal_fd = open(k_data_manager_journal_path, O_RDONLY | O_BINARY);
+
+	unsigned replayed = 0;
+
+	if (dm_operations_data.journal.journal_fd >= 0) {
+		journal_record_hdr_t hdr;
+		uint8_t *data = dm_operations_data.journal.buffer;
+
+		/* A torn or corrupted record marks the end of the committed records */
+		while (read(dm_operations_data.journal.journal_fd, &hdr, sizeof(hdr)) == sizeof(hdr)
+		       && _journal_record_valid(&hdr)
+		       && read(dm_operations_data.journal.journal_fd, data, hdr.length) == hdr.length
+		       && _journal_record_crc(&hdr, data) == hdr.crc) {
+
+			if (_journal_apply_record(&hdr, data) < 0) {
+				break;
+			}
+
+			replayed++;
+		}
+	}
+
+	if (replayed > 0) {
+		PX4_INFO("Recovered %u data manager journal records", replayed);
+	}
+
+	int ret = _journal_checkpoint();
+	close(dm_operations_data.journal.fd);
+
+	return ret;
+}
+
+static int
+_journal_initialize(unsigned max_offset)
+{
+	const size_t path_len = strlen(k_data_manager_device_path) + sizeof(".jnl");
+	k_data_manager_journal_path = (char *)malloc(path_len);
+	dm_operations_data.journal.buffer = (uint8_t *)malloc(JOURNAL_BUFFER_SIZE);
+	dm_operations_data.journal.buffer_used = 0;
+	dm_operations_data.journal.journal_size = 0;
+	dm_operations_data.journal.commit_timeout_usec = 0;
+	dm_operations_data.journal.commits = 0;
+	dm_operations_data.journal.checkpoints = 0;
+
+	if (k_data_manager_journal_path == nullptr || dm_operations_data.journal.buffer == nullptr) {
+		PX4_WARN("Could not allocate data manager journal");
+		goto fail;
+	}
+
+	snprintf(k_data_manager_journal_path, path_len, "%s.jnl", k_data_manager_device_path);
+
+	if (_journal_recover() < 0) {
+		PX4_WARN("Could not recover data manager journal %s", k_data_manager_journal_path);
+		goto fail;
+	}
+
+	/* The data manager file is consistent now, open it the same way as the file backend does */
+	if (_file_initialize(max_offset) < 0) {
+		close(dm_operations_data.journal.journal_fd);
+		free(k_data_manager_journal_path);
+		k_data_manager_journal_path = nullptr;
+		free(dm_operations_data.journal.buffer);
+		return -1;
+	}
+
+	return 0;
+
+fail:
+	free(k_data_manager_journal_path);
+	k_data_manager_journal_path = nullptr;
+	free(dm_operations_data.journal.buffer);
+	px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+	return -1;
+}
+
+static void
+_journal_shutdown()
+{
+	_journal_commit();
+	_journal_checkpoint();
+
+	close(dm_operations_data.journal.journal_fd);
+	free(k_data_manager_journal_path);
+	k_data_manager_journal_path = nullptr;
+	free(dm_operations_data.journal.buffer);
+
+	_file_shutdown();
+}
+
+static int
+_journal_wait(px4_sem_t *sem)
+{
+	if (!dm_operations_data.journal.commit_timeout_usec) {
+		px4_sem_wait(sem);
+		return 0;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	if (now >= dm_operations_data.journal.commit_timeout_usec) {
+		_journal_commit();
+		return 0;
+	}
+
+	/* Wait for more work until the pending records need to be committed */
+	const uint64_t diff = dm_operations_data.journal.commit_timeout_usec - now;
+	struct timespec abstime;
+	px4_clock_gettime(CLOCK_REALTIME, &abstime);
+	const uint64_t nsecs = abstime.tv_nsec + diff * 1000;
+	abstime.tv_sec += nsecs / 1000000000;
+	abstime.tv_nsec = nsecs % 1000000000;
+
+	px4_sem_timedwait(sem, &abstime);
+
+	if (hrt_absolute_time() < dm_operations_data.journal.commit_timeout_usec) {
+		/* a work was queued before timeout */
+		return 0;
+	}
+
+	_journal_commit();
+	return 0;
+}
+
 /** Write to the data manager file */
 __EXPORT ssize_t
 dm_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -1132,6 +1891,62 @@ dm_read(dm_item_t item, unsigned index, void *buf, size_t count)
 	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
 }
 
+/** Write consecutive items to the data manager file */
+__EXPORT ssize_t
+dm_write_range(dm_item_t item, unsigned index, unsigned num_items, dm_persitence_t persistence, const void *buf,
+	       size_t item_size)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a range write request */
+	if ((work = create_work_item()) == nullptr) {
+		return -1;
+	}
+
+	work->func = dm_write_range_func;
+	work->write_range_params.item = item;
+	work->write_range_params.index = index;
+	work->write_range_params.num_items = num_items;
+	work->write_range_params.persistence = persistence;
+	work->write_range_params.buf = buf;
+	work->write_range_params.item_size = item_size;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
+/** Retrieve consecutive items from the data manager file */
+__EXPORT ssize_t
+dm_read_range(dm_item_t item, unsigned index, unsigned num_items, void *buf, size_t item_size)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a range read request */
+	if ((work = create_work_item()) == nullptr) {
+		return -1;
+	}
+
+	work->func = dm_read_range_func;
+	work->read_range_params.item = item;
+	work->read_range_params.index = index;
+	work->read_range_params.num_items = num_items;
+	work->read_range_params.buf = buf;
+	work->read_range_params.item_size = item_size;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
 /** Clear a data Item */
 __EXPORT int
 dm_clear(dm_item_t item)
@@ -1262,6 +2077,10 @@ task_main(int argc, char *argv[])
 		g_dm_ops = &dm_ram_operations;
 		break;
 
+	case BACKEND_JOURNAL:
+		g_dm_ops = &dm_journal_operations;
+		break;
+
 #if defined(FLASH_BASED_DATAMAN)
 
 	case BACKEND_RAM_FLASH:
@@ -1349,6 +2168,11 @@ task_main(int argc, char *argv[])
 			 restart_type_str, max_offset);
 		break;
 
+	case BACKEND_JOURNAL:
+		PX4_INFO("%s, data manager file '%s' size is %d bytes, journal '%s'",
+			 restart_type_str, k_data_manager_device_path, max_offset, k_data_manager_journal_path);
+		break;
+
 #if defined(FLASH_BASED_DATAMAN)
 
 	case BACKEND_RAM_FLASH:
@@ -1392,6 +2216,22 @@ task_main(int argc, char *argv[])
 					g_dm_ops->read(work->read_params.item, work->read_params.index, work->read_params.buf, work->read_params.count);
 				break;
 
+			case dm_write_range_func:
+				g_func_counts[dm_write_range_func]++;
+				work->result =
+					g_dm_ops->write_range(work->write_range_params.item, work->write_range_params.index,
+							      work->write_range_params.num_items, work->write_range_params.persistence,
+							      work->write_range_params.buf, work->write_range_params.item_size);
+				break;
+
+			case dm_read_range_func:
+				g_func_counts[dm_read_range_func]++;
+				work->result =
+					g_dm_ops->read_range(work->read_range_params.item, work->read_range_params.index,
+							     work->read_range_params.num_items, work->read_range_params.buf,
+							     work->read_range_params.item_size);
+				break;
+
 			case dm_clear_func:
 				g_func_counts[dm_clear_func]++;
 				work->result = g_dm_ops->clear(work->clear_params.item);
@@ -1472,9 +2312,16 @@ status()
 	/* display usage statistics */
 	PX4_INFO("Writes   %d", g_func_counts[dm_write_func]);
 	PX4_INFO("Reads    %d", g_func_counts[dm_read_func]);
+	PX4_INFO("Range writes %d", g_func_counts[dm_write_range_func]);
+	PX4_INFO("Range reads  %d", g_func_counts[dm_read_range_func]);
 	PX4_INFO("Clears   %d", g_func_counts[dm_clear_func]);
 	PX4_INFO("Restarts %d", g_func_counts[dm_restart_func]);
 	PX4_INFO("Max Q lengths work %d, free %d", g_work_q.max_size, g_free_q.max_size);
+
+	if (backend == BACKEND_JOURNAL) {
+		PX4_INFO("Journal commits %d, checkpoints %d", dm_operations_data.journal.commits,
+			 dm_operations_data.journal.checkpoints);
+	}
 }
 
 static void
@@ -1494,6 +2341,7 @@ usage()
 Module to provide persistent storage for the rest of the system in form of a simple database through a C API.
 Multiple backends are supported:
 - a file (eg. on the SD card)
+- a file with a write-ahead journal, so that writes are synced in batches instead of one by one
 - FLASH (if the board supports it)
 - FRAM
 - RAM (this is obviously not persistent)
@@ -1517,7 +2365,8 @@ check for geofence violations.
 	PRINT_MODULE_USAGE_PARAM_STRING('f', nullptr, "<file>", "Storage file", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Use RAM backend (NOT persistent)", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('i', "Use FLASH backend", true);
-	PRINT_MODULE_USAGE_PARAM_COMMENT("The options -f, -r and -i are mutually exclusive. If nothing is specified, a file 'dataman' is used");
+	PRINT_MODULE_USAGE_PARAM_STRING('j', nullptr, "<file>", "Storage file, written through a journal", true);
+	PRINT_MODULE_USAGE_PARAM_COMMENT("The options -f, -r, -i and -j are mutually exclusive. If nothing is specified, a file 'dataman' is used");
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("poweronrestart", "Restart dataman (on power on)");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("inflightrestart", "Restart dataman (in flight)");
@@ -1527,7 +2376,7 @@ check for geofence violations.
 static int backend_check()
 {
 	if (backend != BACKEND_NONE) {
-		PX4_WARN("-f, -r and -i are mutually exclusive");
+		PX4_WARN("-f, -r, -i and -j are mutually exclusive");
 		usage();
 		return -1;
 	}
@@ -1556,7 +2405,7 @@ dataman_main(int argc, char *argv[])
 
 		/* jump over start and look at options first */
 
-		while ((ch = px4_getopt(argc, argv, "f:ri", &dmoptind, &dmoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "f:rij:", &dmoptind, &dmoptarg)) != EOF) {
 			switch (ch) {
 			case 'f':
 				if (backend_check()) {
@@ -1576,6 +2425,16 @@ dataman_main(int argc, char *argv[])
 				backend = BACKEND_RAM;
 				break;
 
+			case 'j':
+				if (backend_check()) {
+					return -1;
+				}
+
+				backend = BACKEND_JOURNAL;
+				k_data_manager_device_path = strdup(dmoptarg);
+				PX4_INFO("dataman file set to: %s (journaled)", k_data_manager_device_path);
+				break;
+
 			case 'i':
 #if defined(FLASH_BASED_DATAMAN)
 				if (backend_check()) {
@@ -125,6 +125,37 @@ dm_write(
 	size_t buflen			/* Length in bytes of data to retrieve */
 );
 
+/**
+ * Retrieve consecutive items from the data manager store with a single request.
+ * The items are stored back to back in the caller's buffer.
+ * @return the number of items read, which is less than num_items if the range reaches the end of the item type or
+ *         an item that is empty or has a different size than item_size. -1 on error.
+ */
+__EXPORT ssize_t
+dm_read_range(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	unsigned num_items,		/* The number of items to retrieve */
+	void *buffer,			/* Pointer to caller data buffer, num_items * item_size bytes */
+	size_t item_size		/* Length in bytes of each item */
+);
+
+/**
+ * Write consecutive items to the data manager store with a single request.
+ * This is much faster than writing the items one by one, as the file backend syncs only once.
+ * @return the number of items written, which is less than num_items if the range reaches the end of the item type
+ *         or on a write error. -1 if no item could be written.
+ */
+__EXPORT ssize_t
+dm_write_range(
+	dm_item_t item,			/* The item type to store */
+	unsigned index,			/* The index of the first item */
+	unsigned num_items,		/* The number of items to store */
+	dm_persitence_t persistence,	/* The persistence level of the items */
+	const void *buffer,		/* Pointer to caller data buffer, num_items * item_size bytes */
+	size_t item_size		/* Length in bytes of each item */
+);
+
 /**
  * Lock all items of a type. Can be used for atomic updates of multiple items (single items are always updated
  * atomically).
@@ -480,6 +480,13 @@ void Ekf2::run()
 	fds[0].fd = sensors_sub;
 	fds[0].events = POLLIN;
 
+	// set up the poll once instead of on every iteration
+	px4_pollset_t poll_set;
+	if (px4_pollset_init(&poll_set, fds, sizeof(fds) / sizeof(fds[0])) != PX4_OK) {
+		// px4_pollset_wait() then polls the fds on every call
+		PX4_WARN("poll set setup failed, polling per iteration");
+	}
+
 	// initialise parameter cache
 	updateParams();
 
@@ -501,7 +508,7 @@ void Ekf2::run()
 	landing_target_pose_s landing_target_pose = {};
 
 	while (!should_exit()) {
-		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), 1000);
+		int ret = px4_pollset_wait(&poll_set, 1000);
 
 		if (!(fds[0].revents & POLLIN)) {
 			// no new data
@@ -525,7 +532,7 @@ void Ekf2::run()
 			// read from param to clear updated flag
 			parameter_update_s update;
 			orb_copy(ORB_ID(parameter_update), params_sub, &update);
-			updateParams();
+			updateParamsChanged(update.instance);
 		}
 
 		bool gps_updated = false;
@@ -918,8 +925,9 @@ void Ekf2::run()
 
 			{
 				// generate vehicle attitude quaternion data
-				vehicle_attitude_s att;
+				vehicle_attitude_s att = {};
 				att.timestamp = now;
+				att.timestamp_sample = sensors.timestamp;
 
 				q.copyTo(att.q);
 				_ekf.get_quat_reset(&att.delta_q_reset[0], &att.quat_reset_counter);
@@ -1359,7 +1367,7 @@ void Ekf2::run()
 		} else if (_replay_mode) {
 			// in replay mode we have to tell the replay module not to wait for an update
 			// we do this by publishing an attitude with zero timestamp
-			vehicle_attitude_s att;
+			vehicle_attitude_s att = {};
 			att.timestamp = now;
 
 			if (_att_pub == nullptr) {
@@ -1432,6 +1440,8 @@ void Ekf2::run()
 		}
 	}
 
+	px4_pollset_destroy(&poll_set);
+
 	orb_unsubscribe(sensors_sub);
 	orb_unsubscribe(gps_sub);
 	orb_unsubscribe(airspeed_sub);
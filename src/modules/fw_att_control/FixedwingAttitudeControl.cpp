@@ -45,7 +45,7 @@ FixedwingAttitudeControl::FixedwingAttitudeControl() :
 	_sub_airspeed(ORB_ID(airspeed), 0, 0, &getSubscriptions()),
 
 	/* performance counters */
-	_loop_perf(perf_alloc(PC_ELAPSED, "fwa_dt")),
+	_loop_perf(perf_alloc(PC_ELAPSED_HIST, "fwa_dt")),
 	_nonfinite_input_perf(perf_alloc(PC_COUNT, "fwa_nani")),
 	_nonfinite_output_perf(perf_alloc(PC_COUNT, "fwa_nano"))
 {
@@ -292,6 +292,7 @@ FixedwingAttitudeControl::vehicle_manual_poll()
 
 					// RATE mode we need to generate the rate setpoint from manual user inputs
 					_rates_sp.timestamp = hrt_absolute_time();
+					_rates_sp.timestamp_sample = 0;
 					_rates_sp.roll = _manual.y * _parameters.acro_max_x_rate_rad;
 					_rates_sp.pitch = -_manual.x * _parameters.acro_max_y_rate_rad;
 					_rates_sp.yaw = _manual.r * _parameters.acro_max_z_rate_rad;
@@ -730,6 +731,7 @@ void FixedwingAttitudeControl::run()
 					_rates_sp.yaw = _yaw_ctrl.get_desired_bodyrate();
 
 					_rates_sp.timestamp = hrt_absolute_time();
+					_rates_sp.timestamp_sample = _att.timestamp_sample;
 
 					if (_rate_sp_pub != nullptr) {
 						/* publish the attitude rates setpoint */
@@ -786,11 +788,12 @@ void FixedwingAttitudeControl::run()
 			// FIXME: this should use _vcontrol_mode.landing_gear_pos in the future
 			_actuators.control[7] = _manual.aux3;
 
-			/* lazily publish the setpoint only once available */
+			/* lazily publish the setpoint only once available, based on the gyro sample of the attitude if known */
+			const hrt_abstime timestamp_sample = (_att.timestamp_sample != 0) ? _att.timestamp_sample : _att.timestamp;
 			_actuators.timestamp = hrt_absolute_time();
-			_actuators.timestamp_sample = _att.timestamp;
+			_actuators.timestamp_sample = timestamp_sample;
 			_actuators_airframe.timestamp = hrt_absolute_time();
-			_actuators_airframe.timestamp_sample = _att.timestamp;
+			_actuators_airframe.timestamp_sample = timestamp_sample;
 
 			/* Only publish if any of the proper modes are enabled */
 			if (_vcontrol_mode.flag_control_rates_enabled ||
@@ -0,0 +1,395 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file latency_mon.cpp
+ *
+ * Measures the latency from the gyro sample to each stage of the control chain
+ * (sensor_combined, vehicle_attitude, vehicle_rates_setpoint, actuator_controls_0,
+ * actuator_outputs) using the timestamp_sample carried through the chain.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_module.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+
+#include <drivers/drv_hrt.h>
+#include <systemlib/perf_counter.h>
+
+#include <uORB/uORB.h>
+#include <uORB/topics/actuator_controls.h>
+#include <uORB/topics/actuator_outputs.h>
+#include <uORB/topics/control_latency.h>
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/vehicle_rates_setpoint.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" __EXPORT int latency_mon_main(int argc, char *argv[]);
+
+// publish the statistics at 1 Hz
+static constexpr unsigned LATENCY_MON_PUBLISH_INTERVAL_US = 1000000;
+
+class LatencyMon : public ModuleBase<LatencyMon>
+{
+public:
+	LatencyMon();
+	virtual ~LatencyMon();
+
+	/** @see ModuleBase */
+	static int task_spawn(int argc, char *argv[]);
+
+	/** @see ModuleBase */
+	static LatencyMon *instantiate(int argc, char *argv[]);
+
+	/** @see ModuleBase */
+	static int custom_command(int argc, char *argv[]);
+
+	/** @see ModuleBase */
+	static int print_usage(const char *reason = nullptr);
+
+	/** @see ModuleBase::run() */
+	void run() override;
+
+	/** @see ModuleBase::print_status() */
+	int print_status() override;
+
+private:
+	static constexpr int NUM_STAGES = control_latency_s::NUM_STAGES;
+
+	/**
+	 * Copy the update of a stage and record its latency if it is based on a new gyro sample.
+	 * @param now time the update was received
+	 */
+	void update_stage(int stage, hrt_abstime now);
+
+	/** Fill in the statistics from the counters. */
+	void get_latency(control_latency_s &latency);
+
+	void reset();
+
+	static const char *const _stage_names[NUM_STAGES];
+	static const orb_id_t _stage_topics[NUM_STAGES];
+
+	int _subs[NUM_STAGES] {};
+	hrt_abstime _last_sample[NUM_STAGES] {};
+
+	/** histogram counters for the percentiles, also shown by perf */
+	perf_counter_t _perf[NUM_STAGES] {};
+	uint64_t _total_us[NUM_STAGES] {};
+	uint32_t _max_us[NUM_STAGES] {};
+
+	control_latency_s _latency{};
+	orb_advert_t _latency_pub{nullptr};
+
+	volatile bool _reset_requested{false};
+};
+
+const char *const LatencyMon::_stage_names[NUM_STAGES] = {
+	"latency: sensor_combined",
+	"latency: vehicle_attitude",
+	"latency: vehicle_rates_setpoint",
+	"latency: actuator_controls_0",
+	"latency: actuator_outputs",
+};
+
+const orb_id_t LatencyMon::_stage_topics[NUM_STAGES] = {
+	ORB_ID(sensor_combined),
+	ORB_ID(vehicle_attitude),
+	ORB_ID(vehicle_rates_setpoint),
+	ORB_ID(actuator_controls_0),
+	ORB_ID(actuator_outputs),
+};
+
+LatencyMon::LatencyMon()
+{
+	for (int i = 0; i < NUM_STAGES; i++) {
+		_perf[i] = perf_alloc(PC_ELAPSED_HIST, _stage_names[i]);
+	}
+}
+
+LatencyMon::~LatencyMon()
+{
+	for (int i = 0; i < NUM_STAGES; i++) {
+		perf_free(_perf[i]);
+	}
+}
+
+void LatencyMon::update_stage(int stage, hrt_abstime now)
+{
+	hrt_abstime sample = 0;
+	hrt_abstime published = 0;
+
+	switch (stage) {
+	case control_latency_s::STAGE_SENSOR_COMBINED: {
+			// the sensor_combined timestamp is the gyro sample, it carries no publication time
+			sensor_combined_s sensors;
+			orb_copy(ORB_ID(sensor_combined), _subs[stage], &sensors);
+			sample = sensors.timestamp;
+			published = now;
+		}
+		break;
+
+	case control_latency_s::STAGE_ATTITUDE: {
+			vehicle_attitude_s att;
+			orb_copy(ORB_ID(vehicle_attitude), _subs[stage], &att);
+			sample = att.timestamp_sample;
+			published = att.timestamp;
+		}
+		break;
+
+	case control_latency_s::STAGE_RATES_SETPOINT: {
+			vehicle_rates_setpoint_s rates_sp;
+			orb_copy(ORB_ID(vehicle_rates_setpoint), _subs[stage], &rates_sp);
+			sample = rates_sp.timestamp_sample;
+			published = rates_sp.timestamp;
+		}
+		break;
+
+	case control_latency_s::STAGE_ACTUATOR_CONTROLS: {
+			actuator_controls_s controls;
+			orb_copy(ORB_ID(actuator_controls_0), _subs[stage], &controls);
+			sample = controls.timestamp_sample;
+			published = controls.timestamp;
+		}
+		break;
+
+	case control_latency_s::STAGE_ACTUATOR_OUTPUTS: {
+			actuator_outputs_s outputs;
+			orb_copy(ORB_ID(actuator_outputs), _subs[stage], &outputs);
+			sample = outputs.timestamp_sample;
+			published = outputs.timestamp;
+		}
+		break;
+	}
+
+	// outputs are republished without new controls, only count the first update per sample
+	if (sample == 0 || sample == _last_sample[stage] || published < sample) {
+		return;
+	}
+
+	_last_sample[stage] = sample;
+
+	const uint32_t latency = (published - sample < UINT32_MAX) ? (uint32_t)(published - sample) : UINT32_MAX;
+
+	perf_set_elapsed(_perf[stage], latency);
+	_total_us[stage] += latency;
+
+	if (latency > _max_us[stage]) {
+		_max_us[stage] = latency;
+	}
+}
+
+void LatencyMon::get_latency(control_latency_s &latency)
+{
+	latency.timestamp = hrt_absolute_time();
+
+	for (int i = 0; i < NUM_STAGES; i++) {
+		const uint64_t count = perf_event_count(_perf[i]);
+
+		latency.count[i] = (uint32_t)count;
+		latency.mean_us[i] = (count > 0) ? (float)_total_us[i] / count : 0.0f;
+		latency.p50_us[i] = perf_percentile(_perf[i], 0.5f);
+		latency.p99_us[i] = perf_percentile(_perf[i], 0.99f);
+		latency.max_us[i] = _max_us[i];
+	}
+}
+
+void LatencyMon::reset()
+{
+	for (int i = 0; i < NUM_STAGES; i++) {
+		perf_reset(_perf[i]);
+		_total_us[i] = 0;
+		_max_us[i] = 0;
+	}
+}
+
+void LatencyMon::run()
+{
+	px4_pollfd_struct_t fds[NUM_STAGES] {};
+
+	for (int i = 0; i < NUM_STAGES; i++) {
+		_subs[i] = orb_subscribe(_stage_topics[i]);
+		fds[i].fd = _subs[i];
+		fds[i].events = POLLIN;
+	}
+
+	hrt_abstime last_publish = hrt_absolute_time();
+
+	while (!should_exit()) {
+
+		int pret = px4_poll(fds, NUM_STAGES, 100);
+
+		// take the reception time before copying anything
+		const hrt_abstime now = hrt_absolute_time();
+
+		if (pret < 0) {
+			PX4_ERR("poll error %d, %d", pret, errno);
+			usleep(50000);
+			continue;
+		}
+
+		if (_reset_requested) {
+			reset();
+			_reset_requested = false;
+		}
+
+		for (int i = 0; i < NUM_STAGES; i++) {
+			if (fds[i].revents & POLLIN) {
+				update_stage(i, now);
+			}
+		}
+
+		if (now - last_publish >= LATENCY_MON_PUBLISH_INTERVAL_US) {
+			last_publish = now;
+			get_latency(_latency);
+
+			if (_latency_pub == nullptr) {
+				_latency_pub = orb_advertise(ORB_ID(control_latency), &_latency);
+
+			} else {
+				orb_publish(ORB_ID(control_latency), _latency_pub, &_latency);
+			}
+		}
+	}
+
+	for (int i = 0; i < NUM_STAGES; i++) {
+		orb_unsubscribe(_subs[i]);
+	}
+}
+
+int LatencyMon::print_status()
+{
+	PX4_INFO("running");
+
+	control_latency_s latency{};
+	get_latency(latency);
+
+	printf("%-24s %8s %8s %8s %8s %8s %8s\n", "stage", "count", "mean", "p50", "p99", "p99.9", "max");
+
+	for (int i = 0; i < NUM_STAGES; i++) {
+		printf("%-24s %8u %8.0f %8u %8u %8u %8u\n", _stage_names[i] + strlen("latency: "), latency.count[i],
+		       (double)latency.mean_us[i], latency.p50_us[i], latency.p99_us[i],
+		       perf_percentile(_perf[i], 0.999f), latency.max_us[i]);
+	}
+
+	return 0;
+}
+
+int LatencyMon::custom_command(int argc, char *argv[])
+{
+	if (!is_running()) {
+		print_usage("not running");
+		return 1;
+	}
+
+	if (!strcmp(argv[0], "reset")) {
+		get_instance()->_reset_requested = true;
+		return 0;
+	}
+
+	return print_usage("unknown command");
+}
+
+int LatencyMon::task_spawn(int argc, char *argv[])
+{
+	// same priority as the estimator, so the reception time of sensor_combined is representative
+	_task_id = px4_task_spawn_cmd("latency_mon",
+				      SCHED_DEFAULT,
+				      SCHED_PRIORITY_ESTIMATOR,
+				      1200,
+				      (px4_main_t)&run_trampoline,
+				      (char *const *)argv);
+
+	if (_task_id < 0) {
+		_task_id = -1;
+		return -errno;
+	}
+
+	return 0;
+}
+
+LatencyMon *LatencyMon::instantiate(int argc, char *argv[])
+{
+	LatencyMon *instance = new LatencyMon();
+
+	if (instance == nullptr) {
+		PX4_ERR("alloc failed");
+	}
+
+	return instance;
+}
+
+int LatencyMon::print_usage(const char *reason)
+{
+	if (reason) {
+		PX4_WARN("%s\n", reason);
+	}
+
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Measures the end-to-end latency from the gyro sample to each stage of the control chain and publishes the
+distribution as the `control_latency` topic at 1 Hz.
+
+### Implementation
+Every stage carries the timestamp of the gyro sample it is based on in `timestamp_sample`, and its
+publication time in `timestamp`. The difference is recorded in a histogram per stage, once per gyro sample.
+`sensor_combined` is timestamped with the gyro sample itself, so for this stage the reception time by this
+module is used instead.
+
+The histograms are also shown by `perf` and `perf latency`. Percentiles are upper bounds within 25%.
+
+### Examples
+$ latency_mon start
+$ latency_mon status
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("latency_mon", "system");
+	PRINT_MODULE_USAGE_COMMAND("start");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset the statistics");
+	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
+
+	return 0;
+}
+
+int latency_mon_main(int argc, char *argv[])
+{
+	return LatencyMon::main(argc, argv);
+}
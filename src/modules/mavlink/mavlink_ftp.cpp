@@ -55,7 +55,15 @@ MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink),
 	_work_buffer1{nullptr},
 	_work_buffer2{nullptr},
-	_last_work_buffer_access{0}
+	_last_work_buffer_access{0},
+	_read_ahead_buffer{nullptr},
+	_read_ahead_offset{0},
+	_read_ahead_len{0},
+	_last_stream_send{0},
+	_stream_perf(perf_alloc(PC_ELAPSED, "mavlink_ftp_stream")),
+	_stream_bytes_perf(perf_alloc(PC_COUNT, "mavlink_ftp_stream_bytes")),
+	_read_perf(perf_alloc(PC_COUNT, "mavlink_ftp_read")),
+	_read_ahead_miss_perf(perf_alloc(PC_COUNT, "mavlink_ftp_ra_miss"))
 {
 	// initialize session
 	_session_info.fd = -1;
@@ -71,6 +79,14 @@ MavlinkFTP::~MavlinkFTP()
 		delete[] _work_buffer2;
 	}
 
+	if (_read_ahead_buffer) {
+		delete[] _read_ahead_buffer;
+	}
+
+	perf_free(_stream_perf);
+	perf_free(_stream_bytes_perf);
+	perf_free(_read_perf);
+	perf_free(_read_ahead_miss_perf);
 }
 
 unsigned
@@ -309,7 +325,58 @@ bool MavlinkFTP::_ensure_buffers_exist()
 		_work_buffer2 = new char[_work_buffer2_len];
 	}
 
-	return _work_buffer1 && _work_buffer2;
+	if (!_read_ahead_buffer) {
+		_read_ahead_buffer = new uint8_t[_read_ahead_buffer_len];
+		_invalidate_read_ahead();
+	}
+
+	return _work_buffer1 && _work_buffer2 && _read_ahead_buffer;
+}
+
+void
+MavlinkFTP::_invalidate_read_ahead()
+{
+	_read_ahead_offset = 0;
+	_read_ahead_len = 0;
+}
+
+int
+MavlinkFTP::_read_session_data(uint32_t offset, uint8_t *dst, unsigned len)
+{
+	// serve the request from the read-ahead buffer if it is (at least partially) in there
+	if (offset < _read_ahead_offset || offset >= _read_ahead_offset + _read_ahead_len) {
+		perf_count(_read_ahead_miss_perf);
+		_invalidate_read_ahead();
+
+		if (_session_info.file_pos != offset) {
+			if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+				return -1;
+			}
+
+			_session_info.file_pos = offset;
+		}
+
+		int bytes_read = ::read(_session_info.fd, _read_ahead_buffer, _read_ahead_buffer_len);
+
+		if (bytes_read < 0) {
+			// position is undefined now, force a seek on the next read
+			_session_info.file_pos = UINT32_MAX;
+			return -1;
+		}
+
+		_session_info.file_pos += bytes_read;
+		_read_ahead_offset = offset;
+		_read_ahead_len = bytes_read;
+	}
+
+	unsigned available = _read_ahead_offset + _read_ahead_len - offset;
+
+	if (len > available) {
+		len = available;
+	}
+
+	memcpy(dst, &_read_ahead_buffer[offset - _read_ahead_offset], len);
+	return len;
 }
 
 /// @brief Sends the specified FTP response message out through mavlink
@@ -544,7 +611,10 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
+	_session_info.file_pos = 0;
 	_session_info.stream_download = false;
+	_session_info.stream_start_time = 0;
+	_invalidate_read_ahead();
 
 	payload->session = 0;
 	payload->size = sizeof(uint32_t);
@@ -571,12 +641,11 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 		return kErrEOF;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		PX4_ERR("seek fail");
-		return kErrFailErrno;
-	}
+	perf_count(_read_perf);
 
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	// during a burst download the GCS uses Read requests to fill in missed sequence numbers. These are
+	// typically close behind the stream offset and can be served from the read-ahead buffer.
+	int bytes_read = _read_session_data(payload->offset, &payload->data[0], kMaxDataLength);
 
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
@@ -607,6 +676,11 @@ MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 	_session_info.stream_seq_number = payload->seq_number + 1;
 	_session_info.stream_target_system_id = target_system_id;
 
+	if (payload->offset == 0 || _session_info.stream_start_time == 0) {
+		_session_info.stream_start_time = hrt_absolute_time();
+		_session_info.stream_start_offset = payload->offset;
+	}
+
 	return kErrNone;
 }
 
@@ -618,9 +692,12 @@ MavlinkFTP::_workWrite(PayloadHeader *payload)
 		return kErrInvalidSession;
 	}
 
+	_invalidate_read_ahead();
+
 	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
 		// Unable to see to the specified location
 		PX4_ERR("seek fail");
+		_session_info.file_pos = UINT32_MAX;
 		return kErrFailErrno;
 	}
 
@@ -629,9 +706,12 @@ MavlinkFTP::_workWrite(PayloadHeader *payload)
 	if (bytes_written < 0) {
 		// Negative return indicates error other than eof
 		PX4_ERR("write fail %d", bytes_written);
+		_session_info.file_pos = UINT32_MAX;
 		return kErrFailErrno;
 	}
 
+	_session_info.file_pos = payload->offset + bytes_written;
+
 	payload->size = sizeof(uint32_t);
 	std::memcpy(payload->data, &bytes_written, payload->size);
 
@@ -761,6 +841,8 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 	::close(_session_info.fd);
 	_session_info.fd = -1;
 	_session_info.stream_download = false;
+	_session_info.stream_start_time = 0;
+	_invalidate_read_ahead();
 
 	payload->size = 0;
 
@@ -775,8 +857,11 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 		::close(_session_info.fd);
 		_session_info.fd = -1;
 		_session_info.stream_download = false;
+		_session_info.stream_start_time = 0;
 	}
 
+	_invalidate_read_ahead();
+
 	payload->size = 0;
 
 	return kErrNone;
@@ -963,11 +1048,54 @@ MavlinkFTP::_copy_file(const char *src_path, const char *dst_path, size_t length
 	return (length > 0) ? -1 : 0;
 }
 
+unsigned
+MavlinkFTP::_get_burst_window()
+{
+#ifndef MAVLINK_FTP_UNIT_TEST
+
+	if (_mavlink->get_protocol() != SERIAL) {
+		return _burst_window_network;
+	}
+
+#endif
+	return _burst_window_serial;
+}
+
+unsigned
+MavlinkFTP::_get_stream_budget(const hrt_abstime t)
+{
+	unsigned budget = _mavlink->get_free_tx_buf();
+
+	if (_mavlink->get_protocol() != SERIAL) {
+		// Network links only report the size of a single datagram, but each message is sent in its own
+		// datagram. Pace the stream by the configured data rate instead, so that the download is not
+		// limited to a handful of packets per receive loop iteration.
+		hrt_abstime dt = 10000;
+
+		if (_last_stream_send != 0 && t > _last_stream_send) {
+			dt = t - _last_stream_send;
+		}
+
+		const uint64_t rate_budget = (uint64_t)_mavlink->get_data_rate() * dt / 1000000;
+		const unsigned max_budget = _max_stream_packets_per_send * get_size();
+
+		budget = (rate_budget > max_budget) ? max_budget : (unsigned)rate_budget;
+
+		// always allow at least one packet, so that slow links still make progress
+		if (budget < get_size() * 2) {
+			budget = get_size() * 2;
+		}
+	}
+
+	_last_stream_send = t;
+	return budget;
+}
+
 void MavlinkFTP::send(const hrt_abstime t)
 {
 
-	if (_work_buffer1 || _work_buffer2) {
-		// free the work buffers if they are not used for a while
+	// free the work buffers if they are not used for a while (but never during a download)
+	if (!_session_info.stream_download && (_work_buffer1 || _work_buffer2 || _read_ahead_buffer)) {
 		if (hrt_elapsed_time(&_last_work_buffer_access) > 2000000) {
 			if (_work_buffer1) {
 				delete[] _work_buffer1;
@@ -978,6 +1106,11 @@ void MavlinkFTP::send(const hrt_abstime t)
 				delete[] _work_buffer2;
 				_work_buffer2 = nullptr;
 			}
+
+			if (_read_ahead_buffer) {
+				delete[] _read_ahead_buffer;
+				_read_ahead_buffer = nullptr;
+			}
 		}
 	}
 
@@ -986,9 +1119,11 @@ void MavlinkFTP::send(const hrt_abstime t)
 		return;
 	}
 
+	_last_work_buffer_access = hrt_absolute_time();
+
 #ifndef MAVLINK_FTP_UNIT_TEST
 	// Skip send if not enough room
-	unsigned max_bytes_to_send = _mavlink->get_free_tx_buf();
+	unsigned max_bytes_to_send = _get_stream_budget(t);
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("MavlinkFTP::send max_bytes_to_send(%d) get_free_tx_buf(%d)", max_bytes_to_send, _mavlink->get_free_tx_buf());
 #endif
@@ -999,6 +1134,8 @@ void MavlinkFTP::send(const hrt_abstime t)
 
 #endif
 
+	perf_begin(_stream_perf);
+
 	// Send stream packets until buffer is full
 
 	bool more_data;
@@ -1028,19 +1165,18 @@ void MavlinkFTP::send(const hrt_abstime t)
 #ifdef MAVLINK_FTP_DEBUG
 			PX4_INFO("stream download: sending Nak EOF");
 #endif
-		}
 
-		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
-#ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: seek fail");
-#endif
+			if (_session_info.stream_start_time != 0) {
+				const hrt_abstime elapsed = hrt_elapsed_time(&_session_info.stream_start_time);
+				const uint32_t bytes = _session_info.file_size - _session_info.stream_start_offset;
+				PX4_DEBUG("stream download: %u bytes in %.3f s (%.1f kB/s)", bytes, (double)(elapsed / 1e6),
+					  elapsed > 0 ? (double)(bytes * 1000.f / elapsed) : 0.0);
+				_session_info.stream_start_time = 0;
 			}
 		}
 
 		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+			int bytes_read = _read_session_data(payload->offset, &payload->data[0], kMaxDataLength);
 
 			if (bytes_read < 0) {
 				// Negative return indicates error other than eof
@@ -1053,6 +1189,7 @@ void MavlinkFTP::send(const hrt_abstime t)
 				payload->size = bytes_read;
 				_session_info.stream_offset += bytes_read;
 				_session_info.stream_chunk_transmitted += bytes_read;
+				perf_set_count(_stream_bytes_perf, perf_event_count(_stream_bytes_perf) + bytes_read);
 			}
 		}
 
@@ -1076,8 +1213,9 @@ void MavlinkFTP::send(const hrt_abstime t)
 			if (max_bytes_to_send < (get_size() * 2)) {
 				more_data = false;
 
-				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
+				/* perform transfers in chunks of the burst window, the GCS then re-requests the next burst
+				 * and fills in missed packets with Read requests */
+				if (_session_info.stream_chunk_transmitted > _get_burst_window()) {
 					payload->burst_complete = true;
 					_session_info.stream_download = false;
 					_session_info.stream_chunk_transmitted = 0;
@@ -1097,4 +1235,6 @@ void MavlinkFTP::send(const hrt_abstime t)
 		ftp_msg.target_system = _session_info.stream_target_system_id;
 		_reply(&ftp_msg);
 	} while (more_data);
+
+	perf_end(_stream_perf);
 }
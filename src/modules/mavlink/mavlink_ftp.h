@@ -41,6 +41,7 @@
 
 #include <px4_defines.h>
 #include <systemlib/err.h>
+#include <systemlib/perf_counter.h>
 #include <drivers/drv_hrt.h>
 
 #include "mavlink_bridge_header.h"
@@ -146,6 +147,29 @@ private:
 	ErrorCode	_workRename(PayloadHeader *payload);
 	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
 
+	/**
+	 * Read file data of the current session through the read-ahead buffer.
+	 * Sequential (burst) and retransmission reads within the buffered window are
+	 * served without touching the file, otherwise the buffer is refilled with a single read.
+	 * @param offset file offset to read from
+	 * @param dst destination buffer
+	 * @param len maximum number of bytes to read
+	 * @return number of bytes read (0 on EOF), or -1 on error (errno is set)
+	 */
+	int		_read_session_data(uint32_t offset, uint8_t *dst, unsigned len);
+
+	/// invalidate the read-ahead buffer, e.g. after the session changed
+	void		_invalidate_read_ahead();
+
+	/**
+	 * Get the number of bytes that can be streamed in the current send() call.
+	 * @param t current time
+	 */
+	unsigned	_get_stream_budget(const hrt_abstime t);
+
+	/// number of bytes to stream before a burst is flagged as complete and the GCS has to re-request
+	unsigned	_get_burst_window();
+
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
 	uint8_t _getServerChannel(void);
@@ -166,14 +190,41 @@ private:
 	struct SessionInfo {
 		int		fd;
 		uint32_t	file_size;
+		uint32_t	file_pos;		///< current position of fd, to avoid unnecessary seeks
 		bool		stream_download;
 		uint32_t	stream_offset;
 		uint16_t	stream_seq_number;
 		uint8_t		stream_target_system_id;
 		unsigned	stream_chunk_transmitted;
+		hrt_abstime	stream_start_time;	///< start of the current download, for throughput statistics
+		uint32_t	stream_start_offset;
 	};
 	struct SessionInfo _session_info;	///< Session info, fd=-1 for no active session
 
+	/// burst window for serial links: determined empirical
+	static constexpr unsigned _burst_window_serial = 35000;
+	/// burst window for network links: the GCS re-requests missing sequence numbers selectively,
+	/// so we can stream much larger windows before waiting for the round trip
+	static constexpr unsigned _burst_window_network = 512 * 1024;
+	/// upper bound of packets streamed per send() call on network links
+	static constexpr unsigned _max_stream_packets_per_send = 64;
+
+	/* read-ahead buffer: allocated together with the work buffers */
+	uint8_t *_read_ahead_buffer;
+#ifdef __PX4_NUTTX
+	static constexpr int _read_ahead_buffer_len = 1024;
+#else
+	static constexpr int _read_ahead_buffer_len = 16 * 1024;
+#endif
+	uint32_t _read_ahead_offset;	///< file offset of the first byte in _read_ahead_buffer
+	int _read_ahead_len;		///< number of valid bytes in _read_ahead_buffer
+	hrt_abstime _last_stream_send;	///< time of the last stream send() call
+
+	perf_counter_t	_stream_perf;		///< time spent streaming per send() call
+	perf_counter_t	_stream_bytes_perf;	///< number of bytes streamed
+	perf_counter_t	_read_perf;		///< Read requests (retransmissions of missed burst packets)
+	perf_counter_t	_read_ahead_miss_perf;	///< read-ahead buffer refills
+
 	ReceiveMessageFunc_t	_utRcvMsgFunc;	///< Unit test override for mavlink message sending
 	void			*_worker_data;	///< Additional parameter to _utRcvMsgFunc;
 
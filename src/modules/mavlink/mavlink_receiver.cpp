@@ -2178,10 +2178,11 @@ MavlinkReceiver::handle_message_hil_state_quaternion(mavlink_message_t *msg)
 	}
 
 	/* attitude */
-	struct vehicle_attitude_s hil_attitude;
+	struct vehicle_attitude_s hil_attitude = {};
 	{
-		hil_attitude = {};
 		hil_attitude.timestamp = timestamp;
+		// the HIL state is the sample itself
+		hil_attitude.timestamp_sample = timestamp;
 
 		matrix::Quatf q(hil_state.attitude_quaternion);
 		q.copyTo(hil_attitude.q);
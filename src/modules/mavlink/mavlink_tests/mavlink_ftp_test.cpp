@@ -501,6 +501,90 @@ bool MavlinkFtpTest::_read_test()
 	return true;
 }
 
+/// @brief Tests Read commands with decreasing offsets, like the GCS sends them to fill in missed burst packets.
+bool MavlinkFtpTest::_read_out_of_order_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	// Use the test case which takes two packets
+	const DownloadTestCase *test = &_rgDownloadTestCases[2];
+	struct stat st;
+
+	ut_compare("stat failed", stat(test->file, &st), 0);
+	uint8_t *bytes = new uint8_t[st.st_size];
+	ut_assert("new failed", bytes != nullptr);
+	int fd = ::open(test->file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, bytes, st.st_size);
+	ut_compare("read failed", bytes_read, st.st_size);
+	::close(fd);
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,		// FTP payload header
+					 strlen(test->file) + 1,	// size in bytes of data
+					 (uint8_t *)test->file,	// Data to start into FTP message payload
+					 &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		delete[] bytes;
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	uint32_t full_packet_bytes = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(MavlinkFTP::PayloadHeader);
+	const uint32_t offsets[] = { full_packet_bytes, 0, full_packet_bytes, 1 };
+
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+		payload.opcode = MavlinkFTP::kCmdReadFile;
+		payload.session = reply->session;
+		payload.offset = offsets[i];
+
+		success = _send_receive_msg(&payload,	// FTP payload header
+					    0,		// size in bytes of data
+					    nullptr,	// Data to start into FTP message payload
+					    &reply);	// Payload inside FTP message response
+
+		if (!success) {
+			delete[] bytes;
+			return false;
+		}
+
+		uint32_t expected_bytes = (uint32_t)st.st_size - offsets[i];
+
+		if (expected_bytes > full_packet_bytes) {
+			expected_bytes = full_packet_bytes;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Offset incorrect", reply->offset, offsets[i]);
+		ut_compare("Payload size incorrect", reply->size, expected_bytes);
+		ut_compare("File contents differ", memcmp(reply->data, &bytes[offsets[i]], expected_bytes), 0);
+	}
+
+	delete[] bytes;
+
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = reply->session;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an open session.
 bool MavlinkFtpTest::_burst_test()
 {
@@ -953,6 +1037,7 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_open_terminate_test);
 	ut_run_test(_terminate_badsession_test);
 	ut_run_test(_read_test);
+	ut_run_test(_read_out_of_order_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
 	ut_run_test(_removedirectory_test);
@@ -85,6 +85,7 @@ private:
 	bool _open_terminate_test(void);
 	bool _terminate_badsession_test(void);
 	bool _read_test(void);
+	bool _read_out_of_order_test(void);
 	bool _read_badsession_test(void);
 	bool _burst_test(void);
 	bool _removedirectory_test(void);
@@ -375,7 +375,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_sensor_bias{},
 	_saturation_status{},
 	/* performance counters */
-	_loop_perf(perf_alloc(PC_ELAPSED, "mc_att_control")),
+	_loop_perf(perf_alloc(PC_ELAPSED_HIST, "mc_att_control")),
 	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
 
 	_lp_filters_d{
@@ -1219,6 +1219,7 @@ MulticopterAttitudeControl::task_main()
 				_v_rates_sp.yaw = _rates_sp(2);
 				_v_rates_sp.thrust = _thrust_sp;
 				_v_rates_sp.timestamp = hrt_absolute_time();
+				_v_rates_sp.timestamp_sample = _v_att.timestamp_sample;
 
 				if (_v_rates_sp_pub != nullptr) {
 					orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
@@ -1245,6 +1246,7 @@ MulticopterAttitudeControl::task_main()
 					_v_rates_sp.yaw = _rates_sp(2);
 					_v_rates_sp.thrust = _thrust_sp;
 					_v_rates_sp.timestamp = hrt_absolute_time();
+					_v_rates_sp.timestamp_sample = 0;
 
 					if (_v_rates_sp_pub != nullptr) {
 						orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
@@ -52,6 +52,7 @@
 #include "navigator.h"
 
 #define GEOFENCE_RANGE_WARNING_LIMIT 5000000
+#define GEOFENCE_UPDATE_INTERVAL 1000000 ///< how often the dataman fence data is checked for updates [us]
 
 Geofence::Geofence(Navigator *navigator) :
 	SuperBlock(navigator, "GF"),
@@ -69,9 +70,6 @@ Geofence::Geofence(Navigator *navigator) :
 
 Geofence::~Geofence()
 {
-	if (_polygons) {
-		delete[](_polygons);
-	}
 }
 
 void Geofence::updateFence()
@@ -102,85 +100,61 @@ void Geofence::_updateFence()
 		_update_counter = stats.update_counter;
 	}
 
-	// iterate over all polygons and store their starting vertices
-	_num_polygons = 0;
-	int current_seq = 1;
+	if (num_fence_items <= 0) {
+		_index.clear();
+		return;
+	}
+
+	// read all items once, the index keeps what it needs for the checks
+	mission_fence_point_s *items = new mission_fence_point_s[num_fence_items];
+
+	if (items == nullptr) {
+		PX4_ERR("alloc failed");
+		_index.clear();
+		return;
+	}
 
-	while (current_seq <= num_fence_items) {
-		mission_fence_point_s mission_fence_point;
-		bool is_circle_area = false;
+	int num_read = 0;
 
-		if (dm_read(DM_KEY_FENCE_POINTS, current_seq, &mission_fence_point, sizeof(mission_fence_point_s)) !=
+	while (num_read < num_fence_items) {
+		if (dm_read(DM_KEY_FENCE_POINTS, num_read + 1, &items[num_read], sizeof(mission_fence_point_s)) !=
 		    sizeof(mission_fence_point_s)) {
 			PX4_ERR("dm_read failed");
 			break;
 		}
 
-		switch (mission_fence_point.nav_cmd) {
-		case MAV_CMD_NAV_FENCE_RETURN_POINT:
-			// TODO: do we need to store this?
-			++current_seq;
-			break;
-
-		case MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION:
-		case MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION:
-			is_circle_area = true;
-
-		/* FALLTHROUGH */
-		case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION:
-		case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION:
-			if (!is_circle_area && mission_fence_point.vertex_count == 0) {
-				++current_seq; // avoid endless loop
-				PX4_ERR("Polygon with 0 vertices. Skipping");
-
-			} else {
-				if (_polygons) {
-					// resize: this is somewhat inefficient, but we do not expect there to be many polygons
-					PolygonInfo *new_polygons = new PolygonInfo[_num_polygons + 1];
-
-					if (new_polygons) {
-						memcpy(new_polygons, _polygons, sizeof(PolygonInfo) * _num_polygons);
-					}
-
-					delete[](_polygons);
-					_polygons = new_polygons;
-
-				} else {
-					_polygons = new PolygonInfo[1];
-				}
-
-				if (!_polygons) {
-					_num_polygons = 0;
-					PX4_ERR("alloc failed");
-					return;
-				}
+		++num_read;
+	}
 
-				PolygonInfo &polygon = _polygons[_num_polygons];
-				polygon.dataman_index = current_seq;
-				polygon.fence_type = mission_fence_point.nav_cmd;
+	_index.build(items, num_read);
 
-				if (is_circle_area) {
-					polygon.circle_radius = mission_fence_point.circle_radius;
-					current_seq += 1;
+	delete[] items;
+}
 
-				} else {
-					polygon.vertex_count = mission_fence_point.vertex_count;
-					current_seq += mission_fence_point.vertex_count;
-				}
+void Geofence::checkForUpdate(hrt_abstime min_interval)
+{
+	if (min_interval > 0 && hrt_elapsed_time(&_last_update_check) < min_interval) {
+		return;
+	}
 
-				++_num_polygons;
-			}
+	_last_update_check = hrt_absolute_time();
 
-			break;
+	// a single item read is consistent without the lock, the lock is only needed to read all items
+	mission_stats_entry_s stats;
+	int ret = dm_read(DM_KEY_FENCE_POINTS, 0, &stats, sizeof(mission_stats_entry_s));
 
-		default:
-			PX4_ERR("unhandled Fence command: %i", (int)mission_fence_point.nav_cmd);
-			++current_seq;
-			break;
-		}
+	if (ret != sizeof(mission_stats_entry_s) || _update_counter == stats.update_counter) {
+		return;
+	}
 
+	// if the lock fails, the data is (most likely) being updated via a mavlink geofence transfer:
+	// keep checking against the previous fence and try again next time
+	if (dm_trylock(DM_KEY_FENCE_POINTS) != 0) {
+		return;
 	}
 
+	_updateFence();
+	dm_unlock(DM_KEY_FENCE_POINTS);
 }
 
 bool Geofence::checkAll(const struct vehicle_global_position_s &global_position)
@@ -198,6 +172,8 @@ bool Geofence::check(const struct vehicle_global_position_s &global_position,
 		     const struct vehicle_gps_position_s &gps_position, float baro_altitude_amsl,
 		     const struct home_position_s home_pos, bool home_position_set)
 {
+	checkForUpdate(GEOFENCE_UPDATE_INTERVAL);
+
 	if (getAltitudeMode() == Geofence::GF_ALT_MODE_WGS84) {
 		if (getSource() == Geofence::GF_SOURCE_GLOBALPOS) {
 			return checkAll(global_position);
@@ -220,6 +196,9 @@ bool Geofence::check(const struct vehicle_global_position_s &global_position,
 
 bool Geofence::check(const struct mission_item_s &mission_item)
 {
+	// mission feasibility checks run right after an upload, make sure they see the latest fence
+	checkForUpdate(0);
+
 	return checkAll(mission_item.lat, mission_item.lon, mission_item.altitude);
 }
 
@@ -285,22 +264,7 @@ bool Geofence::checkAll(double lat, double lon, float altitude)
 
 bool Geofence::checkPolygons(double lat, double lon, float altitude)
 {
-	// the following uses dm_read, so first we try to lock all items. If that fails, it (most likely) means
-	// the data is currently being updated (via a mavlink geofence transfer), and we do not check for a violation now
-	if (dm_trylock(DM_KEY_FENCE_POINTS) != 0) {
-		return true;
-	}
-
-	// we got the lock, now check if the fence data got updated
-	mission_stats_entry_s stats;
-	int ret = dm_read(DM_KEY_FENCE_POINTS, 0, &stats, sizeof(mission_stats_entry_s));
-
-	if (ret == sizeof(mission_stats_entry_s) && _update_counter != stats.update_counter) {
-		_updateFence();
-	}
-
 	if (isEmpty()) {
-		dm_unlock(DM_KEY_FENCE_POINTS);
 		/* Empty fence -> accept all points */
 		return true;
 	}
@@ -308,127 +272,12 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 	/* Vertical check */
 	if (_altitude_max > _altitude_min) { // only enable vertical check if configured properly
 		if (altitude > _altitude_max || altitude < _altitude_min) {
-			dm_unlock(DM_KEY_FENCE_POINTS);
 			return false;
 		}
 	}
 
-
-	/* Horizontal check: iterate all polygons & circles */
-	bool outside_exclusion = true;
-	bool inside_inclusion = false;
-	bool had_inclusion_areas = false;
-
-	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
-		if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
-
-			if (inside) {
-				inside_inclusion = true;
-			}
-
-			had_inclusion_areas = true;
-
-		} else if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
-
-			if (inside) {
-				outside_exclusion = false;
-			}
-
-		} else { // it's a polygon
-			bool inside = insidePolygon(_polygons[polygon_idx], lat, lon, altitude);
-
-			if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION) {
-				if (inside) {
-					inside_inclusion = true;
-				}
-
-				had_inclusion_areas = true;
-
-			} else { // exclusion
-				if (inside) {
-					outside_exclusion = false;
-				}
-			}
-		}
-	}
-
-	dm_unlock(DM_KEY_FENCE_POINTS);
-
-	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
-}
-
-bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude)
-{
-
-	/* Adaptation of algorithm originally presented as
-	 * PNPOLY - Point Inclusion in Polygon Test
-	 * W. Randolph Franklin (WRF)
-	 * Only supports non-complex polygons (not self intersecting)
-	 */
-
-	mission_fence_point_s temp_vertex_i;
-	mission_fence_point_s temp_vertex_j;
-	bool c = false;
-
-	for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, &temp_vertex_i,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
-
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + j, &temp_vertex_j,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
-
-		if (temp_vertex_i.frame != MAV_FRAME_GLOBAL && temp_vertex_i.frame != MAV_FRAME_GLOBAL_INT
-		    && temp_vertex_i.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT
-		    && temp_vertex_i.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-			// TODO: handle different frames
-			PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
-			break;
-		}
-
-		if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-		    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-		     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
-			c = !c;
-		}
-	}
-
-	return c;
-}
-
-bool Geofence::insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude)
-{
-
-	mission_fence_point_s circle_point;
-
-	if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index, &circle_point,
-		    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-		PX4_ERR("dm_read failed");
-		return false;
-	}
-
-	if (circle_point.frame != MAV_FRAME_GLOBAL && circle_point.frame != MAV_FRAME_GLOBAL_INT
-	    && circle_point.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT
-	    && circle_point.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-		// TODO: handle different frames
-		PX4_ERR("Frame type %i not supported", (int)circle_point.frame);
-		return false;
-	}
-
-	if (!map_projection_initialized(&_projection_reference)) {
-		map_projection_init(&_projection_reference, lat, lon);
-	}
-
-	float x1, y1, x2, y2;
-	map_projection_project(&_projection_reference, lat, lon, &x1, &y1);
-	map_projection_project(&_projection_reference, circle_point.lat, circle_point.lon, &x2, &y2);
-	float dx = x1 - x2, dy = y1 - y2;
-	return dx * dx + dy * dy < circle_point.circle_radius * circle_point.circle_radius;
+	/* Horizontal check: all polygons & circles */
+	return _index.inside(lat, lon);
 }
 
 bool
@@ -582,30 +431,10 @@ bool Geofence::isHomeRequired()
 
 void Geofence::printStatus()
 {
-	int num_inclusion_polygons = 0, num_exclusion_polygons = 0, total_num_vertices = 0;
-	int num_inclusion_circles = 0, num_exclusion_circles = 0;
-
-	for (int i = 0; i < _num_polygons; ++i) {
-		total_num_vertices += _polygons[i].vertex_count;
-
-		if (_polygons[i].fence_type == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION) {
-			++num_inclusion_polygons;
-		}
-
-		if (_polygons[i].fence_type == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION) {
-			++num_exclusion_polygons;
-		}
-
-		if (_polygons[i].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION) {
-			++num_inclusion_circles;
-		}
-
-		if (_polygons[i].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION) {
-			++num_exclusion_circles;
-		}
-	}
-
 	PX4_INFO("Geofence: %i inclusion, %i exclusion polygons, %i inclusion, %i exclusion circles, %i total vertices",
-		 num_inclusion_polygons, num_exclusion_polygons, num_inclusion_circles, num_exclusion_circles,
-		 total_num_vertices);
+		 _index.areaCount(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION),
+		 _index.areaCount(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION),
+		 _index.areaCount(MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION),
+		 _index.areaCount(MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION),
+		 _index.vertexCount());
 }
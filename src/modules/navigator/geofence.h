@@ -53,6 +53,8 @@
 #include <uORB/topics/vehicle_global_position.h>
 #include <uORB/topics/vehicle_gps_position.h>
 
+#include "geofence_index.h"
+
 #define GEOFENCE_FILENAME PX4_ROOTFSDIR"/fs/microsd/etc/geofence.txt"
 
 class Navigator;
@@ -124,7 +126,7 @@ public:
 	 */
 	int loadFromFile(const char *filename);
 
-	bool isEmpty() { return _num_polygons == 0; }
+	bool isEmpty() { return _index.isEmpty(); }
 
 	int getAltitudeMode() { return _param_altitude_mode.get(); }
 	int getSource() { return _param_source.get(); }
@@ -146,18 +148,8 @@ private:
 	float _altitude_min{0.0f};
 	float _altitude_max{0.0f};
 
-	struct PolygonInfo {
-		uint16_t fence_type; ///< one of MAV_CMD_NAV_FENCE_* (can also be a circular region)
-		uint16_t dataman_index;
-		union {
-			uint16_t vertex_count;
-			float circle_radius;
-		};
-	};
-	PolygonInfo *_polygons{nullptr};
-	int _num_polygons{0};
-
-	map_projection_reference_s _projection_reference = {}; ///< reference to convert (lon, lat) to local [m]
+	GeofenceIndex _index; ///< compiled copy of the fence areas in dataman, so that checks need no dataman access
+	hrt_abstime _last_update_check{0};
 
 	/* Params */
 	control::BlockParamInt _param_action;
@@ -175,6 +167,14 @@ private:
 	 */
 	void _updateFence();
 
+	/**
+	 * Recompile the fence if the data in dataman was updated.
+	 * If the data is currently locked (e.g. during a mavlink geofence transfer), the previous fence is kept.
+	 *
+	 * @param min_interval do not look at the dataman stats again before this time has passed [us]
+	 */
+	void checkForUpdate(hrt_abstime min_interval);
+
 	/**
 	 * Check if a point passes the Geofence test.
 	 * This takes all polygons and minimum & maximum altitude into account
@@ -197,19 +197,6 @@ private:
 
 	bool checkAll(const struct vehicle_global_position_s &global_position);
 	bool checkAll(const struct vehicle_global_position_s &global_position, float baro_altitude_amsl);
-
-	/**
-	 * Check if a single point is within a polygon
-	 * @return true if within polygon
-	 */
-	bool insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude);
-
-	/**
-	 * Check if a single point is within a circle
-	 * @param polygon must be a circle!
-	 * @return true if within polygon the circle
-	 */
-	bool insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude);
 };
 
 #endif /* GEOFENCE_H_ */
@@ -0,0 +1,433 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file geofence_index.cpp
+ * In-memory representation of the geofence areas.
+ */
+
+#include "geofence_index.h"
+
+#include <cfloat>
+#include <math.h>
+
+#include <mathlib/math/Limits.hpp>
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <v2.0/common/mavlink.h>
+
+GeofenceIndex::~GeofenceIndex()
+{
+	clear();
+}
+
+void GeofenceIndex::clear()
+{
+	delete[] _areas;
+	delete[] _edges;
+	delete[] _slab_offsets;
+	delete[] _slab_edges;
+
+	_areas = nullptr;
+	_edges = nullptr;
+	_slab_offsets = nullptr;
+	_slab_edges = nullptr;
+	_num_areas = 0;
+	_num_edges = 0;
+	_reference.init_done = false;
+}
+
+static bool frame_supported(uint8_t frame)
+{
+	// TODO: handle different frames
+	return frame == MAV_FRAME_GLOBAL || frame == MAV_FRAME_GLOBAL_INT
+	       || frame == MAV_FRAME_GLOBAL_RELATIVE_ALT
+	       || frame == MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+}
+
+int GeofenceIndex::countSlabEntries(Area &area, int slab_count) const
+{
+	area.slab_count = slab_count;
+	const float height = area.max_y - area.min_y;
+	area.slab_scale = height > FLT_EPSILON ? slab_count / height : 0.f;
+
+	int entries = 0;
+
+	for (int i = area.first_edge; i < area.first_edge + area.edge_count; ++i) {
+		const Edge &edge = _edges[i];
+
+		if (edge.y != edge.y_end) {
+			entries += slabIndex(area, math::max(edge.y, edge.y_end)) - slabIndex(area, math::min(edge.y, edge.y_end)) + 1;
+		}
+	}
+
+	return entries;
+}
+
+int GeofenceIndex::build(const mission_fence_point_s *items, int num_items)
+{
+	clear();
+
+	// first pass: count the areas and vertices, so that everything can be allocated at once
+	int num_areas = 0;
+	int num_edges = 0;
+	int seq = 0;
+
+	while (seq < num_items) {
+		const mission_fence_point_s &item = items[seq];
+
+		switch (item.nav_cmd) {
+		case MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION:
+		case MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION:
+			++num_areas;
+			++seq;
+			break;
+
+		case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION:
+		case MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION:
+			if (item.vertex_count == 0) {
+				PX4_ERR("Polygon with 0 vertices. Skipping");
+				++seq; // avoid endless loop
+
+			} else if (seq + item.vertex_count > num_items) {
+				PX4_ERR("Polygon with %i vertices exceeds the fence. Skipping", (int)item.vertex_count);
+				seq = num_items;
+
+			} else {
+				++num_areas;
+				num_edges += item.vertex_count;
+				seq += item.vertex_count;
+			}
+
+			break;
+
+		case MAV_CMD_NAV_FENCE_RETURN_POINT:
+			// TODO: do we need to store this?
+			++seq;
+			break;
+
+		default:
+			PX4_ERR("unhandled Fence command: %i", (int)item.nav_cmd);
+			++seq;
+			break;
+		}
+	}
+
+	if (num_areas == 0) {
+		return PX4_OK;
+	}
+
+	_areas = new Area[num_areas];
+
+	if (num_edges > 0) {
+		_edges = new Edge[num_edges];
+	}
+
+	if (_areas == nullptr || (num_edges > 0 && _edges == nullptr)) {
+		PX4_ERR("alloc failed");
+		clear();
+		return PX4_ERROR;
+	}
+
+	// the local frame is centered at the first fence item, the projection is accurate within the extent of a fence
+	map_projection_init(&_reference, items[0].lat, items[0].lon);
+
+	// second pass: project the areas and create the polygon edges
+	bool frame_error = false;
+	seq = 0;
+
+	while (seq < num_items) {
+		const mission_fence_point_s &item = items[seq];
+		const bool is_circle = item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION
+				       || item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION;
+		const bool is_polygon = item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION
+					|| item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION;
+
+		if (!(is_circle || (is_polygon && item.vertex_count > 0 && seq + item.vertex_count <= num_items))) {
+			seq = is_polygon && item.vertex_count > 0 ? num_items : seq + 1;
+			continue;
+		}
+
+		Area &area = _areas[_num_areas++];
+		area.fence_type = item.nav_cmd;
+		area.valid = true;
+		area.slab_count = 0;
+		area.first_edge = _num_edges;
+		area.edge_count = 0;
+		area.first_slab = 0;
+		area.slab_scale = 0.f;
+		area.radius = 0.f;
+
+		if (is_circle) {
+			area.valid = frame_supported(item.frame);
+			area.radius = item.circle_radius;
+			map_projection_project(&_reference, item.lat, item.lon, &area.min_x, &area.min_y);
+			area.max_x = area.min_x;
+			area.max_y = area.min_y;
+			frame_error |= !area.valid;
+			++seq;
+			continue;
+		}
+
+		const int vertex_count = item.vertex_count;
+		area.edge_count = vertex_count;
+		area.min_x = area.min_y = FLT_MAX;
+		area.max_x = area.max_y = -FLT_MAX;
+
+		// project the vertices first, edge i then goes from vertex i to vertex i - 1 (as in PNPOLY)
+		for (int i = 0; i < vertex_count; ++i) {
+			const mission_fence_point_s &vertex = items[seq + i];
+			Edge &edge = _edges[_num_edges + i];
+
+			area.valid = area.valid && frame_supported(vertex.frame);
+			map_projection_project(&_reference, vertex.lat, vertex.lon, &edge.x, &edge.y);
+
+			area.min_x = math::min(area.min_x, edge.x);
+			area.min_y = math::min(area.min_y, edge.y);
+			area.max_x = math::max(area.max_x, edge.x);
+			area.max_y = math::max(area.max_y, edge.y);
+		}
+
+		for (int i = 0, j = vertex_count - 1; i < vertex_count; j = i++) {
+			Edge &edge = _edges[_num_edges + i];
+			const Edge &prev = _edges[_num_edges + j];
+			const float dy = prev.y - edge.y;
+
+			edge.y_end = prev.y;
+			edge.slope = fabsf(dy) > 0.f ? (prev.x - edge.x) / dy : 0.f;
+		}
+
+		frame_error |= !area.valid;
+		_num_edges += vertex_count;
+		seq += vertex_count;
+	}
+
+	if (frame_error) {
+		PX4_ERR("Frame type not supported, fence area ignored");
+	}
+
+	if (_num_edges == 0) {
+		return PX4_OK;
+	}
+
+	// third pass: choose the slab count of each polygon, so that each slab holds only a few edges,
+	// but an edge is not listed in too many slabs
+	int num_entries = 0;
+	int num_slabs = 0;
+
+	for (int a = 0; a < _num_areas; ++a) {
+		Area &area = _areas[a];
+
+		if (area.edge_count == 0) {
+			continue;
+		}
+
+		int slab_count = math::min(area.edge_count, (int)MAX_SLABS);
+		int entries = countSlabEntries(area, slab_count);
+
+		while (slab_count > 1 && entries > MAX_SLAB_ENTRIES_PER_EDGE * area.edge_count + slab_count) {
+			slab_count /= 2;
+			entries = countSlabEntries(area, slab_count);
+		}
+
+		area.first_slab = num_slabs;
+		num_slabs += slab_count + 1;
+		num_entries += entries;
+	}
+
+	_slab_offsets = new int[num_slabs];
+	_slab_edges = new uint16_t[num_entries > 0 ? num_entries : 1];
+
+	if (_slab_offsets == nullptr || _slab_edges == nullptr) {
+		PX4_ERR("alloc failed");
+		clear();
+		return PX4_ERROR;
+	}
+
+	// fourth pass: fill the slabs, stored compressed in _slab_edges
+	int entry = 0;
+
+	for (int a = 0; a < _num_areas; ++a) {
+		const Area &area = _areas[a];
+
+		if (area.edge_count == 0) {
+			continue;
+		}
+
+		int *offsets = &_slab_offsets[area.first_slab];
+
+		for (int s = 0; s <= area.slab_count; ++s) {
+			offsets[s] = 0;
+		}
+
+		// count the edges per slab, then turn the counts into the start offsets
+		for (int i = 0; i < area.edge_count; ++i) {
+			const Edge &edge = _edges[area.first_edge + i];
+
+			if (edge.y != edge.y_end) {
+				const int last = slabIndex(area, math::max(edge.y, edge.y_end));
+
+				for (int s = slabIndex(area, math::min(edge.y, edge.y_end)); s <= last; ++s) {
+					++offsets[s + 1];
+				}
+			}
+		}
+
+		const int first_entry = entry;
+		offsets[0] = first_entry;
+
+		for (int s = 1; s <= area.slab_count; ++s) {
+			offsets[s] += offsets[s - 1];
+		}
+
+		entry = offsets[area.slab_count];
+
+		// insert the edges using the start offsets as cursors, which moves each to the start of the next slab
+		for (int i = 0; i < area.edge_count; ++i) {
+			const Edge &edge = _edges[area.first_edge + i];
+
+			if (edge.y != edge.y_end) {
+				const int last = slabIndex(area, math::max(edge.y, edge.y_end));
+
+				for (int s = slabIndex(area, math::min(edge.y, edge.y_end)); s <= last; ++s) {
+					_slab_edges[offsets[s]++] = i;
+				}
+			}
+		}
+
+		for (int s = area.slab_count; s > 0; --s) {
+			offsets[s] = offsets[s - 1];
+		}
+
+		offsets[0] = first_entry;
+	}
+
+	return PX4_OK;
+}
+
+bool GeofenceIndex::inside(double lat, double lon) const
+{
+	if (_num_areas == 0) {
+		return true;
+	}
+
+	float x, y;
+	map_projection_project(&_reference, lat, lon, &x, &y);
+
+	bool outside_exclusion = true;
+	bool inside_inclusion = false;
+	bool had_inclusion_areas = false;
+
+	for (int i = 0; i < _num_areas; ++i) {
+		const Area &area = _areas[i];
+		const bool is_inclusion = area.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION
+					  || area.fence_type == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION;
+
+		if (is_inclusion) {
+			had_inclusion_areas = true;
+
+			// one inclusion area is enough
+			if (inside_inclusion) {
+				continue;
+			}
+
+		} else if (!outside_exclusion) {
+			continue;
+		}
+
+		const bool inside_area = (area.edge_count > 0) ? insidePolygon(area, x, y) : insideCircle(area, x, y);
+
+		if (inside_area) {
+			if (is_inclusion) {
+				inside_inclusion = true;
+
+			} else {
+				outside_exclusion = false;
+			}
+		}
+	}
+
+	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
+}
+
+bool GeofenceIndex::insidePolygon(const Area &area, float x, float y) const
+{
+	if (!area.valid || x < area.min_x || x > area.max_x || y < area.min_y || y > area.max_y) {
+		return false;
+	}
+
+	/* Adaptation of algorithm originally presented as
+	 * PNPOLY - Point Inclusion in Polygon Test
+	 * W. Randolph Franklin (WRF)
+	 * Only supports non-complex polygons (not self intersecting)
+	 *
+	 * Only the edges listed in the slab of the point can cross the ray.
+	 */
+	const int slab = slabIndex(area, y);
+	const int *offsets = &_slab_offsets[area.first_slab];
+	const Edge *edges = &_edges[area.first_edge];
+	bool c = false;
+
+	for (int k = offsets[slab]; k < offsets[slab + 1]; ++k) {
+		const Edge &edge = edges[_slab_edges[k]];
+
+		if (((edge.y >= y) != (edge.y_end >= y)) && (x <= edge.slope * (y - edge.y) + edge.x)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+
+bool GeofenceIndex::insideCircle(const Area &area, float x, float y) const
+{
+	if (!area.valid) {
+		return false;
+	}
+
+	const float dx = x - area.min_x;
+	const float dy = y - area.min_y;
+	return dx * dx + dy * dy < area.radius * area.radius;
+}
+
+int GeofenceIndex::areaCount(uint16_t fence_type) const
+{
+	int count = 0;
+
+	for (int i = 0; i < _num_areas; ++i) {
+		if (_areas[i].fence_type == fence_type) {
+			++count;
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file geofence_index.h
+ * In-memory representation of the geofence areas, compiled from the dataman fence items.
+ *
+ * The areas are projected into a local frame once, and every polygon gets a bounding box and a
+ * uniform grid of slabs over its edges, so that a point check does not need any dataman access
+ * and only visits the edges near the point.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <geo/geo.h>
+
+#include "navigation.h"
+
+class GeofenceIndex
+{
+public:
+	GeofenceIndex() = default;
+	GeofenceIndex(const GeofenceIndex &) = delete;
+	GeofenceIndex &operator=(const GeofenceIndex &) = delete;
+	~GeofenceIndex();
+
+	/**
+	 * Compile the fence items, replacing the current areas.
+	 *
+	 * @param items fence items as stored in dataman, without the stats entry
+	 * @param num_items number of fence items
+	 * @return PX4_OK on success, PX4_ERROR if an allocation failed (the index is empty then)
+	 */
+	int build(const mission_fence_point_s *items, int num_items);
+
+	/**
+	 * Remove all areas.
+	 */
+	void clear();
+
+	bool isEmpty() const { return _num_areas == 0; }
+
+	/**
+	 * Check if a point passes the horizontal geofence test.
+	 *
+	 * The check passes if: (inside(polygon_inclusion_1) || inside(polygon_inclusion_2) || ... ) &&
+	 *                       !inside(polygon_exclusion_1) && !inside(polygon_exclusion_2) && ...
+	 *                  or: no area configured
+	 * Circles are handled the same way as polygons.
+	 *
+	 * @return result of the check above (false for a geofence violation)
+	 */
+	bool inside(double lat, double lon) const;
+
+	/**
+	 * @return number of areas with the given fence type (one of MAV_CMD_NAV_FENCE_*)
+	 */
+	int areaCount(uint16_t fence_type) const;
+
+	/**
+	 * @return total number of polygon vertices
+	 */
+	int vertexCount() const { return _num_edges; }
+
+private:
+	struct Area {
+		uint16_t fence_type;	///< one of MAV_CMD_NAV_FENCE_*
+		bool valid;		///< false if the area uses an unsupported frame, it then contains no point
+		uint16_t slab_count;	///< number of slabs of a polygon
+		int first_edge;		///< index of the first polygon edge in _edges
+		int edge_count;
+		int first_slab;		///< index of the first slab offset of a polygon in _slab_offsets
+		float min_x, min_y;	///< bounding box, for circles the center
+		float max_x, max_y;
+		float slab_scale;	///< slabs per meter along y
+		float radius;		///< circle radius
+	};
+
+	/**
+	 * Polygon edge from vertex i to vertex j, with what the crossing test needs precomputed.
+	 */
+	struct Edge {
+		float x;		///< x of vertex i
+		float y;		///< y of vertex i
+		float y_end;		///< y of vertex j
+		float slope;		///< dx/dy from vertex i to vertex j (0 for horizontal edges, which are never crossed)
+	};
+
+	bool insidePolygon(const Area &area, float x, float y) const;
+	bool insideCircle(const Area &area, float x, float y) const;
+
+	/**
+	 * @return the slab containing y, always within [0, slab_count)
+	 */
+	static int slabIndex(const Area &area, float y)
+	{
+		const int slab = (int)((y - area.min_y) * area.slab_scale);
+		return (slab < 0) ? 0 : ((slab >= area.slab_count) ? area.slab_count - 1 : slab);
+	}
+
+	/**
+	 * Count the slab entries needed for the edges of a polygon with the given slab count.
+	 */
+	int countSlabEntries(Area &area, int slab_count) const;
+
+	map_projection_reference_s _reference{};	///< local frame of all areas
+
+	Area *_areas{nullptr};
+	int _num_areas{0};
+
+	Edge *_edges{nullptr};
+	int _num_edges{0};
+
+	/*
+	 * Edges of each slab, stored compressed: the edges of slab s of a polygon are
+	 * _slab_edges[_slab_offsets[first_slab + s]] to _slab_edges[_slab_offsets[first_slab + s + 1] - 1].
+	 */
+	int *_slab_offsets{nullptr};
+	uint16_t *_slab_edges{nullptr};
+
+	static constexpr int MAX_SLABS = 256;	///< maximum number of slabs per polygon
+	static constexpr int MAX_SLAB_ENTRIES_PER_EDGE = 4;	///< memory bound: average slabs an edge may be listed in
+};
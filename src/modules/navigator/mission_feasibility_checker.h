@@ -54,6 +54,9 @@ class MissionFeasibilityChecker
 private:
 	Navigator *_navigator{nullptr};
 
+	/* Read a mission item through the navigator's mission item cache */
+	bool readMissionItem(const mission_s &mission, size_t index, mission_item_s &item);
+
 	/* Checks for all airframes */
 	bool checkGeofence(const mission_s &mission, float home_alt, bool home_valid);
 
@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file mission_item_cache.cpp
+ * Read-through cache for the mission items in dataman.
+ */
+
+#include "mission_item_cache.h"
+
+bool MissionItemCache::read(dm_item_t dm_item, unsigned index, mission_item_s &item)
+{
+	if (dm_item != _dm_item || index < _first_index || index >= _first_index + _count) {
+		/* miss: read ahead, missions are mostly read forward */
+		ssize_t ret = dm_read_range(dm_item, index, CACHE_SIZE, _items, sizeof(mission_item_s));
+
+		if (ret <= 0) {
+			_count = 0;
+			return false;
+		}
+
+		_dm_item = dm_item;
+		_first_index = index;
+		_count = ret;
+	}
+
+	item = _items[index - _first_index];
+	return true;
+}
+
+bool MissionItemCache::write(dm_item_t dm_item, unsigned index, const mission_item_s &item)
+{
+	const ssize_t len = sizeof(mission_item_s);
+
+	if (dm_write(dm_item, index, DM_PERSIST_POWER_ON_RESET, &item, len) != len) {
+		/* the stored item is unknown now */
+		invalidate();
+		return false;
+	}
+
+	if (dm_item == _dm_item && index >= _first_index && index < _first_index + _count) {
+		_items[index - _first_index] = item;
+	}
+
+	return true;
+}
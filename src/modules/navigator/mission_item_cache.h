@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file mission_item_cache.h
+ * Read-through cache for the mission items in dataman.
+ *
+ * The mission is read item by item in many places (feasibility checks, mission advance, landing search), and every
+ * dataman access is a round trip to the dataman task and possibly a file access. The cache keeps a window of
+ * consecutive items, which is filled with a single dataman request.
+ */
+
+#pragma once
+
+#include <dataman/dataman.h>
+#include <navigator/navigation.h>
+
+class MissionItemCache
+{
+public:
+	MissionItemCache() = default;
+	MissionItemCache(const MissionItemCache &) = delete;
+	MissionItemCache &operator=(const MissionItemCache &) = delete;
+	~MissionItemCache() = default;
+
+	/**
+	 * Read a mission item. On a cache miss, the item and the items following it are read with a single request.
+	 *
+	 * @return true on success
+	 */
+	bool read(dm_item_t dm_item, unsigned index, mission_item_s &item);
+
+	/**
+	 * Write a mission item to dataman and update the cached copy.
+	 *
+	 * @return true on success
+	 */
+	bool write(dm_item_t dm_item, unsigned index, const mission_item_s &item);
+
+	/**
+	 * Drop all cached items. This needs to be called whenever the mission items are changed by someone
+	 * else, e.g. on a mission upload.
+	 */
+	void invalidate() { _count = 0; }
+
+private:
+#if defined(MEMORY_CONSTRAINED_SYSTEM)
+	static constexpr unsigned CACHE_SIZE = 8;
+#elif defined(__PX4_POSIX)
+	static constexpr unsigned CACHE_SIZE = 256;
+#else
+	static constexpr unsigned CACHE_SIZE = 32;
+#endif
+
+	mission_item_s _items[CACHE_SIZE];	///< items _first_index to _first_index + _count - 1 of _dm_item
+	dm_item_t _dm_item{DM_KEY_NUM_KEYS};
+	unsigned _first_index{0};
+	unsigned _count{0};
+};
@@ -51,6 +51,7 @@
 #include "precland.h"
 #include "loiter.h"
 #include "mission.h"
+#include "mission_item_cache.h"
 #include "navigator_mode.h"
 #include "rcloss.h"
 #include "rtl.h"
@@ -161,6 +162,8 @@ public:
 
 	Geofence	&get_geofence() { return _geofence; }
 
+	MissionItemCache &get_mission_item_cache() { return _mission_item_cache; }
+
 	bool		get_can_loiter_at_sp() { return _can_loiter_at_sp; }
 	float		get_loiter_radius() { return _param_loiter_radius.get(); }
 
@@ -311,6 +314,8 @@ private:
 	Geofence	_geofence;			/**< class that handles the geofence */
 	bool		_geofence_violation_warning_sent{false}; /**< prevents spaming to mavlink */
 
+	MissionItemCache	_mission_item_cache;		/**< cache of the offboard mission items in dataman */
+
 	bool		_can_loiter_at_sp{false};			/**< flags if current position SP can be used to loiter */
 	bool		_pos_sp_triplet_updated{false};		/**< flags if position SP triplet needs to be published */
 	bool 		_pos_sp_triplet_published_invalid_once{false};	/**< flags if position SP triplet has been published once to UORB */
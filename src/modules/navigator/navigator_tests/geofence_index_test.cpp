@@ -0,0 +1,339 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file geofence_index_test.cpp
+ * Geofence index unit test: compares the index against a plain PNPOLY check over all vertices
+ * and measures the time per check of both.
+ */
+
+#include "geofence_index_test.h"
+
+#include "../geofence_index.h"
+
+#include <math.h>
+
+#include <drivers/drv_hrt.h>
+#include <unit_test.h>
+#include <v2.0/common/mavlink.h>
+
+class GeofenceIndexTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool emptyTest();
+	bool squareTest();
+	bool invalidItemsTest();
+	bool largeFenceTest();
+
+	static constexpr double LAT0 = 47.397742;
+	static constexpr double LON0 = 8.545594;
+
+	/**
+	 * Append a fence item at an offset in meters from (LAT0, LON0).
+	 */
+	void addItem(uint16_t nav_cmd, float north, float east, uint16_t vertex_count_or_zero, float circle_radius = 0.f,
+		     uint8_t frame = MAV_FRAME_GLOBAL);
+	void addPolygon(uint16_t nav_cmd, int vertex_count, float center_north, float center_east, float radius_min,
+			float radius_max);
+
+	/**
+	 * Reference check over all areas, without index. Uses the same local frame as the index.
+	 */
+	bool insideBruteForce(double lat, double lon) const;
+
+	/** deterministic pseudo random number in [0, 1) */
+	float random();
+
+	/** deterministic pseudo random test point around the large fence */
+	void randomPoint(double &lat, double &lon);
+
+	static constexpr int MAX_ITEMS = 1536;
+	mission_fence_point_s _items[MAX_ITEMS];
+	int _num_items{0};
+	uint32_t _seed{1};
+};
+
+float GeofenceIndexTest::random()
+{
+	_seed = _seed * 1664525u + 1013904223u;
+	return (_seed >> 8) / (float)(1 << 24);
+}
+
+void GeofenceIndexTest::randomPoint(double &lat, double &lon)
+{
+	lat = LAT0 + (-1200.0 + 3000.0 * random()) / 111111.0;
+	lon = LON0 + (-1200.0 + 3600.0 * random()) / (111111.0 * cos(LAT0 * M_PI / 180.0));
+}
+
+void GeofenceIndexTest::addItem(uint16_t nav_cmd, float north, float east, uint16_t vertex_count_or_zero,
+				float circle_radius, uint8_t frame)
+{
+	if (_num_items >= MAX_ITEMS) {
+		return;
+	}
+
+	mission_fence_point_s &item = _items[_num_items++];
+	item.lat = LAT0 + (double)north / 111111.0;
+	item.lon = LON0 + (double)east / (111111.0 * cos(LAT0 * M_PI / 180.0));
+	item.alt = 0.f;
+	item.nav_cmd = nav_cmd;
+	item.frame = frame;
+
+	if (circle_radius > 0.f) {
+		item.circle_radius = circle_radius;
+
+	} else {
+		item.vertex_count = vertex_count_or_zero;
+	}
+}
+
+void GeofenceIndexTest::addPolygon(uint16_t nav_cmd, int vertex_count, float center_north, float center_east,
+				   float radius_min, float radius_max)
+{
+	// star shaped polygon: never self intersecting
+	for (int i = 0; i < vertex_count; ++i) {
+		const float angle = 2.f * M_PI_F * i / vertex_count;
+		const float radius = radius_min + (radius_max - radius_min) * random();
+		addItem(nav_cmd, center_north + radius * cosf(angle), center_east + radius * sinf(angle), vertex_count);
+	}
+}
+
+bool GeofenceIndexTest::insideBruteForce(double lat, double lon) const
+{
+	map_projection_reference_s reference{};
+
+	if (_num_items == 0) {
+		return true;
+	}
+
+	map_projection_init(&reference, _items[0].lat, _items[0].lon);
+
+	float x, y;
+	map_projection_project(&reference, lat, lon, &x, &y);
+
+	bool outside_exclusion = true;
+	bool inside_inclusion = false;
+	bool had_inclusion_areas = false;
+	int seq = 0;
+
+	while (seq < _num_items) {
+		const mission_fence_point_s &item = _items[seq];
+		bool inside = false;
+		bool is_inclusion = false;
+
+		if (item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION || item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION) {
+			float cx, cy;
+			map_projection_project(&reference, item.lat, item.lon, &cx, &cy);
+			const float dx = x - cx, dy = y - cy;
+			inside = dx * dx + dy * dy < item.circle_radius * item.circle_radius;
+			is_inclusion = item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION;
+			++seq;
+
+		} else {
+			const int n = item.vertex_count;
+
+			for (int i = 0, j = n - 1; i < n; j = i++) {
+				float xi, yi, xj, yj;
+				map_projection_project(&reference, _items[seq + i].lat, _items[seq + i].lon, &xi, &yi);
+				map_projection_project(&reference, _items[seq + j].lat, _items[seq + j].lon, &xj, &yj);
+
+				if (((yi >= y) != (yj >= y)) && (x <= (xj - xi) / (yj - yi) * (y - yi) + xi)) {
+					inside = !inside;
+				}
+			}
+
+			is_inclusion = item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION;
+			seq += n;
+		}
+
+		if (is_inclusion) {
+			had_inclusion_areas = true;
+			inside_inclusion = inside_inclusion || inside;
+
+		} else {
+			outside_exclusion = outside_exclusion && !inside;
+		}
+	}
+
+	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
+}
+
+bool GeofenceIndexTest::emptyTest()
+{
+	GeofenceIndex index;
+
+	ut_compare("build", index.build(_items, 0), PX4_OK);
+	ut_assert_true(index.isEmpty());
+	ut_assert_true(index.inside(LAT0, LON0));
+	ut_assert_true(index.inside(-LAT0, -LON0));
+
+	return true;
+}
+
+bool GeofenceIndexTest::squareTest()
+{
+	GeofenceIndex index;
+
+	_num_items = 0;
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, -100.f, -100.f, 4);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, -100.f, 100.f, 4);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, 100.f, 100.f, 4);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, 100.f, -100.f, 4);
+	addItem(MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION, 50.f, 50.f, 0, 20.f);
+	addItem(MAV_CMD_NAV_FENCE_RETURN_POINT, 0.f, 0.f, 0);
+
+	ut_compare("build", index.build(_items, _num_items), PX4_OK);
+	ut_assert_false(index.isEmpty());
+	ut_compare("polygons", index.areaCount(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION), 1);
+	ut_compare("circles", index.areaCount(MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION), 1);
+	ut_compare("vertices", index.vertexCount(), 4);
+
+	ut_assert_true(index.inside(LAT0, LON0));
+	ut_assert_false(index.inside(LAT0 + 200.0 / 111111.0, LON0));
+	ut_assert_false(index.inside(LAT0 - 200.0 / 111111.0, LON0));
+	ut_assert_false(index.inside(LAT0 + 50.0 / 111111.0, LON0 + 50.0 / (111111.0 * cos(LAT0 * M_PI / 180.0))));
+
+	index.clear();
+	ut_assert_true(index.isEmpty());
+	ut_assert_true(index.inside(LAT0 + 200.0 / 111111.0, LON0));
+
+	return true;
+}
+
+bool GeofenceIndexTest::invalidItemsTest()
+{
+	GeofenceIndex index;
+
+	// unsupported frame: the area contains no point, so the inclusion fails everywhere
+	_num_items = 0;
+	addItem(MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION, 0.f, 0.f, 0, 100.f, MAV_FRAME_LOCAL_NED);
+
+	ut_compare("build", index.build(_items, _num_items), PX4_OK);
+	ut_assert_false(index.inside(LAT0, LON0));
+
+	// polygon with 0 vertices, and a polygon with more vertices than items are skipped
+	_num_items = 0;
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, 0.f, 0.f, 0);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, -10.f, -10.f, 5);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, 10.f, 0.f, 5);
+	addItem(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, 0.f, 10.f, 5);
+
+	ut_compare("build", index.build(_items, _num_items), PX4_OK);
+	ut_assert_true(index.isEmpty());
+	ut_assert_true(index.inside(LAT0, LON0));
+
+	return true;
+}
+
+bool GeofenceIndexTest::largeFenceTest()
+{
+	static constexpr int NUM_POINTS = 300;
+
+	GeofenceIndex index;
+
+	_num_items = 0;
+	_seed = 1;
+
+	// a large inclusion area with a few holes, and a smaller disjoint inclusion area
+	addPolygon(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, 1000, 0.f, 0.f, 800.f, 1000.f);
+	addPolygon(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, 200, 0.f, 2000.f, 200.f, 400.f);
+	addPolygon(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, 300, 300.f, 300.f, 50.f, 200.f);
+	addPolygon(MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION, 3, -400.f, 0.f, 100.f, 100.f);
+	addItem(MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION, -300.f, -300.f, 0, 150.f);
+	addItem(MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION, 1500.f, 0.f, 0, 200.f);
+
+	ut_compare("build", index.build(_items, _num_items), PX4_OK);
+	ut_compare("vertices", index.vertexCount(), 1503);
+
+	const uint32_t points_seed = _seed;
+	double lat, lon;
+	int num_inside = 0;
+
+	for (int i = 0; i < NUM_POINTS; ++i) {
+		randomPoint(lat, lon);
+
+		const bool inside = index.inside(lat, lon);
+		ut_compare("index matches brute force", inside, insideBruteForce(lat, lon));
+		num_inside += inside ? 1 : 0;
+	}
+
+	// make sure both outcomes are covered
+	ut_assert_true(num_inside > NUM_POINTS / 10 && num_inside < NUM_POINTS * 9 / 10);
+
+	// time the same points again
+	int count = 0;
+	_seed = points_seed;
+	hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < NUM_POINTS; ++i) {
+		randomPoint(lat, lon);
+		count += insideBruteForce(lat, lon) ? 1 : 0;
+	}
+
+	const hrt_abstime brute_force_time = hrt_elapsed_time(&start);
+
+	_seed = points_seed;
+	start = hrt_absolute_time();
+
+	for (int i = 0; i < NUM_POINTS; ++i) {
+		randomPoint(lat, lon);
+		count -= index.inside(lat, lon) ? 1 : 0;
+	}
+
+	const hrt_abstime index_time = hrt_elapsed_time(&start);
+
+	ut_compare("same result", count, 0);
+
+	PX4_INFO("geofence with %i vertices: brute force %.2f us/check, index %.2f us/check", index.vertexCount(),
+		 (double)brute_force_time / NUM_POINTS, (double)index_time / NUM_POINTS);
+
+	// the index has to pay off for large fences
+	ut_assert_true(index_time < brute_force_time);
+
+	return true;
+}
+
+bool GeofenceIndexTest::run_tests()
+{
+	ut_run_test(emptyTest);
+	ut_run_test(squareTest);
+	ut_run_test(invalidItemsTest);
+	ut_run_test(largeFenceTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(geofenceIndexTest, GeofenceIndexTest)
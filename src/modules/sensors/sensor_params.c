@@ -264,3 +264,32 @@ PARAM_DEFINE_FLOAT(IMU_GYRO_CUTOFF, 30.0f);
 * @group Sensors
 */
 PARAM_DEFINE_FLOAT(IMU_ACCEL_CUTOFF, 30.0f);
+
+/**
+* Driver level notch frequency for gyro
+*
+* The center frequency of the notch filter on the gyro driver, which is applied after the low pass
+* (IMU_GYRO_CUTOFF). Set it to the frequency of the dominant vibration, e.g. the motor rotation
+* frequency. This feature is currently supported by the mpu6000 and mpu9250. This only affects the
+* signal sent to the controllers, not the estimators. 0 disables the filter.
+*
+* @min 0
+* @max 1000
+* @unit Hz
+* @reboot_required true
+* @group Sensors
+*/
+PARAM_DEFINE_FLOAT(IMU_GYRO_NF_FREQ, 0.0f);
+
+/**
+* Driver level notch bandwidth for gyro
+*
+* The bandwidth of the notch filter on the gyro driver, see IMU_GYRO_NF_FREQ.
+*
+* @min 0
+* @max 100
+* @unit Hz
+* @reboot_required true
+* @group Sensors
+*/
+PARAM_DEFINE_FLOAT(IMU_GYRO_NF_BW, 20.0f);
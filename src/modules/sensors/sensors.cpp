@@ -230,7 +230,7 @@ private:
 
 Sensors::Sensors(bool hil_enabled) :
 	_hil_enabled(hil_enabled),
-	_loop_perf(perf_alloc(PC_ELAPSED, "sensors")),
+	_loop_perf(perf_alloc(PC_ELAPSED_HIST, "sensors")),
 	_rc_update(_parameters),
 	_voted_sensors_update(_parameters, hil_enabled)
 {
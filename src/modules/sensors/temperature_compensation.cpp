@@ -377,8 +377,8 @@ int TemperatureCompensation::set_sensor_id(uint32_t device_id, int topic_instanc
 	return -1;
 }
 
-int TemperatureCompensation::apply_corrections_gyro(int topic_instance, math::Vector<3> &sensor_data, float temperature,
-		float *offsets, float *scales)
+int TemperatureCompensation::get_corrections_gyro(int topic_instance, float temperature, float *offsets,
+		float *scales)
 {
 	if (_parameters.gyro_tc_enable != 1) {
 		return 0;
@@ -392,10 +392,9 @@ int TemperatureCompensation::apply_corrections_gyro(int topic_instance, math::Ve
 
 	calc_thermal_offsets_3D(_parameters.gyro_cal_data[mapping], temperature, offsets);
 
-	// get the sensor scale factors and correct the data
+	// get the sensor scale factors
 	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
 		scales[axis_index] = _parameters.gyro_cal_data[mapping].scale[axis_index];
-		sensor_data(axis_index) = (sensor_data(axis_index) - offsets[axis_index]) * scales[axis_index];
 	}
 
 	if (fabsf(temperature - _gyro_data.last_temperature[topic_instance]) > 1.0f) {
@@ -406,8 +405,8 @@ int TemperatureCompensation::apply_corrections_gyro(int topic_instance, math::Ve
 	return 1;
 }
 
-int TemperatureCompensation::apply_corrections_accel(int topic_instance, math::Vector<3> &sensor_data,
-		float temperature, float *offsets, float *scales)
+int TemperatureCompensation::get_corrections_accel(int topic_instance, float temperature, float *offsets,
+		float *scales)
 {
 	if (_parameters.accel_tc_enable != 1) {
 		return 0;
@@ -421,10 +420,9 @@ int TemperatureCompensation::apply_corrections_accel(int topic_instance, math::V
 
 	calc_thermal_offsets_3D(_parameters.accel_cal_data[mapping], temperature, offsets);
 
-	// get the sensor scale factors and correct the data
+	// get the sensor scale factors
 	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
 		scales[axis_index] = _parameters.accel_cal_data[mapping].scale[axis_index];
-		sensor_data(axis_index) = (sensor_data(axis_index) - offsets[axis_index]) * scales[axis_index];
 	}
 
 	if (fabsf(temperature - _accel_data.last_temperature[topic_instance]) > 1.0f) {
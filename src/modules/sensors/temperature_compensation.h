@@ -78,23 +78,30 @@ public:
 
 
 	/**
-	 * Apply Thermal corrections to gyro (& other) sensor data.
+	 * Calculate the thermal corrections for gyro (& accel) sensor data, without applying them.
+	 * The corrected value is (sensor_data - offsets) * scales.
 	 * @param topic_instance uORB topic instance
-	 * @param sensor_data input sensor data, output sensor data with applied corrections
 	 * @param temperature measured current temperature
-	 * @param offsets returns offsets that were applied (length = 3, except for baro), depending on return value
-	 * @param scales returns scales that were applied (length = 3), depending on return value
+	 * @param offsets returns offsets to apply (length = 3), depending on return value
+	 * @param scales returns scales to apply (length = 3), depending on return value
 	 * @return -1: error: correction enabled, but no sensor mapping set (@see set_sendor_id_gyro)
 	 *         0: no changes (correction not enabled),
-	 *         1: corrections applied but no changes to offsets & scales,
-	 *         2: corrections applied and offsets & scales updated
+	 *         1: corrections calculated but no changes to offsets & scales,
+	 *         2: corrections calculated and offsets & scales updated
 	 */
-	int apply_corrections_gyro(int topic_instance, math::Vector<3> &sensor_data, float temperature,
-				   float *offsets, float *scales);
+	int get_corrections_gyro(int topic_instance, float temperature, float *offsets, float *scales);
 
-	int apply_corrections_accel(int topic_instance, math::Vector<3> &sensor_data, float temperature,
-				    float *offsets, float *scales);
+	int get_corrections_accel(int topic_instance, float temperature, float *offsets, float *scales);
 
+	/**
+	 * Apply Thermal corrections to baro sensor data.
+	 * @param topic_instance uORB topic instance
+	 * @param sensor_data input sensor data, output sensor data with applied corrections
+	 * @param temperature measured current temperature
+	 * @param offsets returns offsets that were applied, depending on return value
+	 * @param scales returns scales that were applied, depending on return value
+	 * @return same as get_corrections_gyro()
+	 */
 	int apply_corrections_baro(int topic_instance, float &sensor_data, float temperature,
 				   float *offsets, float *scales);
 
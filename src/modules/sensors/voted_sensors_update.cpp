@@ -54,7 +54,7 @@ using namespace DriverFramework;
 const double VotedSensorsUpdate::_msl_pressure = 101.325;
 
 VotedSensorsUpdate::VotedSensorsUpdate(const Parameters &parameters, bool hil_enabled)
-	: _parameters(parameters), _hil_enabled(hil_enabled)
+	: _poll_perf(perf_alloc(PC_ELAPSED, "sensors_poll")), _parameters(parameters), _hil_enabled(hil_enabled)
 {
 	memset(&_last_sensor_data, 0, sizeof(_last_sensor_data));
 	memset(&_last_accel_timestamp, 0, sizeof(_last_accel_timestamp));
@@ -90,6 +90,11 @@ VotedSensorsUpdate::VotedSensorsUpdate(const Parameters &parameters, bool hil_en
 	}
 }
 
+VotedSensorsUpdate::~VotedSensorsUpdate()
+{
+	perf_free(_poll_perf);
+}
+
 int VotedSensorsUpdate::init(sensor_combined_s &raw)
 {
 	raw.accelerometer_timestamp_relative = sensor_combined_s::RELATIVE_TIMESTAMP_INVALID;
@@ -111,6 +116,95 @@ void VotedSensorsUpdate::initialize_sensors()
 	init_sensor_class(ORB_ID(sensor_mag), _mag, MAG_COUNT_MAX);
 	init_sensor_class(ORB_ID(sensor_accel), _accel, ACCEL_COUNT_MAX);
 	init_sensor_class(ORB_ID(sensor_baro), _baro, BARO_COUNT_MAX);
+
+#if defined(__PX4_NUTTX)
+	_poll_fd_count = 0;
+
+	SensorData *sensors[] = {&_gyro, &_accel, &_mag, &_baro};
+
+	for (SensorData *sensor : sensors) {
+		for (int i = 0; i < sensor->subscription_count; i++) {
+			_poll_fds[_poll_fd_count].fd = sensor->subscription[i];
+			_poll_fds[_poll_fd_count].events = POLLIN;
+			_poll_fd_count++;
+		}
+	}
+
+#endif
+}
+
+void VotedSensorsUpdate::poll_updates()
+{
+	SensorData *sensors[] = {&_gyro, &_accel, &_mag, &_baro};
+
+#if defined(__PX4_NUTTX)
+	/* a single poll() instead of an orb_check() syscall per instance */
+	if (_poll_fd_count == 0 || px4_poll(_poll_fds, _poll_fd_count, 0) < 0) {
+		for (SensorData *sensor : sensors) {
+			memset(sensor->updated, 0, sizeof(sensor->updated));
+		}
+
+		return;
+	}
+
+	unsigned fd_index = 0;
+
+	for (SensorData *sensor : sensors) {
+		for (int i = 0; i < sensor->subscription_count; i++) {
+			sensor->updated[i] = (_poll_fds[fd_index++].revents & POLLIN) != 0;
+		}
+	}
+
+#else
+
+	/* orb_check() does not enter the kernel here, and is cheaper than setting up a poll */
+	for (SensorData *sensor : sensors) {
+		for (int i = 0; i < sensor->subscription_count; i++) {
+			orb_check(sensor->subscription[i], &sensor->updated[i]);
+		}
+	}
+
+#endif
+}
+
+void VotedSensorsUpdate::update_correction(SensorCorrection &correction, bool gyro, unsigned uorb_index,
+		float temperature, float *offsets, float *scales)
+{
+	if (correction.valid && fabsf(temperature - correction.temperature) <= CORRECTION_TEMPERATURE_STEP) {
+		return;
+	}
+
+	int ret = 0;
+
+	if (!_hil_enabled) {
+		if (gyro) {
+			ret = _temperature_compensation.get_corrections_gyro(uorb_index, temperature, offsets, scales);
+
+		} else {
+			ret = _temperature_compensation.get_corrections_accel(uorb_index, temperature, offsets, scales);
+		}
+	}
+
+	if (ret == 2) {
+		_corrections_changed = true;
+	}
+
+	correction.transform = _board_rotation;
+	correction.offset.zero();
+
+	if (ret > 0) {
+		// body = R * diag(scales) * (sample - offsets) = transform * sample - transform * offsets
+		for (unsigned row = 0; row < 3; row++) {
+			for (unsigned col = 0; col < 3; col++) {
+				correction.transform(row, col) = _board_rotation(row, col) * scales[col];
+			}
+		}
+
+		correction.offset = correction.transform * math::Vector<3>(offsets);
+	}
+
+	correction.temperature = temperature;
+	correction.valid = true;
 }
 
 void VotedSensorsUpdate::deinit()
@@ -134,6 +228,15 @@ void VotedSensorsUpdate::deinit()
 
 void VotedSensorsUpdate::parameters_update()
 {
+	/* rotation or thermal calibration may change, rebuild the combined corrections */
+	for (unsigned i = 0; i < GYRO_COUNT_MAX; i++) {
+		_gyro_correction[i].valid = false;
+	}
+
+	for (unsigned i = 0; i < ACCEL_COUNT_MAX; i++) {
+		_accel_correction[i].valid = false;
+	}
+
 	get_rot_matrix((enum Rotation)_parameters.board_rotation, &_board_rotation);
 	/* fine tune board offset */
 	math::Matrix<3, 3> board_rotation_offset;
@@ -546,10 +649,7 @@ void VotedSensorsUpdate::accel_poll(struct sensor_combined_s &raw)
 	float *scales[] = {_corrections.accel_scale_0, _corrections.accel_scale_1, _corrections.accel_scale_2 };
 
 	for (unsigned uorb_index = 0; uorb_index < _accel.subscription_count; uorb_index++) {
-		bool accel_updated;
-		orb_check(_accel.subscription[uorb_index], &accel_updated);
-
-		if (accel_updated && _accel.enabled[uorb_index]) {
+		if (_accel.updated[uorb_index] && _accel.enabled[uorb_index]) {
 			struct accel_report accel_report;
 
 			orb_copy(ORB_ID(sensor_accel), _accel.subscription[uorb_index], &accel_report);
@@ -601,16 +701,11 @@ void VotedSensorsUpdate::accel_poll(struct sensor_combined_s &raw)
 					(accel_report.timestamp - _last_accel_timestamp[uorb_index]);
 			}
 
-			// handle temperature compensation
-			if (!_hil_enabled) {
-				if (_temperature_compensation.apply_corrections_accel(uorb_index, accel_data, accel_report.temperature,
-						offsets[uorb_index], scales[uorb_index]) == 2) {
-					_corrections_changed = true;
-				}
-			}
-
-			// rotate corrected measurements from sensor to body frame
-			accel_data = _board_rotation * accel_data;
+			// handle temperature compensation and rotate corrected measurements from sensor to body frame
+			SensorCorrection &correction = _accel_correction[uorb_index];
+			update_correction(correction, false, uorb_index, accel_report.temperature,
+					  offsets[uorb_index], scales[uorb_index]);
+			accel_data = correction.transform * accel_data - correction.offset;
 
 			_last_sensor_data[uorb_index].accelerometer_m_s2[0] = accel_data(0);
 			_last_sensor_data[uorb_index].accelerometer_m_s2[1] = accel_data(1);
@@ -653,10 +748,7 @@ void VotedSensorsUpdate::gyro_poll(struct sensor_combined_s &raw)
 	float *scales[] = {_corrections.gyro_scale_0, _corrections.gyro_scale_1, _corrections.gyro_scale_2 };
 
 	for (unsigned uorb_index = 0; uorb_index < _gyro.subscription_count; uorb_index++) {
-		bool gyro_updated;
-		orb_check(_gyro.subscription[uorb_index], &gyro_updated);
-
-		if (gyro_updated && _gyro.enabled[uorb_index]) {
+		if (_gyro.updated[uorb_index] && _gyro.enabled[uorb_index]) {
 			struct gyro_report gyro_report;
 
 			orb_copy(ORB_ID(sensor_gyro), _gyro.subscription[uorb_index], &gyro_report);
@@ -708,16 +800,11 @@ void VotedSensorsUpdate::gyro_poll(struct sensor_combined_s &raw)
 					(gyro_report.timestamp - _last_sensor_data[uorb_index].timestamp);
 			}
 
-			// handle temperature compensation
-			if (!_hil_enabled) {
-				if (_temperature_compensation.apply_corrections_gyro(uorb_index, gyro_rate, gyro_report.temperature,
-						offsets[uorb_index], scales[uorb_index]) == 2) {
-					_corrections_changed = true;
-				}
-			}
-
-			// rotate corrected measurements from sensor to body frame
-			gyro_rate = _board_rotation * gyro_rate;
+			// handle temperature compensation and rotate corrected measurements from sensor to body frame
+			SensorCorrection &correction = _gyro_correction[uorb_index];
+			update_correction(correction, true, uorb_index, gyro_report.temperature,
+					  offsets[uorb_index], scales[uorb_index]);
+			gyro_rate = correction.transform * gyro_rate - correction.offset;
 
 			_last_sensor_data[uorb_index].gyro_rad[0] = gyro_rate(0);
 			_last_sensor_data[uorb_index].gyro_rad[1] = gyro_rate(1);
@@ -758,10 +845,7 @@ void VotedSensorsUpdate::gyro_poll(struct sensor_combined_s &raw)
 void VotedSensorsUpdate::mag_poll(struct sensor_combined_s &raw)
 {
 	for (unsigned uorb_index = 0; uorb_index < _mag.subscription_count; uorb_index++) {
-		bool mag_updated;
-		orb_check(_mag.subscription[uorb_index], &mag_updated);
-
-		if (mag_updated && _mag.enabled[uorb_index]) {
+		if (_mag.updated[uorb_index] && _mag.enabled[uorb_index]) {
 			struct mag_report mag_report;
 
 			orb_copy(ORB_ID(sensor_mag), _mag.subscription[uorb_index], &mag_report);
@@ -818,10 +902,7 @@ void VotedSensorsUpdate::baro_poll(struct sensor_combined_s &raw)
 	float *scales[] = {&_corrections.baro_scale_0, &_corrections.baro_scale_1, &_corrections.baro_scale_2 };
 
 	for (unsigned uorb_index = 0; uorb_index < _baro.subscription_count; uorb_index++) {
-		bool baro_updated;
-		orb_check(_baro.subscription[uorb_index], &baro_updated);
-
-		if (baro_updated) {
+		if (_baro.updated[uorb_index]) {
 			struct baro_report baro_report;
 
 			orb_copy(ORB_ID(sensor_baro), _baro.subscription[uorb_index], &baro_report);
@@ -1000,6 +1081,8 @@ void VotedSensorsUpdate::print_status()
 	_baro.voter.print();
 
 	_temperature_compensation.print_status();
+
+	perf_print_counter(_poll_perf);
 }
 
 bool
@@ -1050,6 +1133,10 @@ VotedSensorsUpdate::apply_mag_calibration(DevHandle &h, const struct mag_calibra
 
 void VotedSensorsUpdate::sensors_poll(sensor_combined_s &raw)
 {
+	perf_begin(_poll_perf);
+
+	poll_updates();
+
 	accel_poll(raw);
 	gyro_poll(raw);
 	mag_poll(raw);
@@ -1082,6 +1169,8 @@ void VotedSensorsUpdate::sensors_poll(sensor_combined_s &raw)
 
 		_selection_changed = false;
 	}
+
+	perf_end(_poll_perf);
 }
 
 void VotedSensorsUpdate::check_failover()
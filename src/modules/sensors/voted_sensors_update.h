@@ -49,6 +49,9 @@
 
 #include <mathlib/mathlib.h>
 
+#include <px4_posix.h>
+#include <systemlib/perf_counter.h>
+
 #include <lib/ecl/validation/data_validator.h>
 #include <lib/ecl/validation/data_validator_group.h>
 
@@ -78,6 +81,7 @@ public:
 	 * Only when calling init(), they have to be initialized.
 	 */
 	VotedSensorsUpdate(const Parameters &parameters, bool hil_enabled);
+	~VotedSensorsUpdate();
 
 	/**
 	 * initialize subscriptions etc.
@@ -153,12 +157,14 @@ private:
 		{
 			for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
 				enabled[i] = true;
+				updated[i] = false;
 				subscription[i] = -1;
 				priority[i] = 0;
 			}
 		}
 
 		bool enabled[SENSOR_COUNT_MAX];
+		bool updated[SENSOR_COUNT_MAX]; /**< new data is available, set by poll_updates() */
 
 		int subscription[SENSOR_COUNT_MAX]; /**< raw sensor data subscription */
 		uint8_t priority[SENSOR_COUNT_MAX]; /**< sensor priority */
@@ -168,8 +174,42 @@ private:
 		unsigned int last_failover_count;
 	};
 
+	/**
+	 * Thermal correction, scale and board rotation of one sensor instance, combined
+	 * so that a sample is corrected with body = transform * sample - offset.
+	 */
+	struct SensorCorrection {
+		math::Matrix<3, 3> transform;
+		math::Vector<3> offset;
+		float temperature; /**< temperature the thermal offsets were calculated for */
+		bool valid;
+	};
+
+	/**
+	 * The thermal offsets are recalculated when the temperature changed by more than this.
+	 */
+	static constexpr float CORRECTION_TEMPERATURE_STEP = 0.05f;
+
 	void	init_sensor_class(const struct orb_metadata *meta, SensorData &sensor_data, uint8_t sensor_count_max);
 
+	/**
+	 * Find out which sensor instances have new data and set SensorData::updated accordingly.
+	 */
+	void		poll_updates();
+
+	/**
+	 * Update the combined correction of a gyro or accel instance, if needed.
+	 *
+	 * @param correction		combined correction to update
+	 * @param gyro			true for a gyro, false for an accel
+	 * @param uorb_index		topic instance of the sensor
+	 * @param temperature		current sensor temperature
+	 * @param offsets		thermal offsets of the instance, output
+	 * @param scales		thermal scales of the instance, output
+	 */
+	void		update_correction(SensorCorrection &correction, bool gyro, unsigned uorb_index, float temperature,
+					  float *offsets, float *scales);
+
 	/**
 	 * Poll the accelerometer for updated data.
 	 *
@@ -256,6 +296,17 @@ private:
 	math::Matrix<3, 3>	_board_rotation = {};	/**< rotation matrix for the orientation that the board is mounted */
 	math::Matrix<3, 3>	_mag_rotation[MAG_COUNT_MAX] = {};	/**< rotation matrix for the orientation that the external mag0 is mounted */
 
+	SensorCorrection	_gyro_correction[GYRO_COUNT_MAX] = {};
+	SensorCorrection	_accel_correction[ACCEL_COUNT_MAX] = {};
+
+#if defined(__PX4_NUTTX)
+	/* all sensor subscriptions, checked for updates with a single poll() */
+	px4_pollfd_struct_t	_poll_fds[GYRO_COUNT_MAX + ACCEL_COUNT_MAX + MAG_COUNT_MAX + BARO_COUNT_MAX] = {};
+	unsigned		_poll_fd_count = 0;
+#endif
+
+	perf_counter_t		_poll_perf; /**< cost of one sensors_poll() */
+
 	const Parameters &_parameters;
 	const bool _hil_enabled; /**< is hardware-in-the-loop mode enabled? */
 
@@ -344,6 +344,7 @@ private:
 	double _realtime_factor;		///< How fast the simulation runs in comparison to real system time
 	hrt_abstime _last_sim_timestamp;
 	hrt_abstime _last_sitl_timestamp;
+	int64_t _lockstep_time_offset{0};	///< hrt time minus simulator time when lockstep took over the clock
 
 	// Lib used to do the battery calculations.
 	Battery _battery;
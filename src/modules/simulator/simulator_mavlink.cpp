@@ -298,6 +298,22 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 			hrt_abstime curr_sitl_time = hrt_absolute_time();
 			hrt_abstime curr_sim_time = imu.time_usec;
 
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+			if (compensation_enabled && _initialized) {
+				if (!px4_lockstep_active()) {
+					// continue from the current time, from here on only the simulator advances it
+					_lockstep_time_offset = (int64_t)curr_sitl_time - (int64_t)curr_sim_time;
+				}
+
+				px4_lockstep_set_time(curr_sim_time + _lockstep_time_offset);
+
+				// time stands still while the simulator is late, nothing to compensate
+				compensation_enabled = false;
+			}
+
+#endif
+
 			if (compensation_enabled && _initialized
 			    && _last_sim_timestamp > 0 && _last_sitl_timestamp > 0
 			    && _last_sitl_timestamp < curr_sitl_time
@@ -336,7 +352,7 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 					unsigned usleep_delay = (sysdelay - min_delay) / _realtime_factor;
 
 					// extend by the realtime factor to avoid drift
-					usleep(usleep_delay);
+					system_usleep(usleep_delay);
 					hrt_stop_delay_delta(exact_delay);
 					px4_sim_stop_delay();
 				}
@@ -383,6 +399,17 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 				int batt_multi;
 				orb_publish_auto(ORB_ID(battery_status), &_battery_pub, &_battery_status, &batt_multi, ORB_PRIO_HIGH);
 			}
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+			if (px4_lockstep_active()) {
+				// acknowledge the step with the controls once every task is done with it
+				px4_lockstep_wait_idle();
+				poll_topics();
+				send_controls();
+			}
+
+#endif
 		}
 		break;
 
@@ -604,6 +631,15 @@ void Simulator::send()
 	int pret;
 
 	while (true) {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+		if (px4_lockstep_active()) {
+			// every simulator step is acknowledged from handle_message() now
+			break;
+		}
+
+#endif
+
 		// wait for up to 100ms for data
 		pret = px4_poll(&fds[0], (sizeof(fds) / sizeof(fds[0])), 100);
 
@@ -662,6 +698,11 @@ void Simulator::initializeSensorData()
 
 void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	// this task waits for the simulator on the host and drives the simulated clock
+	px4_lockstep_unregister_thread();
+#endif
+
 	// set the threads name
 #ifdef __PX4_DARWIN
 	pthread_setname_np("sim_rcv");
@@ -825,6 +866,15 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 
 		//timed out
 		if (pret == 0) {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+			if (px4_lockstep_active()) {
+				// the clock only moves with the simulator anyway
+				continue;
+			}
+
+#endif
+
 			if (!sim_delay) {
 				// we do not want to spam the console by default
 				// PX4_WARN("mavlink sim timeout for %d ms", max_wait_ms);
@@ -846,7 +896,7 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 		if (pret < 0) {
 			PX4_WARN("simulator mavlink: poll error %d, %d", pret, errno);
 			// sleep a bit before next try
-			usleep(100000);
+			system_usleep(100000);
 			continue;
 		}
 
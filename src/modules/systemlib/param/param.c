@@ -47,6 +47,7 @@
 #include <crc32.h>
 #include <float.h>
 #include <math.h>
+#include <stddef.h>
 
 #include <drivers/drv_hrt.h>
 #include <px4_config.h>
@@ -96,6 +97,11 @@ static hrt_abstime last_autosave_timestamp = 0;
 static struct work_s autosave_work;
 static bool autosave_scheduled = false;
 static bool autosave_disabled = false;
+
+/* deferred parameter_update notification */
+#define PARAM_NOTIFY_DELAY_US (50 * 1000)
+static struct work_s notify_work;
+static bool notify_scheduled = false;
 #endif /* PARAM_NO_AUTOSAVE */
 
 /**
@@ -142,13 +148,64 @@ get_param_info_count(void)
 /** flexible array holding modified parameter values */
 FLASH_PARAMS_EXPOSE UT_array        *param_values;
 
+/**
+ * Current value of every parameter, indexed by param_t (default or modified).
+ *
+ * This mirrors param_values for the 4 byte types and is only written with the
+ * writer lock held, but a value is always updated with a single store, so
+ * param_get() can read it without taking the lock.
+ */
+static volatile union param_value_u *param_current_values = NULL;
+
+/**
+ * Instance of the parameter_update that announces the last change of each parameter,
+ * indexed by param_t (lower 16 bits, compared with wrap-around).
+ */
+static uint16_t *param_changed_instance = NULL;
+
+/** instance of the next parameter_update publication */
+static uint32_t param_instance = 0;
+
+#if !defined(FLASH_BASED_PARAMS)
+/*
+ * Journal of parameter changes, appended to the default parameter file after the BSON
+ * document. A save only appends the parameters changed since the last save, and the
+ * file is compacted into a new BSON document once the journal gets too long.
+ */
+#define PARAM_JOURNAL_MAGIC		0xA5
+#define PARAM_JOURNAL_NAME_LEN		16
+#define PARAM_JOURNAL_MAX_RECORDS	128	///< compact the file once the journal would exceed this
+
+#define PARAM_JOURNAL_FLAG_DEFAULT	(1 << 0)	///< the parameter was reset to its default value
+
+struct param_journal_record_s {
+	uint8_t		magic;
+	uint8_t		flags;
+	uint16_t	type;
+	char		name[PARAM_JOURNAL_NAME_LEN];	///< not nul-terminated if the name has the maximum length
+	int32_t		val;				///< int32_t or float value
+	uint32_t	crc;				///< crc32 over the fields above, seeded with the document crc
+};
+
+/** bitmap of the parameters changed since the last save to the default file, indexed by param_t */
+static uint8_t *param_journal_pending = NULL;
+
+/** end of the valid data in the default file, or -1 if the next save needs to rewrite the file */
+static off_t param_journal_offset = -1;
+
+/** number of journal records after the BSON document */
+static unsigned param_journal_records = 0;
+
+/** crc32 of the BSON document, so that records written after an older document never match */
+static uint32_t param_journal_seed = 0;
+#endif /* !FLASH_BASED_PARAMS */
+
 /** array info for the modified parameters array */
 FLASH_PARAMS_EXPOSE const UT_icd    param_icd = {sizeof(struct param_wbuf_s), NULL, NULL, NULL};
 
 #if !defined(PARAM_NO_ORB)
 /** parameter update topic handle */
 static orb_advert_t param_topic = NULL;
-static unsigned int param_instance = 0;
 #endif
 
 static void param_set_used_internal(param_t param);
@@ -236,6 +293,22 @@ param_init(void)
 	param_find_perf = perf_alloc(PC_ELAPSED, "param_find");
 	param_get_perf = perf_alloc(PC_ELAPSED, "param_get");
 	param_set_perf = perf_alloc(PC_ELAPSED, "param_set");
+
+	unsigned count = get_param_info_count();
+
+	if (count > 0) {
+		param_current_values = calloc(count, sizeof(union param_value_u));
+
+		for (param_t param = 0; param_current_values != NULL && param < count; param++) {
+			param_current_values[param].i = param_info_base[param].val.i;
+		}
+
+		param_changed_instance = calloc(count, sizeof(uint16_t));
+
+#if !defined(FLASH_BASED_PARAMS)
+		param_journal_pending = calloc(count / 8 + 1, 1);
+#endif
+	}
 }
 
 /**
@@ -296,13 +369,54 @@ param_find_changed(param_t param)
 	return s;
 }
 
+/**
+ * Remember that a parameter changed, so that param_changed_since() reports it
+ * for the next parameter_update.
+ *
+ * This needs to be called with the writer lock held.
+ */
+static void
+param_mark_changed(param_t param)
+{
+	if (param_changed_instance != NULL) {
+		param_changed_instance[param] = (uint16_t)param_instance;
+	}
+
+#if !defined(FLASH_BASED_PARAMS)
+
+	if (param_journal_pending != NULL) {
+		param_journal_pending[param / 8] |= (1 << (param % 8));
+	}
+
+#endif
+}
+
+bool
+param_changed_since(param_t param, uint32_t instance)
+{
+	if (!handle_in_range(param)) {
+		return false;
+	}
+
+	if (param_changed_instance == NULL) {
+		return true;
+	}
+
+	return (int16_t)(param_changed_instance[param] - (uint16_t)instance) > 0;
+}
+
 static void
 _param_notify_changes(void)
 {
+	/* changes made from now on are announced by the next publication */
+	param_lock_writer();
+	const uint32_t instance = param_instance++;
+	param_unlock_writer();
+
 #if !defined(PARAM_NO_ORB)
 	struct parameter_update_s pup = {
 		.timestamp = hrt_absolute_time(),
-		.instance = param_instance++,
+		.instance = instance,
 	};
 
 	/*
@@ -325,39 +439,49 @@ param_notify_changes(void)
 	_param_notify_changes();
 }
 
-param_t
-param_find_internal(const char *name, bool notification)
+/**
+ * Hash a parameter name (32 bit FNV-1a, followed by an avalanche step).
+ *
+ * This must match name_hash() in px_generate_params.py, which generates
+ * the perfect hash tables.
+ */
+static uint32_t
+param_name_hash(const char *name, uint32_t seed)
 {
-	perf_begin(param_find_perf);
-
-	param_t middle;
-	param_t front = 0;
-	param_t last = get_param_info_count();
+	uint32_t h = 2166136261u ^ seed;
 
-	/* perform a binary search of the known parameters */
-
-	while (front <= last) {
-		middle = front + (last - front) / 2;
-		int ret = strcmp(name, param_info_base[middle].name);
+	while (*name != '\0') {
+		h ^= (uint8_t) * name++;
+		h *= 16777619u;
+	}
 
-		if (ret == 0) {
-			if (notification) {
-				param_set_used_internal(middle);
-			}
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
 
-			perf_end(param_find_perf);
-			return middle;
+param_t
+param_find_internal(const char *name, bool notification)
+{
+	perf_begin(param_find_perf);
 
-		} else if (middle == front) {
-			/* An end point has been hit, but there has been no match */
-			break;
+	unsigned count = get_param_info_count();
 
-		} else if (ret < 0) {
-			last = middle;
+	/* the name selects a bucket, whose seed maps it to a unique slot */
+	uint16_t seed = px4_parameters_hash_seeds[param_name_hash(name, 0) % PX4_PARAMETERS_HASH_BUCKETS];
+	param_t param = px4_parameters_hash_slots[param_name_hash(name, seed) % PX4_PARAMETERS_HASH_SLOTS];
 
-		} else {
-			front = middle;
+	/* unknown names hash to an arbitrary slot, so the name still needs to be compared */
+	if (param < count && strcmp(name, param_info_base[param].name) == 0) {
+		if (notification) {
+			param_set_used_internal(param);
 		}
+
+		perf_end(param_find_perf);
+		return param;
 	}
 
 	perf_end(param_find_perf);
@@ -591,6 +715,15 @@ param_get(param_t param, void *val)
 {
 	int result = -1;
 
+	/* fast path: 4 byte values are read without locking, and without the shared perf counter */
+	if (val && param_current_values != NULL && handle_in_range(param) &&
+	    (param_type(param) == PARAM_TYPE_INT32 || param_type(param) == PARAM_TYPE_FLOAT)) {
+
+		int32_t v = param_current_values[param].i;
+		memcpy(val, &v, sizeof(v));
+		return 0;
+	}
+
 	param_lock_reader();
 	perf_begin(param_get_perf);
 
@@ -686,6 +819,47 @@ param_control_autosave(bool enable)
 #endif /* PARAM_NO_AUTOSAVE */
 }
 
+#ifndef PARAM_NO_AUTOSAVE
+/**
+ * worker callback method to publish the deferred parameter_update
+ * @param arg unused
+ */
+static void
+notify_worker(void *arg)
+{
+	param_lock_writer();
+	notify_scheduled = false;
+	param_unlock_writer();
+
+	_param_notify_changes();
+}
+#endif /* PARAM_NO_AUTOSAVE */
+
+/**
+ * Schedule a parameter_update notification, so that all changes within a short time
+ * (e.g. a parameter sync from the ground station or a parameter import) result in a
+ * single notification instead of one per parameter.
+ *
+ * This needs to be called with the writer lock held.
+ *
+ * @return true if the notification is scheduled, false if the caller needs to notify immediately
+ */
+static bool
+param_schedule_notify(void)
+{
+#ifndef PARAM_NO_AUTOSAVE
+
+	if (!notify_scheduled) {
+		notify_scheduled = true;
+		work_queue(LPWORK, &notify_work, (worker_t)&notify_worker, NULL, USEC2TICK(PARAM_NOTIFY_DELAY_US));
+	}
+
+	return true;
+#else
+	return false;
+#endif /* PARAM_NO_AUTOSAVE */
+}
+
 static int
 param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_changes)
 {
@@ -767,6 +941,19 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 		s->unsaved = !mark_saved;
 		result = 0;
 
+		if (params_changed) {
+			param_mark_changed(param);
+
+			if (notify_changes && param_schedule_notify()) {
+				notify_changes = false;
+			}
+		}
+
+		if (param_current_values != NULL &&
+		    (param_type(param) == PARAM_TYPE_INT32 || param_type(param) == PARAM_TYPE_FLOAT)) {
+			param_current_values[param].i = s->val.i;
+		}
+
 		if (!mark_saved) { // this is false when importing parameters
 			param_autosave();
 		}
@@ -777,8 +964,8 @@ out:
 	param_unlock_writer();
 
 	/*
-	 * If we set something, now that we have unlocked, go ahead and advertise that
-	 * a thing has been set.
+	 * If we set something and the notification could not be deferred, now that we
+	 * have unlocked, go ahead and advertise that a thing has been set.
 	 */
 	if (params_changed && notify_changes) {
 		_param_notify_changes();
@@ -837,8 +1024,8 @@ void param_set_used_internal(param_t param)
 		(1 << param_index % bits_per_allocation_unit);
 }
 
-int
-param_reset(param_t param)
+static int
+param_reset_internal(param_t param, bool auto_save)
 {
 	struct param_wbuf_s *s = NULL;
 	bool param_found = false;
@@ -854,21 +1041,38 @@ param_reset(param_t param)
 		if (s != NULL) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+
+			if (param_current_values != NULL) {
+				param_current_values[param].i = param_info_base[param].val.i;
+			}
+
+			param_mark_changed(param);
 		}
 
 		param_found = true;
 	}
 
-	param_autosave();
+	if (auto_save) {
+		param_autosave();
+	}
+
+	bool notify = (s != NULL) && !param_schedule_notify();
 
 	param_unlock_writer();
 
-	if (s != NULL) {
+	if (notify) {
 		_param_notify_changes();
 	}
 
 	return (!param_found);
 }
+
+int
+param_reset(param_t param)
+{
+	return param_reset_internal(param, true);
+}
+
 static void
 param_reset_all_internal(bool auto_save)
 {
@@ -881,13 +1085,25 @@ param_reset_all_internal(bool auto_save)
 	/* mark as reset / deleted */
 	param_values = NULL;
 
+	for (param_t param = 0; handle_in_range(param); param++) {
+		if (param_current_values != NULL) {
+			param_current_values[param].i = param_info_base[param].val.i;
+		}
+
+		param_mark_changed(param);
+	}
+
 	if (auto_save) {
 		param_autosave();
 	}
 
+	bool notify = !param_schedule_notify();
+
 	param_unlock_writer();
 
-	_param_notify_changes();
+	if (notify) {
+		_param_notify_changes();
+	}
 }
 
 void
@@ -938,6 +1154,11 @@ param_set_default_file(const char *filename)
 		param_user_file = strdup(filename);
 	}
 
+#if !defined(FLASH_BASED_PARAMS)
+	/* the journal belongs to the previous file */
+	param_journal_offset = -1;
+#endif
+
 	return 0;
 }
 
@@ -947,6 +1168,267 @@ param_get_default_file(void)
 	return (param_user_file != NULL) ? param_user_file : param_default_file;
 }
 
+#if !defined(FLASH_BASED_PARAMS)
+static bool
+param_journal_is_pending(param_t param)
+{
+	return param_journal_pending[param / 8] & (1 << (param % 8));
+}
+
+/** forget the pending changes, the caller needs to hold a lock that excludes param_mark_changed() */
+static void
+param_journal_clear_pending(void)
+{
+	if (param_journal_pending != NULL) {
+		memset(param_journal_pending, 0, get_param_info_count() / 8 + 1);
+	}
+}
+
+static uint32_t
+param_journal_crc(const struct param_journal_record_s *record)
+{
+	return crc32part((const uint8_t *)record, offsetof(struct param_journal_record_s, crc), param_journal_seed);
+}
+
+/**
+ * Compute the crc32 of the BSON document at the start of the file.
+ *
+ * @return 0 on success
+ */
+static int
+param_journal_document_crc(int fd, off_t size, uint32_t *crc)
+{
+	uint8_t buf[64];
+
+	*crc = 0;
+
+	if (lseek(fd, 0, SEEK_SET) != 0) {
+		return -1;
+	}
+
+	while (size > 0) {
+		const size_t n = (size > (off_t)sizeof(buf)) ? sizeof(buf) : (size_t)size;
+
+		if (read(fd, buf, n) != (ssize_t)n) {
+			return -1;
+		}
+
+		*crc = crc32part(buf, n, *crc);
+		size -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * Flush the file to storage. Character devices such as /fs/mtd_params write through
+ * and may not implement fsync, like tinybson this does not count as a failure.
+ *
+ * @return 0 on success
+ */
+static int
+param_journal_sync(int fd)
+{
+	if (fsync(fd) != 0 && errno != EINVAL && errno != ENOTSUP && errno != ENOSYS) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Write an invalid record at offset, which ends the journal there.
+ *
+ * @return 0 on success
+ */
+static int
+param_journal_terminate(int fd, off_t offset)
+{
+	struct param_journal_record_s record;
+	memset(&record, 0, sizeof(record));
+
+	if (lseek(fd, offset, SEEK_SET) != offset ||
+	    write(fd, &record, sizeof(record)) != sizeof(record)) {
+		return -1;
+	}
+
+	return param_journal_sync(fd);
+}
+
+/**
+ * Apply the journal records that follow the BSON document. The file position must be
+ * at the end of the document, replay stops at the first invalid record.
+ */
+static void
+param_journal_replay(int fd)
+{
+	struct param_journal_record_s record;
+	char name[PARAM_JOURNAL_NAME_LEN + 1];
+	unsigned records = 0;
+	off_t offset = lseek(fd, 0, SEEK_CUR);
+
+	if (offset < 0 || param_journal_document_crc(fd, offset, &param_journal_seed) != 0) {
+		param_journal_offset = -1;
+		return;
+	}
+
+	while (read(fd, &record, sizeof(record)) == sizeof(record) &&
+	       record.magic == PARAM_JOURNAL_MAGIC &&
+	       record.crc == param_journal_crc(&record)) {
+
+		memcpy(name, record.name, PARAM_JOURNAL_NAME_LEN);
+		name[PARAM_JOURNAL_NAME_LEN] = '\0';
+
+		param_t param = param_find_no_notification(name);
+
+		if (param == PARAM_INVALID) {
+			debug("ignoring unrecognised parameter '%s'", name);
+
+		} else if (record.flags & PARAM_JOURNAL_FLAG_DEFAULT) {
+			param_reset_internal(param, false);
+
+		} else if (param_type(param) != record.type) {
+			PX4_WARN("unexpected type for %s", name);
+
+		} else {
+			param_set_internal(param, &record.val, true, true);
+		}
+
+		offset += sizeof(record);
+		records++;
+	}
+
+	param_journal_offset = offset;
+	param_journal_records = records;
+}
+
+/**
+ * Append the parameters changed since the last save to the journal of the default file.
+ *
+ * Before the new records are written, the journal is terminated behind them, so that
+ * records of an earlier, longer journal can never be replayed: an interrupted append
+ * loses at most the changes of this save.
+ *
+ * @return 0 on success, -1 if the file needs to be rewritten instead
+ */
+static int
+param_journal_append(const char *filename)
+{
+	int result = -1;
+
+	if (param_journal_offset < 0 || param_journal_pending == NULL) {
+		return -1;
+	}
+
+	int fd = PARAM_OPEN(filename, O_WRONLY);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	int shutdown_lock_ret = px4_shutdown_lock();
+
+	if (shutdown_lock_ret) {
+		PX4_ERR("px4_shutdown_lock() failed (%i)", shutdown_lock_ret);
+	}
+
+	// take the file lock
+	do {} while (px4_sem_wait(&param_sem_save) != 0);
+
+	// the reader lock keeps param_mark_changed() out until the pending changes are cleared
+	param_lock_reader();
+
+	unsigned count = 0;
+
+	for (param_t param = 0; handle_in_range(param); param++) {
+		if (param_journal_is_pending(param)) {
+			if (param_type(param) != PARAM_TYPE_INT32 && param_type(param) != PARAM_TYPE_FLOAT) {
+				// struct parameters do not fit into a record
+				goto out;
+			}
+
+			count++;
+		}
+	}
+
+	if (count == 0) {
+		result = 0;
+		goto out;
+	}
+
+	if (param_journal_records + count > PARAM_JOURNAL_MAX_RECORDS) {
+		goto out;
+	}
+
+	/* make sure the file has not been replaced or truncated since it was written */
+	if (lseek(fd, 0, SEEK_END) < param_journal_offset) {
+		goto out;
+	}
+
+	const off_t end = param_journal_offset + count * sizeof(struct param_journal_record_s);
+
+	if (param_journal_terminate(fd, end) != 0 ||
+	    lseek(fd, param_journal_offset, SEEK_SET) != param_journal_offset) {
+		goto out;
+	}
+
+	for (param_t param = 0; handle_in_range(param); param++) {
+		if (!param_journal_is_pending(param)) {
+			continue;
+		}
+
+		struct param_journal_record_s record;
+		memset(&record, 0, sizeof(record));
+		record.magic = PARAM_JOURNAL_MAGIC;
+		record.type = param_type(param);
+		strncpy(record.name, param_name(param), PARAM_JOURNAL_NAME_LEN);
+
+		struct param_wbuf_s *s = param_find_changed(param);
+
+		if (s != NULL) {
+			record.val = s->val.i;
+			s->unsaved = false;
+
+		} else {
+			record.flags = PARAM_JOURNAL_FLAG_DEFAULT;
+		}
+
+		record.crc = param_journal_crc(&record);
+
+		if (write(fd, &record, sizeof(record)) != sizeof(record)) {
+			goto out;
+		}
+	}
+
+	if (param_journal_sync(fd) != 0) {
+		goto out;
+	}
+
+	param_journal_clear_pending();
+	param_journal_offset = end;
+	param_journal_records += count;
+	result = 0;
+
+out:
+
+	if (result != 0) {
+		param_journal_offset = -1;
+	}
+
+	param_unlock_reader();
+
+	px4_sem_post(&param_sem_save);
+
+	if (shutdown_lock_ret == 0) {
+		px4_shutdown_unlock();
+	}
+
+	PARAM_CLOSE(fd);
+
+	return result;
+}
+#endif /* !FLASH_BASED_PARAMS */
+
 int
 param_save_default(void)
 {
@@ -955,8 +1437,17 @@ param_save_default(void)
 
 	const char *filename = param_get_default_file();
 
-	/* write parameters to temp file */
-	int fd = PARAM_OPEN(filename, O_WRONLY | O_CREAT, PX4_O_MODE_666);
+	/* append only the changes if the journal allows it */
+	if (param_journal_append(filename) == 0) {
+		return PX4_OK;
+	}
+
+	/* otherwise rewrite (compact) the whole file, which includes all pending changes */
+	param_lock_writer();
+	param_journal_clear_pending();
+	param_unlock_writer();
+
+	int fd = PARAM_OPEN(filename, O_RDWR | O_CREAT, PX4_O_MODE_666);
 
 	if (fd < 0) {
 		PX4_ERR("failed to open param file: %s", filename);
@@ -977,6 +1468,16 @@ param_save_default(void)
 
 	if (res != OK) {
 		PX4_ERR("failed to write parameters to file: %s", filename);
+
+	} else {
+		/* start an empty journal right after the document */
+		off_t offset = lseek(fd, 0, SEEK_CUR);
+
+		if (offset >= 0 && param_journal_document_crc(fd, offset, &param_journal_seed) == 0 &&
+		    param_journal_terminate(fd, offset) == 0) {
+			param_journal_offset = offset;
+			param_journal_records = 0;
+		}
 	}
 
 	PARAM_CLOSE(fd);
@@ -1009,7 +1510,19 @@ param_load_default(void)
 		return 1;
 	}
 
+	param_journal_offset = -1;
+
 	int result = param_load(fd_load);
+
+	if (result == 0) {
+		param_journal_replay(fd_load);
+
+		/* everything loaded is in the file already */
+		param_lock_writer();
+		param_journal_clear_pending();
+		param_unlock_writer();
+	}
+
 	PARAM_CLOSE(fd_load);
 
 	if (result != 0) {
@@ -216,6 +216,19 @@ __EXPORT bool		param_value_is_default(param_t param);
  */
 __EXPORT bool		param_value_unsaved(param_t param);
 
+/**
+ * Test whether a parameter's value has changed after a parameter_update notification.
+ *
+ * Every change is tagged with the instance of the parameter_update that announces it,
+ * so a module can refresh only the parameters that changed since the last parameter_update
+ * it has processed.
+ *
+ * @param param		A handle returned by param_find or passed by param_foreach.
+ * @param instance	The instance of the last parameter_update the caller has processed.
+ * @return		If true, the parameter's value changed after that notification.
+ */
+__EXPORT bool		param_changed_since(param_t param, uint32_t instance);
+
 /**
  * Obtain the type of a parameter.
  *
@@ -245,6 +258,9 @@ __EXPORT int		param_get(param_t param, void *val);
 /**
  * Set the value of a parameter.
  *
+ * The parameter_update notification is deferred for a short time, so that multiple changes
+ * (e.g. during a parameter sync or load) are announced with a single notification.
+ *
  * @param param		A handle returned by param_find or passed by param_foreach.
  * @param val		The value to set; assumed to point to a variable of the parameter type.
  *			For structures, the pointer is assumed to point to a structure to be copied.
@@ -265,6 +281,7 @@ __EXPORT int		param_set_no_notification(param_t param, const void *val);
 /**
  * Notify the system about parameter changes. Can be used for example after several calls to
  * param_set_no_notification() to avoid unnecessary system notifications.
+ * The notification is published immediately.
  */
 __EXPORT void		param_notify_changes(void);
 
@@ -368,7 +385,10 @@ __EXPORT const char	*param_get_default_file(void);
  * Save parameters to the default file.
  * Note: this method requires a large amount of stack size!
  *
- * This function saves all parameters with non-default values.
+ * This function saves all parameters with non-default values. Parameters changed
+ * since the last save are appended to a journal after the BSON document, and the
+ * whole file is only rewritten when the journal gets too long (or cannot be used,
+ * e.g. for struct parameters or after a reset of all parameters).
  *
  * @return		Zero on success.
  */
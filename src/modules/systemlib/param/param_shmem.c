@@ -470,6 +470,13 @@ param_value_unsaved(param_t param)
 	return ret;
 }
 
+bool
+param_changed_since(param_t param, uint32_t instance)
+{
+	/* changes are not tracked per parameter here, report every parameter as changed */
+	return handle_in_range(param);
+}
+
 param_type_t
 param_type(param_t param)
 {
@@ -9,6 +9,62 @@ import argparse
 from jinja2 import Environment, FileSystemLoader
 import os
 
+def name_hash(name, seed):
+    """
+    32 bit FNV-1a hash of a parameter name, with the offset basis varied
+    by seed and a final avalanche step, so that the low bits are usable.
+    Must match param_name_hash() in param.c.
+    """
+    h = (2166136261 ^ seed) & 0xffffffff
+    for c in bytearray(name.encode('ascii')):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xffffffff
+    h ^= h >> 16
+    return h
+
+def generate_perfect_hash(names):
+    """
+    Build a perfect hash over the (sorted) parameter names, using hash and
+    displace: the names are split into buckets by name_hash(name, 0), and for
+    each bucket a seed is searched, which moves all names of the bucket to
+    free slots with name_hash(name, seed). The table starts out minimal and is
+    only grown if no seeds are found.
+
+    @return: (seed per bucket, parameter index per slot, 0xffff if unused)
+    """
+    num_buckets = max((len(names) + 3) // 4, 1)
+    buckets = [[] for _ in range(num_buckets)]
+    for index, name in enumerate(names):
+        buckets[name_hash(name, 0) % num_buckets].append(index)
+
+    # place the largest buckets first, while most slots are still free
+    order = sorted(range(num_buckets), key=lambda b: -len(buckets[b]))
+
+    num_slots = max(len(names), 1)
+    while True:
+        seeds = [0] * num_buckets
+        slots = [0xffff] * num_slots
+        for bucket in order:
+            if not buckets[bucket]:
+                continue
+            for seed in range(1, 0x10000):
+                positions = [name_hash(names[i], seed) % num_slots for i in buckets[bucket]]
+                if len(set(positions)) == len(positions) and \
+                        all(slots[pos] == 0xffff for pos in positions):
+                    break
+            else:
+                break
+            seeds[bucket] = seed
+            for index, pos in zip(buckets[bucket], positions):
+                slots[pos] = index
+        else:
+            return seeds, slots
+        num_slots += num_slots // 16 + 1
+
 def generate(xml_file, dest='.'):
     """
     Generate px4 param source from xml.
@@ -29,6 +85,8 @@ def generate(xml_file, dest='.'):
 
     params = sorted(params, key=lambda name: name.attrib["name"])
 
+    hash_seeds, hash_slots = generate_perfect_hash([param.attrib["name"] for param in params])
+
     script_path = os.path.dirname(os.path.realpath(__file__))
 
     # for jinja docs see: http://jinja.pocoo.org/docs/2.9/api/
@@ -46,7 +104,8 @@ def generate(xml_file, dest='.'):
         template = env.get_template(template_file)
         with open(os.path.join(
                 dest, template_file.replace('.jinja','')), 'w') as fid:
-            fid.write(template.render(params=params))
+            fid.write(template.render(params=params, hash_seeds=hash_seeds,
+                                      hash_slots=hash_slots))
 
 if __name__ == "__main__":
     arg_parser = argparse.ArgumentParser()
@@ -39,11 +39,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 #include <sys/queue.h>
 #include <drivers/drv_hrt.h>
 #include <math.h>
 #include <pthread.h>
+#include <px4_trace.h>
 #include <systemlib/err.h>
 
 #include "perf_counter.h"
@@ -100,6 +102,44 @@ struct perf_ctr_interval {
 	float			M2;
 };
 
+/**
+ * PC_ELAPSED_HIST histogram layout: values below 4us have their own bucket,
+ * above that every power of two is split into 4 buckets, up to 2^21us (~2s).
+ */
+#define PERF_HIST_SUB_BITS	2
+#define PERF_HIST_SUB_BUCKETS	(1 << PERF_HIST_SUB_BITS)
+#define PERF_HIST_MAX_EXP	21
+#define PERF_HIST_BUCKETS	((PERF_HIST_MAX_EXP - PERF_HIST_SUB_BITS + 1) * PERF_HIST_SUB_BUCKETS + 1)
+
+#ifdef __PX4_NUTTX
+// counters are also updated from interrupt context, where the current thread is meaningless
+#define PERF_HIST_SHARDS	1
+#else
+#define PERF_HIST_SHARDS	4
+#endif
+
+/**
+ * Per-thread part of a PC_ELAPSED_HIST counter. Each shard has a single
+ * writer, so updates need no locking; readers merge all shards.
+ */
+struct perf_ctr_hist_shard {
+	uintptr_t		owner;	/**< thread writing this shard, 0 if unclaimed */
+	uint64_t		time_start;
+	uint64_t		event_count;
+	uint64_t		time_total;
+	uint32_t		time_least;
+	uint32_t		time_most;
+	uint32_t		buckets[PERF_HIST_BUCKETS];
+};
+
+/**
+ * PC_ELAPSED_HIST counter.
+ */
+struct perf_ctr_hist {
+	struct perf_ctr_header	hdr;
+	struct perf_ctr_hist_shard shards[PERF_HIST_SHARDS];
+};
+
 /**
  * List of all known counters.
  */
@@ -136,6 +176,10 @@ perf_alloc(enum perf_counter_type type, const char *name)
 
 		break;
 
+	case PC_ELAPSED_HIST:
+		ctr = (perf_counter_t)calloc(sizeof(struct perf_ctr_hist), 1);
+		break;
+
 	default:
 		break;
 	}
@@ -151,6 +195,131 @@ perf_alloc(enum perf_counter_type type, const char *name)
 	return ctr;
 }
 
+static unsigned
+perf_hist_bucket(uint32_t elapsed)
+{
+	if (elapsed < PERF_HIST_SUB_BUCKETS) {
+		return elapsed;
+	}
+
+	if (elapsed >= (1u << PERF_HIST_MAX_EXP)) {
+		return PERF_HIST_BUCKETS - 1;
+	}
+
+	unsigned exp = 31 - __builtin_clz(elapsed);
+	unsigned sub = (elapsed >> (exp - PERF_HIST_SUB_BITS)) & (PERF_HIST_SUB_BUCKETS - 1);
+	return (exp - PERF_HIST_SUB_BITS + 1) * PERF_HIST_SUB_BUCKETS + sub;
+}
+
+/* the largest value that falls into a bucket */
+static uint32_t
+perf_hist_bucket_max(unsigned bucket)
+{
+	if (bucket < PERF_HIST_SUB_BUCKETS) {
+		return bucket;
+	}
+
+	if (bucket >= PERF_HIST_BUCKETS - 1) {
+		return UINT32_MAX;
+	}
+
+	unsigned exp = bucket / PERF_HIST_SUB_BUCKETS + PERF_HIST_SUB_BITS - 1;
+	unsigned sub = bucket % PERF_HIST_SUB_BUCKETS;
+	return ((PERF_HIST_SUB_BUCKETS + sub + 1) << (exp - PERF_HIST_SUB_BITS)) - 1;
+}
+
+/* the shard of the calling thread, claiming a free one on first use */
+static struct perf_ctr_hist_shard *
+perf_hist_shard(struct perf_ctr_hist *pch)
+{
+#if PERF_HIST_SHARDS > 1
+	uintptr_t self = (uintptr_t)pthread_self();
+
+	for (int i = 0; i < PERF_HIST_SHARDS; i++) {
+		uintptr_t owner = __atomic_load_n(&pch->shards[i].owner, __ATOMIC_ACQUIRE);
+
+		if (owner == 0 && __atomic_compare_exchange_n(&pch->shards[i].owner, &owner, self, false,
+				__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			return &pch->shards[i];
+		}
+
+		if (owner == self) {
+			return &pch->shards[i];
+		}
+	}
+
+	// more writers than shards: they share the last one, without the single writer guarantee
+	return &pch->shards[PERF_HIST_SHARDS - 1];
+#else
+	return &pch->shards[0];
+#endif
+}
+
+static void
+perf_hist_record(struct perf_ctr_hist_shard *shard, uint32_t elapsed)
+{
+	shard->event_count++;
+	shard->time_total += elapsed;
+
+	if ((shard->time_least > elapsed) || (shard->time_least == 0)) {
+		shard->time_least = elapsed;
+	}
+
+	if (shard->time_most < elapsed) {
+		shard->time_most = elapsed;
+	}
+
+	shard->buckets[perf_hist_bucket(elapsed)]++;
+}
+
+/* merge the shards into totals, percentiles must be sorted in ascending order */
+static void
+perf_hist_summary(const struct perf_ctr_hist *pch, uint64_t *event_count, uint64_t *time_total,
+		  uint32_t *time_least, uint32_t *time_most, const float *percentiles, uint32_t *values, int num_percentiles)
+{
+	*event_count = 0;
+	*time_total = 0;
+	*time_least = 0;
+	*time_most = 0;
+
+	for (int i = 0; i < PERF_HIST_SHARDS; i++) {
+		const struct perf_ctr_hist_shard *shard = &pch->shards[i];
+
+		if (shard->event_count == 0) {
+			continue;
+		}
+
+		*event_count += shard->event_count;
+		*time_total += shard->time_total;
+
+		if (*time_least == 0 || shard->time_least < *time_least) {
+			*time_least = shard->time_least;
+		}
+
+		if (shard->time_most > *time_most) {
+			*time_most = shard->time_most;
+		}
+	}
+
+	int p = 0;
+	uint64_t cumulative = 0;
+
+	for (unsigned bucket = 0; bucket < PERF_HIST_BUCKETS && p < num_percentiles; bucket++) {
+		for (int i = 0; i < PERF_HIST_SHARDS; i++) {
+			cumulative += pch->shards[i].buckets[bucket];
+		}
+
+		while (p < num_percentiles && *event_count > 0 && cumulative >= percentiles[p] * *event_count) {
+			uint32_t value = perf_hist_bucket_max(bucket);
+			values[p++] = value < *time_most ? value : *time_most;
+		}
+	}
+
+	while (p < num_percentiles) {
+		values[p++] = *time_most;
+	}
+}
+
 perf_counter_t
 perf_alloc_once(enum perf_counter_type type, const char *name)
 {
@@ -264,6 +433,10 @@ perf_begin(perf_counter_t handle)
 		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
 		break;
 
+	case PC_ELAPSED_HIST:
+		perf_hist_shard((struct perf_ctr_hist *)handle)->time_start = hrt_absolute_time();
+		break;
+
 	default:
 		break;
 	}
@@ -284,6 +457,7 @@ perf_end(perf_counter_t handle)
 				int64_t elapsed = hrt_absolute_time() - pce->time_start;
 
 				if (elapsed >= 0) {
+					px4_trace_duration(PX4_TRACE_PERF, handle->name, pce->time_start, (uint32_t)elapsed);
 
 					pce->event_count++;
 					pce->time_total += elapsed;
@@ -309,6 +483,21 @@ perf_end(perf_counter_t handle)
 		}
 		break;
 
+	case PC_ELAPSED_HIST: {
+			struct perf_ctr_hist_shard *shard = perf_hist_shard((struct perf_ctr_hist *)handle);
+
+			if (shard->time_start != 0) {
+				int64_t elapsed = hrt_absolute_time() - shard->time_start;
+
+				if (elapsed >= 0) {
+					px4_trace_duration(PX4_TRACE_PERF, handle->name, shard->time_start, (uint32_t)elapsed);
+					perf_hist_record(shard, (uint32_t)elapsed);
+					shard->time_start = 0;
+				}
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -350,6 +539,15 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 		}
 		break;
 
+	case PC_ELAPSED_HIST:
+		if (elapsed >= 0) {
+			struct perf_ctr_hist_shard *shard = perf_hist_shard((struct perf_ctr_hist *)handle);
+			perf_hist_record(shard, (uint32_t)elapsed);
+			shard->time_start = 0;
+		}
+
+		break;
+
 	default:
 		break;
 	}
@@ -389,6 +587,10 @@ perf_cancel(perf_counter_t handle)
 		}
 		break;
 
+	case PC_ELAPSED_HIST:
+		perf_hist_shard((struct perf_ctr_hist *)handle)->time_start = 0;
+		break;
+
 	default:
 		break;
 	}
@@ -428,6 +630,23 @@ perf_reset(perf_counter_t handle)
 			pci->time_most = 0;
 			break;
 		}
+
+	case PC_ELAPSED_HIST: {
+			struct perf_ctr_hist *pch = (struct perf_ctr_hist *)handle;
+
+			for (int i = 0; i < PERF_HIST_SHARDS; i++) {
+				// keep the owner, the shard stays assigned to its thread
+				struct perf_ctr_hist_shard *shard = &pch->shards[i];
+				shard->time_start = 0;
+				shard->event_count = 0;
+				shard->time_total = 0;
+				shard->time_least = 0;
+				shard->time_most = 0;
+				memset(shard->buckets, 0, sizeof(shard->buckets));
+			}
+
+			break;
+		}
 	}
 }
 
@@ -483,6 +702,24 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			break;
 		}
 
+	case PC_ELAPSED_HIST: {
+			static const float percentiles[] = {0.5f, 0.99f, 0.999f};
+			uint64_t event_count, time_total;
+			uint32_t time_least, time_most, values[3];
+			perf_hist_summary((struct perf_ctr_hist *)handle, &event_count, &time_total, &time_least, &time_most,
+					  percentiles, values, 3);
+
+			dprintf(fd, "%s: %llu events, %lluus elapsed, %lluus avg, min %lluus max %lluus p50 %uus p99 %uus p99.9 %uus\n",
+				handle->name,
+				(unsigned long long)event_count,
+				(unsigned long long)time_total,
+				(event_count == 0) ? 0 : (unsigned long long)time_total / event_count,
+				(unsigned long long)time_least,
+				(unsigned long long)time_most,
+				(unsigned)values[0], (unsigned)values[1], (unsigned)values[2]);
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -533,6 +770,25 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 			break;
 		}
 
+	case PC_ELAPSED_HIST: {
+			static const float percentiles[] = {0.5f, 0.99f, 0.999f};
+			uint64_t event_count, time_total;
+			uint32_t time_least, time_most, values[3];
+			perf_hist_summary((struct perf_ctr_hist *)handle, &event_count, &time_total, &time_least, &time_most,
+					  percentiles, values, 3);
+
+			num_written = snprintf(buffer, length,
+					       "%s: %llu events, %lluus elapsed, %lluus avg, min %lluus max %lluus p50 %uus p99 %uus p99.9 %uus",
+					       handle->name,
+					       (unsigned long long)event_count,
+					       (unsigned long long)time_total,
+					       (event_count == 0) ? 0 : (unsigned long long)time_total / event_count,
+					       (unsigned long long)time_least,
+					       (unsigned long long)time_most,
+					       (unsigned)values[0], (unsigned)values[1], (unsigned)values[2]);
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -562,6 +818,17 @@ perf_event_count(perf_counter_t handle)
 			return pci->event_count;
 		}
 
+	case PC_ELAPSED_HIST: {
+			struct perf_ctr_hist *pch = (struct perf_ctr_hist *)handle;
+			uint64_t event_count = 0;
+
+			for (int i = 0; i < PERF_HIST_SHARDS; i++) {
+				event_count += pch->shards[i].event_count;
+			}
+
+			return event_count;
+		}
+
 	default:
 		break;
 	}
@@ -569,6 +836,20 @@ perf_event_count(perf_counter_t handle)
 	return 0;
 }
 
+uint32_t
+perf_percentile(perf_counter_t handle, float percentile)
+{
+	if (handle == NULL || handle->type != PC_ELAPSED_HIST) {
+		return 0;
+	}
+
+	uint64_t event_count, time_total;
+	uint32_t time_least, time_most, value;
+	perf_hist_summary((struct perf_ctr_hist *)handle, &event_count, &time_total, &time_least, &time_most,
+			  &percentile, &value, 1);
+	return value;
+}
+
 void
 perf_iterate_all(perf_callback cb, void *user)
 {
@@ -613,6 +894,34 @@ perf_print_latency(int fd)
 
 	// print the overflow bucket value
 	dprintf(fd, " >%4i : %i\n", latency_buckets[latency_bucket_count - 1], latency_counters[latency_bucket_count]);
+
+	// tail latencies of the counters that keep a histogram
+	static const float percentiles[] = {0.5f, 0.9f, 0.99f, 0.999f};
+	bool header = false;
+
+	pthread_mutex_lock(&perf_counters_mutex);
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != NULL) {
+		if (handle->type == PC_ELAPSED_HIST) {
+			uint64_t event_count, time_total;
+			uint32_t time_least, time_most, values[4];
+			perf_hist_summary((struct perf_ctr_hist *)handle, &event_count, &time_total, &time_least, &time_most,
+					  percentiles, values, 4);
+
+			if (!header) {
+				dprintf(fd, "\n%-20s %10s %8s %8s %8s %8s %8s\n", "counter [us]", "events", "p50", "p90", "p99", "p99.9", "max");
+				header = true;
+			}
+
+			dprintf(fd, "%-20s %10llu %8u %8u %8u %8u %8u\n", handle->name, (unsigned long long)event_count,
+				(unsigned)values[0], (unsigned)values[1], (unsigned)values[2], (unsigned)values[3], (unsigned)time_most);
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
+
+	pthread_mutex_unlock(&perf_counters_mutex);
 }
 
 void
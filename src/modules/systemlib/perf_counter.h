@@ -48,7 +48,9 @@
 enum perf_counter_type {
 	PC_COUNT,		/**< count the number of times an event occurs */
 	PC_ELAPSED,		/**< measure the time elapsed performing an event */
-	PC_INTERVAL		/**< measure the interval between instances of an event */
+	PC_INTERVAL,		/**< measure the interval between instances of an event */
+	PC_ELAPSED_HIST		/**< PC_ELAPSED with a latency histogram for percentiles; perf_begin and perf_end
+				     must be called from the same thread */
 };
 
 struct perf_ctr_header;
@@ -203,12 +205,24 @@ typedef void (*perf_callback)(perf_counter_t handle, void *user);
 __EXPORT extern void	perf_iterate_all(perf_callback cb, void *user);
 
 /**
- * Print hrt latency counters.
+ * Print hrt latency counters and the percentiles of all histogram counters.
  *
  * @param fd			File descriptor to print to - e.g. 0 for stdout
  */
 __EXPORT extern void		perf_print_latency(int fd);
 
+/**
+ * Return a percentile of the elapsed time of a PC_ELAPSED_HIST counter.
+ *
+ * The histogram buckets are log-linear with 4 buckets per power of two, so the
+ * result is an upper bound within 25% of the actual value.
+ *
+ * @param handle		The counter returned from perf_alloc.
+ * @param percentile		The percentile in [0, 1], e.g. 0.99
+ * @return			The elapsed time in us, 0 if there are no events or the counter has no histogram
+ */
+__EXPORT extern uint32_t	perf_percentile(perf_counter_t handle, float percentile);
+
 /**
  * Reset all of the performance counters.
  */
@@ -54,6 +54,12 @@
 #include <mach/mach.h>
 #endif
 
+#ifdef __PX4_LINUX
+#include <dirent.h>
+#include <sched.h>
+#include <stdlib.h>
+#endif
+
 #ifdef __PX4_QURT
 // dprintf is not available on QURT. Use the usual output to mini-dm.
 #define dprintf(_fd, _text, ...) ((_fd) == 1 ? PX4_INFO((_text), ##__VA_ARGS__) : (void)(_fd))
@@ -79,8 +85,274 @@ void init_print_load_s(uint64_t t, struct print_load_s *s)
 	}
 
 	s->interval_time_ms_inv = 0.f;
+
+#if defined(__PX4_LINUX)
+
+	for (int i = 0; i < PRINT_LOAD_MAX_THREADS; i++) {
+		s->last_tids[i] = 0;
+		s->last_thread_ticks[i] = 0;
+		s->last_migrations[i] = -1;
+	}
+
+	for (int i = 0; i < PRINT_LOAD_MAX_CPUS; i++) {
+		s->last_cpu_busy[i] = 0;
+		s->last_cpu_total[i] = 0;
+	}
+
+	s->last_total_ticks = 0;
+#endif
+}
+
+#if defined(__PX4_LINUX)
+
+/* per-thread numbers from /proc/self/task/<tid>/stat, see proc(5) */
+struct thread_stat_s {
+	char name[17];
+	char state;
+	uint64_t ticks;
+	int processor;
+	int rt_priority;
+	int policy;
+};
+
+static bool read_thread_stat(const char *tid, struct thread_stat_s *stat)
+{
+	char path[64];
+	char line[512];
+	snprintf(path, sizeof(path), "/proc/self/task/%s/stat", tid);
+	FILE *f = fopen(path, "r");
+
+	if (f == NULL) {
+		return false;
+	}
+
+	char *ret = fgets(line, sizeof(line), f);
+	fclose(f);
+
+	/* the name is in parentheses and may itself contain spaces or parentheses */
+	char *name_start = ret ? strchr(line, '(') : NULL;
+	char *name_end = ret ? strrchr(line, ')') : NULL;
+
+	if (name_start == NULL || name_end == NULL || name_end < name_start) {
+		return false;
+	}
+
+	size_t name_len = name_end - name_start - 1;
+
+	if (name_len >= sizeof(stat->name)) {
+		name_len = sizeof(stat->name) - 1;
+	}
+
+	memcpy(stat->name, name_start + 1, name_len);
+	stat->name[name_len] = '\0';
+
+	/* fields after the name start with the state, which is field 3 */
+	uint64_t utime = 0, stime = 0;
+	int field = 3;
+	char *save;
+
+	for (char *tok = strtok_r(name_end + 1, " ", &save); tok != NULL; tok = strtok_r(NULL, " ", &save), field++) {
+		switch (field) {
+		case 3:
+			stat->state = tok[0];
+			break;
+
+		case 14:
+			utime = strtoull(tok, NULL, 10);
+			break;
+
+		case 15:
+			stime = strtoull(tok, NULL, 10);
+			break;
+
+		case 39:
+			stat->processor = atoi(tok);
+			break;
+
+		case 40:
+			stat->rt_priority = atoi(tok);
+			break;
+
+		case 41:
+			stat->policy = atoi(tok);
+			break;
+		}
+	}
+
+	stat->ticks = utime + stime;
+	return field > 41;
 }
 
+/* number of times the scheduler moved the thread to another core, -1 if the kernel does not tell */
+static int64_t read_thread_migrations(const char *tid)
+{
+	char path[64];
+	char line[128];
+	int64_t migrations = -1;
+	snprintf(path, sizeof(path), "/proc/self/task/%s/sched", tid);
+	FILE *f = fopen(path, "r");
+
+	if (f == NULL) {
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strncmp(line, "se.nr_migrations", 16) == 0) {
+			char *colon = strchr(line, ':');
+
+			if (colon != NULL) {
+				migrations = strtoll(colon + 1, NULL, 10);
+			}
+
+			break;
+		}
+	}
+
+	fclose(f);
+	return migrations;
+}
+
+static void print_load_linux(int fd, const char *clear_line, struct print_load_s *print_state)
+{
+	static const char *policies[] = {"OTHER", "FIFO", "RR", "BATCH", "ISO", "IDLE", "DEADL"};
+
+	/* per-core utilisation from /proc/stat */
+	FILE *f = fopen("/proc/stat", "r");
+	char line[256];
+	int num_cpus = 0;
+	uint64_t total_ticks = 0;
+
+	if (f == NULL) {
+		dprintf(fd, "%scannot read /proc/stat\n", clear_line);
+		return;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL && strncmp(line, "cpu", 3) == 0) {
+		unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+		int cpu = -1;
+
+		if (line[3] == ' ') {
+			sscanf(line + 3, "%llu %llu %llu %llu %llu %llu %llu %llu",
+			       &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+			total_ticks = user + nice + system + idle + iowait + irq + softirq + steal;
+			continue;
+		}
+
+		if (sscanf(line + 3, "%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu,
+			   &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) != 9 || cpu >= PRINT_LOAD_MAX_CPUS) {
+			continue;
+		}
+
+		uint64_t busy = user + nice + system + irq + softirq + steal;
+		uint64_t total = busy + idle + iowait;
+		uint64_t d_total = total - print_state->last_cpu_total[cpu];
+		float load = d_total > 0 ? 100.f * (busy - print_state->last_cpu_busy[cpu]) / d_total : 0.f;
+		print_state->last_cpu_busy[cpu] = busy;
+		print_state->last_cpu_total[cpu] = total;
+
+		dprintf(fd, "%sCPU%d: %5.1f%%%s", num_cpus % 4 == 0 ? clear_line : "", cpu, (double)load,
+			num_cpus % 4 == 3 ? "\n" : "   ");
+		num_cpus++;
+	}
+
+	fclose(f);
+
+	if (num_cpus % 4 != 0) {
+		dprintf(fd, "\n");
+	}
+
+	/* the aggregate line counts the ticks of all cores */
+	uint64_t interval_ticks = num_cpus > 0 ? (total_ticks - print_state->last_total_ticks) / num_cpus : 0;
+	print_state->last_total_ticks = total_ticks;
+
+	dprintf(fd, "%s\n%s%6s %-16s %6s %4s %8s %4s %5s %10s\n", clear_line, clear_line,
+		"TID", "COMMAND", "CPU(%)", "CORE", "AFFINITY", "PRIO", "POLICY", "MIGRATIONS");
+
+	int tids[PRINT_LOAD_MAX_THREADS];
+	uint64_t ticks[PRINT_LOAD_MAX_THREADS];
+	int64_t migrations[PRINT_LOAD_MAX_THREADS];
+	int num_threads = 0;
+
+	DIR *dir = opendir("/proc/self/task");
+	struct dirent *entry;
+
+	while (dir != NULL && (entry = readdir(dir)) != NULL) {
+		struct thread_stat_s stat = {};
+
+		if (entry->d_name[0] == '.' || !read_thread_stat(entry->d_name, &stat)) {
+			continue;
+		}
+
+		int tid = atoi(entry->d_name);
+		int64_t migr = read_thread_migrations(entry->d_name);
+
+		/* find the previous sample of this thread */
+		int prev = -1;
+
+		for (int i = 0; i < PRINT_LOAD_MAX_THREADS && print_state->last_tids[i] != 0; i++) {
+			if (print_state->last_tids[i] == tid) {
+				prev = i;
+				break;
+			}
+		}
+
+		char cpu_load[8] = "-";
+
+		if (prev >= 0 && interval_ticks > 0) {
+			snprintf(cpu_load, sizeof(cpu_load), "%.1f",
+				 (double)(100.f * (stat.ticks - print_state->last_thread_ticks[prev]) / interval_ticks));
+		}
+
+		char migr_str[48] = "-";
+
+		if (migr >= 0 && prev >= 0 && print_state->last_migrations[prev] >= 0) {
+			snprintf(migr_str, sizeof(migr_str), "%lld(+%lld)", (long long)migr,
+				 (long long)(migr - print_state->last_migrations[prev]));
+
+		} else if (migr >= 0) {
+			snprintf(migr_str, sizeof(migr_str), "%lld", (long long)migr);
+		}
+
+		cpu_set_t cpus;
+		unsigned long long affinity = 0;
+
+		if (sched_getaffinity(tid, sizeof(cpus), &cpus) == 0) {
+			for (int cpu = 0; cpu < 64; cpu++) {
+				if (CPU_ISSET(cpu, &cpus)) {
+					affinity |= 1ULL << cpu;
+				}
+			}
+		}
+
+		const char *policy = (stat.policy >= 0 && stat.policy < (int)(sizeof(policies) / sizeof(policies[0]))) ?
+				     policies[stat.policy] : "?";
+
+		dprintf(fd, "%s%6d %-16s %6s %4d %8llx %4d %5s %10s\n", clear_line, tid, stat.name, cpu_load,
+			stat.processor, affinity, stat.rt_priority, policy, migr_str);
+
+		if (num_threads < PRINT_LOAD_MAX_THREADS) {
+			tids[num_threads] = tid;
+			ticks[num_threads] = stat.ticks;
+			migrations[num_threads] = migr;
+			num_threads++;
+		}
+	}
+
+	if (dir != NULL) {
+		closedir(dir);
+	}
+
+	for (int i = 0; i < PRINT_LOAD_MAX_THREADS; i++) {
+		print_state->last_tids[i] = i < num_threads ? tids[i] : 0;
+		print_state->last_thread_ticks[i] = i < num_threads ? ticks[i] : 0;
+		print_state->last_migrations[i] = i < num_threads ? migrations[i] : -1;
+	}
+
+	dprintf(fd, "%s\n%sThreads: %d total\n", clear_line, clear_line, num_threads);
+}
+
+#endif
+
 void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 	char *clear_line = "";
@@ -91,8 +363,11 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 		clear_line = CL;
 	}
 
-#if defined(__PX4_LINUX) || defined(__PX4_CYGWIN) || defined(__PX4_QURT)
-	dprintf(fd, "%sTOP NOT IMPLEMENTED ON LINUX, QURT, WINDOWS (ONLY ON NUTTX, APPLE)\n", clear_line);
+#if defined(__PX4_LINUX)
+	print_load_linux(fd, clear_line, print_state);
+
+#elif defined(__PX4_CYGWIN) || defined(__PX4_QURT)
+	dprintf(fd, "%sTOP NOT IMPLEMENTED ON QURT, WINDOWS (ONLY ON NUTTX, LINUX, APPLE)\n", clear_line);
 
 #elif defined(__PX4_DARWIN)
 	pid_t pid = getpid();   //-- this is the process id you need info for
@@ -59,6 +59,18 @@ struct print_load_s {
 	uint64_t interval_start_time;
 	uint32_t last_times[CONFIG_MAX_TASKS]; // in [ms]. This wraps if a process needs more than 49 days of CPU
 	float interval_time_ms_inv;
+
+#if defined(__PX4_LINUX)
+#define PRINT_LOAD_MAX_THREADS 128
+#define PRINT_LOAD_MAX_CPUS 16
+	/* previous samples from /proc, to report the load over the last interval */
+	int last_tids[PRINT_LOAD_MAX_THREADS];
+	uint64_t last_thread_ticks[PRINT_LOAD_MAX_THREADS];
+	int64_t last_migrations[PRINT_LOAD_MAX_THREADS];
+	uint64_t last_cpu_busy[PRINT_LOAD_MAX_CPUS];
+	uint64_t last_cpu_total[PRINT_LOAD_MAX_CPUS];
+	uint64_t last_total_ticks;
+#endif
 };
 
 __BEGIN_DECLS
@@ -0,0 +1,387 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "uORBArena.hpp"
+#include "uORBTopics.h"
+
+#include <px4_log.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Buffers and subscriber blocks are aligned to a cache line where there is a data cache, so that
+ * writers on different cores or with different data do not share lines. Without one, the alignment
+ * of the largest field type is enough.
+ */
+#if defined(__PX4_NUTTX)
+#  if defined(CONFIG_ARMV7M_DCACHE)
+#    define UORB_ARENA_ALIGN 32
+#  else
+#    define UORB_ARENA_ALIGN 8
+#  endif
+#  define UORB_ARENA_CHUNK_SIZE 1024	///< the general part grows by this much as topics are advertised
+#  define UORB_ARENA_SUBSCRIBER_CHUNK 16	///< subscriber blocks added at a time
+#else
+#  define UORB_ARENA_ALIGN 64
+#  define UORB_ARENA_CHUNK_SIZE (16 * 1024)
+#  define UORB_ARENA_SUBSCRIBER_CHUNK 64
+#endif
+
+/**
+ * Topics of the control loop, in the order they are used. Their buffers are reserved
+ * next to each other, the first instances of a multi-instance topic as well.
+ */
+static const struct {
+	const char *name;
+	uint8_t queue_size;
+	uint8_t instances;
+} hot_topics[] = {
+	{"sensor_gyro", 1, 3},
+	{"sensor_accel", 1, 3},
+	{"sensor_combined", 1, 1},
+	{"vehicle_attitude", 1, 1},
+	{"vehicle_control_mode", 1, 1},
+	{"vehicle_rates_setpoint", 1, 1},
+	{"actuator_controls_0", 1, 1},
+	{"actuator_armed", 1, 1},
+	{"actuator_outputs", 1, 1},
+};
+
+static inline size_t align_up(size_t size)
+{
+	return (size + UORB_ARENA_ALIGN - 1) & ~((size_t)UORB_ARENA_ALIGN - 1);
+}
+
+uORB::Arena *uORB::Arena::_Instance = nullptr;
+
+bool uORB::Arena::initialize(size_t subscriber_size)
+{
+	if (_Instance == nullptr) {
+		Arena *arena = new Arena();
+
+		if (arena == nullptr) {
+			return false;
+		}
+
+		if (!arena->init(subscriber_size)) {
+			delete arena;
+			return false;
+		}
+
+		_Instance = arena;
+	}
+
+	return true;
+}
+
+uORB::Arena::Chunk *uORB::Arena::add_chunk(Chunk **where, size_t size)
+{
+	uint8_t *memory = (uint8_t *)malloc(sizeof(Chunk) + UORB_ARENA_ALIGN + size);
+
+	if (memory == nullptr) {
+		return nullptr;
+	}
+
+	Chunk *chunk = (Chunk *)memory;
+	chunk->begin = (uint8_t *)align_up((size_t)memory + sizeof(Chunk));
+	chunk->end = chunk->begin + size;
+	chunk->next = *where;
+	*where = chunk;
+
+	return chunk;
+}
+
+bool uORB::Arena::chunks_contain(const Chunk *chunk, const void *ptr)
+{
+	for (; chunk != nullptr; chunk = chunk->next) {
+		if (ptr >= chunk->begin && ptr < chunk->end) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool uORB::Arena::init(size_t subscriber_size)
+{
+	const orb_metadata **topics = orb_get_topics();
+	const size_t num_topics = orb_topics_count();
+
+	/* reserved buffers of the control loop topics */
+	size_t offset = 0;
+
+	for (size_t i = 0; i < sizeof(hot_topics) / sizeof(hot_topics[0]) && _num_hot < MAX_HOT_TOPICS; i++) {
+		for (size_t t = 0; t < num_topics; t++) {
+			if (strcmp(topics[t]->o_name, hot_topics[i].name) == 0) {
+				HotTopic &hot = _hot[_num_hot++];
+				hot.meta = topics[t];
+				hot.offset = offset;
+				hot.slot_size = align_up(topics[t]->o_size * hot_topics[i].queue_size);
+				hot.instances = hot_topics[i].instances;
+				offset += hot.slot_size * hot.instances;
+				break;
+			}
+		}
+	}
+
+	_hot_end = offset;
+
+	_memory = (uint8_t *)malloc(_hot_end + UORB_ARENA_ALIGN);
+
+	if (_memory == nullptr) {
+		return false;
+	}
+
+	memset(_memory, 0, _hot_end + UORB_ARENA_ALIGN);
+	_base = (uint8_t *)align_up((size_t)_memory);
+
+	/* the general part and the subscriber pool are allocated in chunks once they are needed,
+	 * a free subscriber block stores the pointer to the next one */
+	_subscriber_size = align_up(subscriber_size > sizeof(void *) ? subscriber_size : sizeof(void *));
+
+	px4_sem_init(&_lock, 0, 1);
+
+	return true;
+}
+
+void *uORB::Arena::alloc_data(const struct orb_metadata *meta, size_t size)
+{
+	Arena *arena = _Instance;
+
+	if (arena != nullptr) {
+		void *ptr = nullptr;
+
+		px4_sem_wait(&arena->_lock);
+
+		for (int i = 0; i < arena->_num_hot; i++) {
+			HotTopic &hot = arena->_hot[i];
+
+			if (hot.meta == meta && hot.used < hot.instances && size <= hot.slot_size) {
+				ptr = arena->_base + hot.offset + hot.used * hot.slot_size;
+				hot.used++;
+				arena->_hot_used += hot.slot_size;
+				break;
+			}
+		}
+
+		const size_t aligned_size = align_up(size);
+
+		if (ptr == nullptr && aligned_size >= UORB_ARENA_CHUNK_SIZE) {
+			/* a large buffer gets a chunk of its own, behind the one that is being filled */
+			Chunk **where = (arena->_data_chunks != nullptr) ? &arena->_data_chunks->next : &arena->_data_chunks;
+			Chunk *chunk = add_chunk(where, aligned_size);
+
+			if (chunk != nullptr) {
+				if (chunk == arena->_data_chunks) {
+					arena->_data_next = chunk->end;
+				}
+
+				ptr = chunk->begin;
+				arena->_data_size += aligned_size;
+				arena->_data_used += aligned_size;
+				arena->_data_chunk_count++;
+			}
+
+		} else if (ptr == nullptr) {
+			if (arena->_data_chunks == nullptr || arena->_data_next + aligned_size > arena->_data_chunks->end) {
+				Chunk *chunk = add_chunk(&arena->_data_chunks, UORB_ARENA_CHUNK_SIZE);
+
+				if (chunk != nullptr) {
+					arena->_data_next = chunk->begin;
+					arena->_data_size += UORB_ARENA_CHUNK_SIZE;
+					arena->_data_chunk_count++;
+				}
+			}
+
+			if (arena->_data_chunks != nullptr && arena->_data_next + aligned_size <= arena->_data_chunks->end) {
+				ptr = arena->_data_next;
+				arena->_data_next += aligned_size;
+				arena->_data_used += aligned_size;
+			}
+		}
+
+		if (ptr == nullptr) {
+			arena->_heap_data_count++;
+			arena->_heap_data_bytes += size;
+		}
+
+		px4_sem_post(&arena->_lock);
+
+		if (ptr != nullptr) {
+			return ptr;
+		}
+	}
+
+	return malloc(size);
+}
+
+void uORB::Arena::free_data(void *ptr)
+{
+	if (region(ptr) == Region::Heap) {
+		free(ptr);
+	}
+}
+
+void *uORB::Arena::alloc_subscriber(size_t size)
+{
+	Arena *arena = _Instance;
+
+	if (arena == nullptr) {
+		return malloc(size);
+	}
+
+	px4_sem_wait(&arena->_lock);
+
+	void *block = nullptr;
+
+	if (size <= arena->_subscriber_size) {
+		if (arena->_free_subscribers == nullptr) {
+			Chunk *chunk = add_chunk(&arena->_subscriber_chunks, arena->_subscriber_size * UORB_ARENA_SUBSCRIBER_CHUNK);
+
+			if (chunk != nullptr) {
+				for (unsigned i = UORB_ARENA_SUBSCRIBER_CHUNK; i > 0; i--) {
+					void *free_block = chunk->begin + (i - 1) * arena->_subscriber_size;
+					*(void **)free_block = arena->_free_subscribers;
+					arena->_free_subscribers = free_block;
+				}
+
+				arena->_num_subscribers += UORB_ARENA_SUBSCRIBER_CHUNK;
+			}
+		}
+
+		block = arena->_free_subscribers;
+	}
+
+	if (block != nullptr) {
+		arena->_free_subscribers = *(void **)block;
+
+		if (++arena->_subscribers_used > arena->_subscribers_peak) {
+			arena->_subscribers_peak = arena->_subscribers_used;
+		}
+
+	} else {
+		arena->_heap_subscribers++;
+	}
+
+	px4_sem_post(&arena->_lock);
+
+	if (block == nullptr) {
+		block = malloc(size);
+	}
+
+	return block;
+}
+
+void uORB::Arena::free_subscriber(void *ptr)
+{
+	Arena *arena = _Instance;
+
+	if (ptr == nullptr || arena == nullptr) {
+		free(ptr);
+		return;
+	}
+
+	px4_sem_wait(&arena->_lock);
+
+	if (chunks_contain(arena->_subscriber_chunks, ptr)) {
+		*(void **)ptr = arena->_free_subscribers;
+		arena->_free_subscribers = ptr;
+		arena->_subscribers_used--;
+		ptr = nullptr;
+
+	} else {
+		arena->_heap_subscribers--;
+	}
+
+	px4_sem_post(&arena->_lock);
+
+	free(ptr);
+}
+
+uORB::Arena::Region uORB::Arena::region(const void *ptr)
+{
+	Arena *arena = _Instance;
+
+	if (arena == nullptr) {
+		return Region::Heap;
+	}
+
+	if (ptr >= arena->_base && ptr < arena->_base + arena->_hot_end) {
+		return Region::Hot;
+	}
+
+	px4_sem_wait(&arena->_lock);
+	const bool in_arena = chunks_contain(arena->_data_chunks, ptr);
+	px4_sem_post(&arena->_lock);
+
+	return in_arena ? Region::Arena : Region::Heap;
+}
+
+const char *uORB::Arena::region_name(Region region)
+{
+	switch (region) {
+	case Region::Hot:
+		return "hot";
+
+	case Region::Arena:
+		return "arena";
+
+	case Region::Heap:
+		return "heap";
+	}
+
+	return "?";
+}
+
+void uORB::Arena::print_status()
+{
+	Arena *arena = _Instance;
+
+	if (arena == nullptr) {
+		PX4_INFO("arena not initialized, using the heap");
+		return;
+	}
+
+	px4_sem_wait(&arena->_lock);
+
+	PX4_INFO("arena: aligned to %u bytes", (unsigned)UORB_ARENA_ALIGN);
+	PX4_INFO("  hot topics:  %u / %u bytes", (unsigned)arena->_hot_used, (unsigned)arena->_hot_end);
+	PX4_INFO("  topics:      %u / %u bytes in %u chunks", (unsigned)arena->_data_used, (unsigned)arena->_data_size,
+		 arena->_data_chunk_count);
+	PX4_INFO("  subscribers: %u / %u (peak %u), %u bytes each", arena->_subscribers_used, arena->_num_subscribers,
+		 arena->_subscribers_peak, (unsigned)arena->_subscriber_size);
+	PX4_INFO("  heap:        %u topic buffers (%u bytes), %u subscribers", arena->_heap_data_count,
+		 (unsigned)arena->_heap_data_bytes, arena->_heap_subscribers);
+
+	px4_sem_post(&arena->_lock);
+}
@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <px4_sem.h>
+
+#include "uORB.h"
+
+namespace uORB
+{
+class Arena;
+}
+
+/**
+ * Memory for the topic buffers and subscriber data.
+ *
+ * A DeviceNode is never deleted, so topic buffers are bump allocated and aligned to
+ * a cache line. The buffers of the topics of the control loop are reserved when uORB
+ * starts so that they are adjacent in memory. The other buffers are allocated from
+ * chunks which are added as topics get advertised, so only advertised topics use memory.
+ * Subscriber data comes from a pool of fixed size blocks with a free list, which grows
+ * in chunks as well.
+ *
+ * If the arena is exhausted or was never initialized, the heap is used instead.
+ */
+class uORB::Arena
+{
+public:
+	enum class Region {
+		Hot,	/**< reserved for a control loop topic */
+		Arena,	/**< general part of the arena */
+		Heap	/**< heap fallback */
+	};
+
+	/**
+	 * Allocate the arena. Call this once, before any topic is published.
+	 * @param subscriber_size size of the per-subscriber data
+	 * @return true on success
+	 */
+	static bool initialize(size_t subscriber_size);
+
+	/**
+	 * Allocate the buffer of a topic instance.
+	 * @return the buffer, nullptr if out of memory
+	 */
+	static void *alloc_data(const struct orb_metadata *meta, size_t size);
+
+	/** Release a buffer from alloc_data(). Arena memory is not reused. */
+	static void free_data(void *ptr);
+
+	/**
+	 * Allocate the data of a subscriber from the pool.
+	 * @return the block, nullptr if out of memory
+	 */
+	static void *alloc_subscriber(size_t size);
+
+	static void free_subscriber(void *ptr);
+
+	/** Where ptr was allocated */
+	static Region region(const void *ptr);
+
+	static const char *region_name(Region region);
+
+	static void print_status();
+
+private:
+	Arena() = default;
+	~Arena() = default;
+
+	struct HotTopic {
+		const struct orb_metadata *meta;
+		size_t offset;		/**< offset of the first slot in the arena */
+		size_t slot_size;	/**< bytes per instance */
+		uint8_t instances;	/**< number of reserved instances */
+		uint8_t used;		/**< number of allocated instances */
+	};
+
+	/** a piece of the general part or of the subscriber pool, added once the previous ones are used up */
+	struct Chunk {
+		Chunk *next;
+		uint8_t *begin;		/**< first usable byte, aligned */
+		uint8_t *end;
+	};
+
+	static constexpr int MAX_HOT_TOPICS = 12;
+
+	bool init(size_t subscriber_size);
+
+	/** allocate a chunk of size usable bytes and link it in at where */
+	static Chunk *add_chunk(Chunk **where, size_t size);
+
+	static bool chunks_contain(const Chunk *chunk, const void *ptr);
+
+	static Arena *_Instance;
+
+	px4_sem_t _lock;
+
+	uint8_t *_memory{nullptr};	/**< allocation of the reserved buffers, _base is aligned within it */
+	uint8_t *_base{nullptr};
+
+	HotTopic _hot[MAX_HOT_TOPICS] {};
+	int _num_hot{0};
+	size_t _hot_end{0};		/**< end of the reserved topic buffers */
+	size_t _hot_used{0};
+
+	Chunk *_data_chunks{nullptr};	/**< the first one is being filled */
+	uint8_t *_data_next{nullptr};	/**< next free byte of the first chunk */
+	size_t _data_size{0};
+	size_t _data_used{0};
+	unsigned _data_chunk_count{0};
+
+	Chunk *_subscriber_chunks{nullptr};
+	size_t _subscriber_size{0};
+	unsigned _num_subscribers{0};
+	unsigned _subscribers_used{0};
+	unsigned _subscribers_peak{0};
+	void *_free_subscribers{nullptr};
+
+	unsigned _heap_data_count{0};
+	size_t _heap_data_bytes{0};
+	unsigned _heap_subscribers{0};
+};
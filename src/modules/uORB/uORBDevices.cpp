@@ -61,10 +61,12 @@
 #endif
 
 #include "uORBDevices.hpp"
+#include "uORBArena.hpp"
 #include "uORBUtils.hpp"
 #include "uORBManager.hpp"
 #include "uORBCommunicator.hpp"
 #include <px4_sem.hpp>
+#include <px4_trace.h>
 #include <stdlib.h>
 
 using namespace device;
@@ -99,7 +101,7 @@ uORB::DeviceNode::DeviceNode(const struct orb_metadata *meta, const char *name,
 uORB::DeviceNode::~DeviceNode()
 {
 	if (_data != nullptr) {
-		delete[] _data;
+		uORB::Arena::free_data(_data);
 	}
 
 }
@@ -142,7 +144,7 @@ uORB::DeviceNode::open(device::file_t *filp)
 	if (FILE_FLAGS(filp) == PX4_F_RDONLY) {
 
 		/* allocate subscriber data */
-		SubscriberData *sd = new SubscriberData;
+		SubscriberData *sd = (SubscriberData *)uORB::Arena::alloc_subscriber(sizeof(SubscriberData));
 
 		if (nullptr == sd) {
 			return -ENOMEM;
@@ -164,7 +166,7 @@ uORB::DeviceNode::open(device::file_t *filp)
 
 		if (ret != PX4_OK) {
 			PX4_ERR("CDev::open failed");
-			delete sd;
+			uORB::Arena::free_subscriber(sd);
 		}
 
 		return ret;
@@ -191,10 +193,11 @@ uORB::DeviceNode::close(device::file_t *filp)
 		if (sd != nullptr) {
 			if (sd->update_interval) {
 				hrt_cancel(&sd->update_interval->update_call);
+				delete sd->update_interval;
 			}
 
 			remove_internal_subscriber();
-			delete sd;
+			uORB::Arena::free_subscriber(sd);
 			sd = nullptr;
 		}
 	}
@@ -279,7 +282,7 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 
 			/* re-check size */
 			if (nullptr == _data) {
-				_data = new uint8_t[_meta->o_size * _queue_size];
+				_data = (uint8_t *)uORB::Arena::alloc_data(_meta, _meta->o_size * _queue_size);
 			}
 
 			unlock();
@@ -290,7 +293,7 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 
 		/* re-check size */
 		if (nullptr == _data) {
-			_data = new uint8_t[_meta->o_size * _queue_size];
+			_data = (uint8_t *)uORB::Arena::alloc_data(_meta, _meta->o_size * _queue_size);
 		}
 
 		unlock();
@@ -320,6 +323,8 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 
 	ATOMIC_LEAVE;
 
+	px4_trace_instant(PX4_TRACE_PUBLISH, get_devname());
+
 	/* notify any poll waiters */
 	poll_notify(POLLIN);
 
@@ -990,6 +995,34 @@ void uORB::DeviceMaster::printStatistics(bool reset)
 	}
 }
 
+void uORB::DeviceMaster::printMemoryUsage()
+{
+	size_t total_buffers = 0;
+	unsigned total_subscribers = 0;
+
+	PX4_INFO("TOPIC, INST, SIZE, QUEUE, BUFFER, #SUB, REGION");
+
+	lock();
+	ITERATE_NODE_MAP() {
+		INIT_NODE_MAP_VARS(node, node_name)
+
+		const size_t buffer_size = node->buffer_size();
+
+		PX4_INFO("%s, %c, %u, %u, %u, %i, %s", node->get_meta()->o_name, node_name[strlen(node_name) - 1],
+			 (unsigned)node->get_meta()->o_size, node->get_queue_size(), (unsigned)buffer_size,
+			 (int)node->subscriber_count(),
+			 (buffer_size > 0) ? uORB::Arena::region_name(uORB::Arena::region(node->buffer())) : "-");
+
+		total_buffers += buffer_size;
+		total_subscribers += node->subscriber_count();
+	}
+
+	unlock();
+
+	PX4_INFO("total: %u bytes of topic buffers, %u subscribers", (unsigned)total_buffers, total_subscribers);
+	uORB::Arena::print_status();
+}
+
 void uORB::DeviceMaster::addNewDeviceNodes(DeviceNodeStatisticsData **first_node, int &num_topics,
 		size_t &max_topic_name_length,
 		char **topic_filter, int num_filters)
@@ -185,8 +185,15 @@ public:
 	unsigned int published_message_count() const { return _generation; }
 	const struct orb_metadata *get_meta() const { return _meta; }
 
+	/** topic buffer, nullptr until the first publication */
+	const uint8_t *buffer() const { return _data; }
+	size_t buffer_size() const { return (_data != nullptr) ? _meta->o_size * _queue_size : 0; }
+
 	void set_priority(uint8_t priority) { _priority = priority; }
 
+	/** size of the per-subscriber data, for the uORB::Arena pool */
+	static size_t subscriber_data_size() { return sizeof(SubscriberData); }
+
 protected:
 	virtual pollevent_t poll_state(device::file_t *filp);
 	virtual void poll_notify_one(px4_pollfd_struct_t *fds, pollevent_t events);
@@ -199,9 +206,8 @@ private:
 		uint64_t last_update; /**< time at which the last update was provided, used when update_interval is nonzero */
 #endif
 	};
+	/** allocated from the uORB::Arena subscriber pool, the owner of update_interval must delete it */
 	struct SubscriberData {
-		~SubscriberData() { if (update_interval) { delete (update_interval); } }
-
 		unsigned  generation; /**< last generation the subscriber has seen */
 		int   flags; /**< lowest 8 bits: priority of publisher, 9. bit: update_reported bit */
 		UpdateIntervalData *update_interval; /**< if null, no update interval */
@@ -287,6 +293,11 @@ public:
 	 */
 	void printStatistics(bool reset);
 
+	/**
+	 * Print the memory used by each topic and the state of the uORB::Arena.
+	 */
+	void printMemoryUsage();
+
 	/**
 	 * Continuously print statistics, like the unix top command for processes.
 	 * Exited when the user presses the enter key.
@@ -32,6 +32,7 @@
  ****************************************************************************/
 
 #include <string.h>
+#include "uORBArena.hpp"
 #include "uORBDevices.hpp"
 #include "uORBManager.hpp"
 #include "uORB.h"
@@ -58,6 +59,8 @@ The implementation is asynchronous and lock-free, ie. a publisher does not wait
 This is achieved by having a separate buffer between a publisher and a subscriber.
 
 The code is optimized to minimize the memory footprint and the latency to exchange messages.
+Topic buffers and subscriber data come from an arena allocated at startup, with the buffers of the control
+loop topics next to each other. `uorb status` shows the memory used per topic.
 
 The interface is based on file descriptors: internally it uses `read`, `write` and `ioctl`. Except for the
 publications, which use `orb_advert_t` handles, so that they can be used from interrupts as well (on NuttX).
@@ -74,7 +77,7 @@ $ uorb top
 
 	PRINT_MODULE_USAGE_NAME("uorb", "communication");
 	PRINT_MODULE_USAGE_COMMAND("start");
-	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print topic statistics");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print topic statistics and memory usage");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("top", "Monitor topic publication rates");
 	PRINT_MODULE_USAGE_PARAM_FLAG('a', "print all instead of only currently publishing topics", true);
 	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (implies -a)", true);
@@ -104,6 +107,11 @@ uorb_main(int argc, char *argv[])
 			return -ENOMEM;
 		}
 
+		/* topic buffers and subscriber data, before anything is advertised */
+		if (!uORB::Arena::initialize(uORB::DeviceNode::subscriber_data_size())) {
+			PX4_WARN("arena alloc failed, using the heap");
+		}
+
 		/* create the driver */
 		g_dev = uORB::Manager::get_instance()->get_device_master(uORB::PUBSUB);
 
@@ -127,6 +135,7 @@ uorb_main(int argc, char *argv[])
 	if (!strcmp(argv[1], "status")) {
 		if (g_dev != nullptr) {
 			g_dev->printStatistics(true);
+			g_dev->printMemoryUsage();
 
 		} else {
 			PX4_INFO("uorb is not running");
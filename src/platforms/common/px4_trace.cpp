@@ -0,0 +1,361 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_trace.cpp
+ *
+ * Lock-free trace ring: writers claim a slot with an atomic increment, the
+ * ring is only read after tracing stopped. Writers register in trace_writers
+ * before loading the ring, the ring is only read or freed once they left.
+ */
+
+#include <px4_trace.h>
+#include <px4_log.h>
+#include <drivers/drv_hrt.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+#ifdef __PX4_LINUX
+#include <sys/syscall.h>
+#endif
+
+struct trace_event {
+	uint64_t timestamp;
+	const char *name;
+	const void *function;	///< resolved to a symbol name at dump time if name is nullptr
+	uint32_t duration;
+	uint32_t tid;
+	uint8_t type;
+};
+
+struct trace_ring {
+	uint32_t capacity;
+	trace_event events[];
+};
+
+bool px4_trace_enabled = false;
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static trace_ring *trace_current = nullptr;	///< buffer and capacity, swapped as one pointer
+static uint32_t trace_writers = 0;		///< writers that may still use trace_current
+static uint64_t trace_head = 0;
+
+#ifndef __PX4_LINUX
+static uint32_t trace_next_tid = 1;
+#endif
+
+static uint32_t trace_tid()
+{
+	static __thread uint32_t tid = 0;
+
+	if (tid == 0) {
+#ifdef __PX4_LINUX
+		// kernel thread ids, which lets the dump look up the thread names
+		tid = (uint32_t)syscall(SYS_gettid);
+#else
+		tid = __atomic_fetch_add(&trace_next_tid, 1, __ATOMIC_RELAXED);
+#endif
+	}
+
+	return tid;
+}
+
+static void trace_record(px4_trace_type_t type, const char *name, const void *function, uint64_t start,
+			 uint32_t duration)
+{
+	__atomic_add_fetch(&trace_writers, 1, __ATOMIC_SEQ_CST);
+
+	trace_ring *ring = __atomic_load_n(&trace_current, __ATOMIC_SEQ_CST);
+
+	// tracing may have stopped since the caller checked, the ring is only replaced while stopped
+	if (ring != nullptr && __atomic_load_n(&px4_trace_enabled, __ATOMIC_SEQ_CST)) {
+		const uint64_t index = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+		// slots are reused once the ring wrapped, a writer lapped mid-write can leave one torn event
+		trace_event &event = ring->events[index % ring->capacity];
+
+		event.timestamp = start != 0 ? start : hrt_absolute_time();
+		event.name = name;
+		event.function = function;
+		event.duration = duration;
+		event.tid = trace_tid();
+		event.type = type;
+	}
+
+	__atomic_sub_fetch(&trace_writers, 1, __ATOMIC_RELEASE);
+}
+
+void px4_trace_record(px4_trace_type_t type, const char *name, uint64_t start, uint32_t duration)
+{
+	trace_record(type, name, nullptr, start, duration);
+}
+
+void px4_trace_record_function(px4_trace_type_t type, const void *function, uint64_t start, uint32_t duration)
+{
+	trace_record(type, nullptr, function, start, duration);
+}
+
+/** wait for writers that saw tracing enabled to finish, tracing must be stopped */
+static void trace_quiesce()
+{
+	while (__atomic_load_n(&trace_writers, __ATOMIC_ACQUIRE) != 0) {
+		usleep(1000);
+	}
+}
+
+int px4_trace_start(unsigned num_events)
+{
+	if (num_events == 0) {
+		return -EINVAL;
+	}
+
+	pthread_mutex_lock(&trace_mutex);
+
+	if (__atomic_load_n(&px4_trace_enabled, __ATOMIC_RELAXED)) {
+		pthread_mutex_unlock(&trace_mutex);
+		return -EBUSY;
+	}
+
+	if (trace_current == nullptr || trace_current->capacity != num_events) {
+		// unpublish the old ring first, then free it once no writer can hold it anymore
+		trace_ring *old_ring = __atomic_exchange_n(&trace_current, nullptr, __ATOMIC_SEQ_CST);
+		trace_quiesce();
+		free(old_ring);
+
+		trace_ring *ring = (trace_ring *)calloc(1, sizeof(trace_ring) + num_events * sizeof(trace_event));
+
+		if (ring == nullptr) {
+			pthread_mutex_unlock(&trace_mutex);
+			return -ENOMEM;
+		}
+
+		ring->capacity = num_events;
+		__atomic_store_n(&trace_current, ring, __ATOMIC_SEQ_CST);
+
+	} else {
+		trace_quiesce();
+	}
+
+	__atomic_store_n(&trace_head, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&px4_trace_enabled, true, __ATOMIC_SEQ_CST);
+
+	pthread_mutex_unlock(&trace_mutex);
+	return 0;
+}
+
+void px4_trace_stop()
+{
+	__atomic_store_n(&px4_trace_enabled, false, __ATOMIC_SEQ_CST);
+}
+
+static void write_json_string(FILE *f, const char *str)
+{
+	fputc('"', f);
+
+	for (const char *c = str ? str : "?"; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', f);
+		}
+
+		if ((unsigned char)*c >= 0x20) {
+			fputc(*c, f);
+		}
+	}
+
+	fputc('"', f);
+}
+
+/** symbol name of a traced function, the offset in its binary (for addr2line) if it is not exported */
+static void function_name(const void *function, char *name, size_t size)
+{
+	Dl_info info;
+
+	if (dladdr(function, &info) == 0) {
+		snprintf(name, size, "%p", function);
+
+	} else if (info.dli_sname == nullptr) {
+		const char *file = info.dli_fname ? strrchr(info.dli_fname, '/') : nullptr;
+		snprintf(name, size, "%s+0x%lx", file ? file + 1 : "?",
+			 (unsigned long)((uintptr_t)function - (uintptr_t)info.dli_fbase));
+
+	} else {
+		int status = -1;
+		char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		snprintf(name, size, "%s", status == 0 ? demangled : info.dli_sname);
+		free(demangled);
+	}
+}
+
+int px4_trace_dump(const char *path)
+{
+	static const char *categories[] = {"publish", "wakeup", "perf", "work"};
+
+	px4_trace_stop();
+
+	pthread_mutex_lock(&trace_mutex);
+
+	const trace_ring *ring = trace_current;
+
+	if (ring == nullptr) {
+		pthread_mutex_unlock(&trace_mutex);
+		return -ENODATA;
+	}
+
+	FILE *f = fopen(path, "w");
+
+	if (f == nullptr) {
+		int ret = -errno;
+		pthread_mutex_unlock(&trace_mutex);
+		return ret;
+	}
+
+	// let writers that saw tracing enabled finish their event
+	trace_quiesce();
+
+	const uint64_t head = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+	const uint64_t count = head < ring->capacity ? head : ring->capacity;
+
+	// every thread that shows up in the trace, for the name metadata
+	uint32_t tids[256];
+	unsigned num_tids = 0;
+
+	// resolved function names, work items run the same few callbacks over and over
+	static constexpr unsigned MAX_FUNCTIONS = 64;
+	const void *functions[MAX_FUNCTIONS];
+	char function_names[MAX_FUNCTIONS][64];
+	unsigned num_functions = 0;
+
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	for (uint64_t i = head - count; i < head; i++) {
+		const trace_event &event = ring->events[i % ring->capacity];
+		const char *category = event.type < sizeof(categories) / sizeof(categories[0]) ? categories[event.type] : "?";
+		const char *name = event.name;
+
+		if (name == nullptr && event.function != nullptr) {
+			unsigned n = 0;
+
+			while (n < num_functions && functions[n] != event.function) {
+				n++;
+			}
+
+			if (n == num_functions && num_functions < MAX_FUNCTIONS) {
+				functions[n] = event.function;
+				function_name(event.function, function_names[n], sizeof(function_names[n]));
+				num_functions++;
+			}
+
+			name = (n < num_functions) ? function_names[n] : "work";
+		}
+
+		fprintf(f, "{\"name\":");
+		write_json_string(f, name);
+
+		if (event.type == PX4_TRACE_PERF || event.type == PX4_TRACE_WORK) {
+			fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%u},\n", category,
+				(unsigned long long)event.timestamp, (unsigned)event.duration, (unsigned)event.tid);
+
+		} else {
+			fprintf(f, ",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":1,\"tid\":%u},\n", category,
+				(unsigned long long)event.timestamp, (unsigned)event.tid);
+		}
+
+		unsigned t = 0;
+
+		while (t < num_tids && tids[t] != event.tid) {
+			t++;
+		}
+
+		if (t == num_tids && num_tids < sizeof(tids) / sizeof(tids[0])) {
+			tids[num_tids++] = event.tid;
+		}
+	}
+
+	for (unsigned t = 0; t < num_tids; t++) {
+		char name[32] = {};
+#ifdef __PX4_LINUX
+		char comm_path[64];
+		snprintf(comm_path, sizeof(comm_path), "/proc/self/task/%u/comm", (unsigned)tids[t]);
+		FILE *comm = fopen(comm_path, "r");
+
+		if (comm != nullptr) {
+			if (fgets(name, sizeof(name), comm) != nullptr) {
+				name[strcspn(name, "\n")] = '\0';
+			}
+
+			fclose(comm);
+		}
+
+#endif
+
+		if (name[0] == '\0') {
+			snprintf(name, sizeof(name), "thread %u", (unsigned)tids[t]);
+		}
+
+		fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", (unsigned)tids[t]);
+		write_json_string(f, name);
+		fprintf(f, "}},\n");
+	}
+
+	fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"px4\"}}\n]}\n");
+	fclose(f);
+
+	pthread_mutex_unlock(&trace_mutex);
+
+	if (head > count) {
+		PX4_INFO("trace: ring overflowed, dropped the oldest %llu events", (unsigned long long)(head - count));
+	}
+
+	return (int)count;
+}
+
+void px4_trace_status()
+{
+	pthread_mutex_lock(&trace_mutex);
+	const uint64_t head = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+	PX4_INFO("trace: %s, %llu events recorded, ring of %u events",
+		 __atomic_load_n(&px4_trace_enabled, __ATOMIC_RELAXED) ? "running" : "stopped",
+		 (unsigned long long)head, trace_current ? (unsigned)trace_current->capacity : 0);
+	pthread_mutex_unlock(&trace_mutex);
+}
+
+#endif
@@ -51,6 +51,7 @@
 #include <px4_workqueue.h>
 #include <px4_posix.h>
 #include "hrt_work.h"
+#include "work_heap.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -121,20 +122,22 @@ int hrt_work_queue(struct work_s *work, worker_t worker, void *arg, uint32_t del
 
 	hrt_work_lock();
 	work->qtime  = hrt_absolute_time(); /* Time work queued */
+	work->deadline = work->qtime + delay;
 	//PX4_INFO("hrt work_queue adding work delay=%u time=%lu", delay, work->qtime);
 
-	dq_addlast((dq_entry_t *)work, &wqueue->q);
+	int ret = work_heap_insert(wqueue, work);
 
-	if (px4_getpid() != wqueue->pid) { /* only need to wake up if called from a different thread */
-#ifdef __PX4_QURT
-		px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-		//wqueue->pid == own task? -> don't signal
-		px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
-#endif
+	if (ret != PX4_OK) {
+		work->worker = NULL;
+
+	} else if (work->heap_index == 0 && px4_getpid() != wqueue->pid) {
+		/* only need to wake up if the earliest deadline moved and we are
+		 * called from a different thread
+		 */
+		work_heap_wakeup(wqueue);
 	}
 
 	hrt_work_unlock();
-	return PX4_OK;
+	return ret;
 }
 
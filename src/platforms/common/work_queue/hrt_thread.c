@@ -50,6 +50,7 @@
 #include <px4_workqueue.h>
 #include <drivers/drv_hrt.h>
 #include "hrt_work.h"
+#include "work_heap.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -74,8 +75,8 @@ px4_sem_t _hrt_work_lock;
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
-static void hrt_work_process(void);
 
+#ifdef __PX4_QURT
 static void _sighandler(int sig_num);
 
 /****************************************************************************
@@ -95,131 +96,8 @@ static void _sighandler(int sig_num)
 {
 	PX4_DEBUG("RECEIVED SIGNAL %d", sig_num);
 }
-
-/****************************************************************************
- * Name: work_process
- *
- * Description:
- *   This is the logic that performs actions placed on any work list.
- *
- * Input parameters:
- *   wqueue - Describes the work queue to be processed
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void hrt_work_process()
-{
-	struct wqueue_s *wqueue = &g_hrt_work;
-	volatile struct work_s *work;
-	worker_t  worker;
-	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
-
-	// set the threads name
-#ifdef __PX4_DARWIN
-	pthread_setname_np("HRT");
-#else
-	// The Linux headers do not actually contain this
-	//rv = pthread_setname_np(pthread_self(), "HRT");
 #endif
 
-	/* Then process queued work.  We need to keep interrupts disabled while
-	 * we process items in the work list.
-	 */
-
-	/* Default to sleeping for 1 sec */
-	next  = 1000000;
-
-	hrt_work_lock();
-
-	work  = (struct work_s *)wqueue->q.head;
-
-	while (work) {
-		/* Is this work ready?  It is ready if there is no delay or if
-		 * the delay has elapsed. qtime is the time that the work was added
-		 * to the work queue.  It will always be greater than or equal to
-		 * zero.  Therefore a delay of zero will always execute immediately.
-		 */
-
-		elapsed = hrt_absolute_time() - work->qtime;
-
-		//PX4_INFO("hrt work_process: in usec elapsed=%lu delay=%u work=%p", elapsed, work->delay, work);
-		if (elapsed >= work->delay) {
-			/* Remove the ready-to-execute work from the list */
-
-			(void)dq_rem((struct dq_entry_s *) & (work->dq), &(wqueue->q));
-			//PX4_INFO("Dequeued work=%p", work);
-
-			/* Extract the work description from the entry (in case the work
-			 * instance by the re-used after it has been de-queued).
-			 */
-
-			worker = work->worker;
-			arg    = work->arg;
-
-			/* Mark the work as no longer being queued */
-
-			work->worker = NULL;
-
-			/* Do the work.  Re-enable interrupts while the work is being
-			 * performed... we don't have any idea how long that will take!
-			 */
-
-			hrt_work_unlock();
-
-			if (!worker) {
-				PX4_ERR("MESSED UP: worker = 0");
-				PX4_BACKTRACE();
-
-			} else {
-				worker(arg);
-			}
-
-			/* Now, unfortunately, since we re-enabled interrupts we don't
-			 * know the state of the work list and we will have to start
-			 * back at the head of the list.
-			 */
-
-			hrt_work_lock();
-			work  = (struct work_s *)wqueue->q.head;
-
-		} else {
-			/* This one is not ready.. will it be ready before the next
-			 * scheduled wakeup interval?
-			 */
-
-			/* Here: elapsed < work->delay */
-			remaining = work->delay - elapsed;
-
-			//PX4_INFO("remaining=%u delay=%u elapsed=%lu", remaining, work->delay, elapsed);
-			if (remaining < next) {
-				/* Yes.. Then schedule to wake up when the work is ready */
-
-				next = remaining;
-			}
-
-			/* Then try the next in the list. */
-
-			work = (struct work_s *)work->dq.flink;
-			//PX4_INFO("next %u work %p", next, work);
-		}
-	}
-
-	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
-	 */
-	hrt_work_unlock();
-
-	/* might sleep less if a signal received and new item was queued */
-	//PX4_INFO("Sleeping for %u usec", next);
-	usleep(next);
-}
-
 /****************************************************************************
  * Name: work_hrtthread
  *
@@ -247,6 +125,11 @@ static void hrt_work_process()
 
 static int work_hrtthread(int argc, char *argv[])
 {
+	// set the threads name
+#ifdef __PX4_DARWIN
+	pthread_setname_np("HRT");
+#endif
+
 	/* Loop forever */
 
 	for (;;) {
@@ -257,11 +140,11 @@ static int work_hrtthread(int argc, char *argv[])
 		 * the IDLE thread (at a very, very low priority).
 		 */
 
-		/* Then process queued work.  We need to keep interrupts disabled while
-		 * we process items in the work list.
+		/* Then process queued work, sleeping at most 1 sec until the
+		 * earliest deadline.
 		 */
 
-		hrt_work_process();
+		work_heap_process(&g_hrt_work, &_hrt_work_lock, 1000000);
 	}
 
 	return PX4_OK; /* To keep some compilers happy */
@@ -275,6 +158,7 @@ void hrt_work_queue_init(void)
 {
 	px4_sem_init(&_hrt_work_lock, 0, 1);
 	memset(&g_hrt_work, 0, sizeof(g_hrt_work));
+	work_heap_init(&g_hrt_work);
 
 	// Create high priority worker thread
 	g_hrt_work.pid = px4_task_spawn_cmd("wkr_hrt",
@@ -287,8 +171,6 @@ void hrt_work_queue_init(void)
 
 #ifdef __PX4_QURT
 	signal(SIGALRM, _sighandler);
-#else
-	signal(SIGCONT, _sighandler);
 #endif
 }
 
@@ -42,6 +42,7 @@
 #include <queue.h>
 #include <px4_workqueue.h>
 #include "work_lock.h"
+#include "work_heap.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -100,16 +101,11 @@ int work_cancel(int qid, struct work_s *work)
 	work_lock(qid);
 
 	if (work->worker != NULL) {
-		/* A little test of the integrity of the work queue */
-
-		//DEBUGASSERT(work->dq.flink ||(dq_entry_t *)work == wqueue->q.tail);
-		//DEBUGASSERT(work->dq.blink ||(dq_entry_t *)work == wqueue->q.head);
-
 		/* Remove the entry from the work queue and make sure that it is
 		 * mark as availalbe (i.e., the worker field is nullified).
 		 */
 
-		dq_rem((dq_entry_t *)work, &wqueue->q);
+		work_heap_remove(wqueue, work);
 		work->worker = NULL;
 	}
 
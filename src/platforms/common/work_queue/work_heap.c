@@ -0,0 +1,359 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+#include <px4_time.h>
+#include <px4_trace.h>
+#include <px4_workqueue.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <drivers/drv_hrt.h>
+#include "work_heap.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Initial number of heap slots, grown by doubling when exceeded */
+#define WORK_HEAP_INITIAL_SIZE 32
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline bool work_before(const struct work_s *a, const struct work_s *b)
+{
+	if (a->deadline != b->deadline) {
+		return a->deadline < b->deadline;
+	}
+
+	return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static inline void work_heap_set(struct wqueue_s *wqueue, uint32_t index, struct work_s *work)
+{
+	wqueue->heap[index] = work;
+	work->heap_index = index;
+}
+
+static void work_heap_sift_up(struct wqueue_s *wqueue, uint32_t index)
+{
+	struct work_s *work = wqueue->heap[index];
+
+	while (index > 0) {
+		uint32_t parent = (index - 1) / 2;
+
+		if (!work_before(work, wqueue->heap[parent])) {
+			break;
+		}
+
+		work_heap_set(wqueue, index, wqueue->heap[parent]);
+		index = parent;
+	}
+
+	work_heap_set(wqueue, index, work);
+}
+
+static void work_heap_sift_down(struct wqueue_s *wqueue, uint32_t index)
+{
+	struct work_s *work = wqueue->heap[index];
+
+	for (;;) {
+		uint32_t child = 2 * index + 1;
+
+		if (child >= wqueue->count) {
+			break;
+		}
+
+		if (child + 1 < wqueue->count && work_before(wqueue->heap[child + 1], wqueue->heap[child])) {
+			child++;
+		}
+
+		if (!work_before(wqueue->heap[child], work)) {
+			break;
+		}
+
+		work_heap_set(wqueue, index, wqueue->heap[child]);
+		index = child;
+	}
+
+	work_heap_set(wqueue, index, work);
+}
+
+/****************************************************************************
+ * Name: work_heap_wait
+ *
+ * Description:
+ *   Block the worker thread for at most timeout_us, returning early if
+ *   work_heap_wakeup() is called. A wakeup that arrives between scanning the
+ *   heap and calling this function is not lost.
+ *
+ ****************************************************************************/
+
+static void work_heap_wait(struct wqueue_s *wqueue, uint32_t timeout_us)
+{
+#ifdef __PX4_QURT
+	/* woken early by SIGALRM from work_heap_wakeup() */
+	usleep(timeout_us);
+#else
+	pthread_mutex_lock(&wqueue->wake_lock);
+
+	if (!wqueue->wake_pending) {
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+		if (px4_lockstep_active()) {
+			/* deadlines are in hrt time, which is the simulated time now */
+			px4_lockstep_cond_timedwait(&wqueue->wake, &wqueue->wake_lock, px4_lockstep_get_time() + timeout_us);
+
+		} else
+#endif
+		{
+#ifdef __PX4_DARWIN
+			struct timespec ts;
+			ts.tv_sec = timeout_us / 1000000;
+			ts.tv_nsec = (timeout_us % 1000000) * 1000;
+			pthread_cond_timedwait_relative_np(&wqueue->wake, &wqueue->wake_lock, &ts);
+#else
+			/* the condition uses CLOCK_MONOTONIC, so the deadline is immune to wall clock steps */
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			uint64_t nsecs = ts.tv_nsec + (uint64_t)timeout_us * 1000;
+			ts.tv_sec += nsecs / 1000000000;
+			ts.tv_nsec = nsecs % 1000000000;
+			pthread_cond_timedwait(&wqueue->wake, &wqueue->wake_lock, &ts);
+#endif
+		}
+	}
+
+	wqueue->wake_pending = false;
+	pthread_mutex_unlock(&wqueue->wake_lock);
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_heap_init
+ *
+ * Description:
+ *   Allocate the heap and set up the wakeup condition of a work queue.
+ *   Must be called before the worker thread is started.
+ *
+ ****************************************************************************/
+
+void work_heap_init(struct wqueue_s *wqueue)
+{
+	wqueue->count = 0;
+	wqueue->seq = 0;
+	wqueue->heap = (struct work_s **)malloc(WORK_HEAP_INITIAL_SIZE * sizeof(struct work_s *));
+	wqueue->capacity = (wqueue->heap != NULL) ? WORK_HEAP_INITIAL_SIZE : 0;
+
+#ifndef __PX4_QURT
+	pthread_mutex_init(&wqueue->wake_lock, NULL);
+
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+#ifndef __PX4_DARWIN
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+	pthread_cond_init(&wqueue->wake, &attr);
+	pthread_condattr_destroy(&attr);
+
+	wqueue->wake_pending = false;
+#endif
+}
+
+/****************************************************************************
+ * Name: work_heap_insert
+ *
+ * Description:
+ *   Add work to the heap, ordered by work->deadline. Work that is already
+ *   pending is moved to its new position.
+ *
+ * Returned Value:
+ *   Zero on success, -ENOMEM if the heap could not be grown
+ *
+ ****************************************************************************/
+
+int work_heap_insert(struct wqueue_s *wqueue, struct work_s *work)
+{
+	work_heap_remove(wqueue, work);
+
+	if (wqueue->count == wqueue->capacity) {
+		unsigned capacity = (wqueue->capacity > 0) ? 2 * wqueue->capacity : WORK_HEAP_INITIAL_SIZE;
+		struct work_s **heap = (struct work_s **)realloc(wqueue->heap, capacity * sizeof(struct work_s *));
+
+		if (heap == NULL) {
+			return -ENOMEM;
+		}
+
+		wqueue->heap = heap;
+		wqueue->capacity = capacity;
+	}
+
+	work->seq = wqueue->seq++;
+	work_heap_set(wqueue, wqueue->count++, work);
+	work_heap_sift_up(wqueue, work->heap_index);
+
+	return PX4_OK;
+}
+
+/****************************************************************************
+ * Name: work_heap_remove
+ *
+ * Description:
+ *   Remove work from the heap. Does nothing if the work is not pending.
+ *
+ ****************************************************************************/
+
+void work_heap_remove(struct wqueue_s *wqueue, struct work_s *work)
+{
+	uint32_t index = work->heap_index;
+
+	if (index >= wqueue->count || wqueue->heap[index] != work) {
+		return;
+	}
+
+	struct work_s *last = wqueue->heap[--wqueue->count];
+
+	if (last != work) {
+		work_heap_set(wqueue, index, last);
+		work_heap_sift_up(wqueue, index);
+		work_heap_sift_down(wqueue, last->heap_index);
+	}
+}
+
+/****************************************************************************
+ * Name: work_heap_wakeup
+ *
+ * Description:
+ *   Wake up the worker thread so it re-evaluates the earliest deadline.
+ *
+ ****************************************************************************/
+
+void work_heap_wakeup(struct wqueue_s *wqueue)
+{
+#ifdef __PX4_QURT
+	px4_task_kill(wqueue->pid, SIGALRM);
+#else
+	pthread_mutex_lock(&wqueue->wake_lock);
+	wqueue->wake_pending = true;
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	px4_lockstep_cond_broadcast(&wqueue->wake);
+#else
+	pthread_cond_signal(&wqueue->wake);
+#endif
+	pthread_mutex_unlock(&wqueue->wake_lock);
+#endif
+}
+
+/****************************************************************************
+ * Name: work_heap_process
+ *
+ * Description:
+ *   Run all work whose deadline has passed, then wait until the next
+ *   deadline (at most max_wait usec) or until new work is queued ahead of it.
+ *
+ * Input parameters:
+ *   wqueue   - Describes the work queue to be processed
+ *   lock     - The lock protecting wqueue
+ *   max_wait - Upper bound for the wait in usec
+ *
+ ****************************************************************************/
+
+void work_heap_process(struct wqueue_s *wqueue, px4_sem_t *lock, uint32_t max_wait)
+{
+	uint32_t next = max_wait;
+
+	px4_sem_wait(lock);
+
+	while (wqueue->count > 0) {
+		struct work_s *work = wqueue->heap[0];
+		hrt_abstime now = hrt_absolute_time();
+
+		if (work->deadline > now) {
+			/* The head is not ready, so nothing else is either */
+			if (work->deadline - now < next) {
+				next = work->deadline - now;
+			}
+
+			break;
+		}
+
+		work_heap_remove(wqueue, work);
+
+		/* Extract the work description from the entry (in case the work
+		 * instance will be re-used after it has been de-queued).
+		 */
+
+		worker_t worker = work->worker;
+		void *arg = work->arg;
+
+		/* Mark the work as no longer being queued */
+
+		work->worker = NULL;
+
+		/* Do the work. Release the lock while the work is being performed,
+		 * we don't have any idea how long that will take!
+		 */
+
+		px4_sem_post(lock);
+
+		if (!worker) {
+			PX4_ERR("MESSED UP: worker = 0");
+
+		} else {
+			worker(arg);
+			px4_trace_function(PX4_TRACE_WORK, (const void *)worker, now, hrt_absolute_time() - now);
+		}
+
+		px4_sem_wait(lock);
+	}
+
+	px4_sem_post(lock);
+
+	work_heap_wait(wqueue, next);
+}
@@ -47,7 +47,10 @@
 #include <queue.h>
 #include <stdio.h>
 #include <semaphore.h>
+#include <px4_posix.h>
+#include <drivers/drv_hrt.h>
 #include "work_lock.h"
+#include "work_heap.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -123,16 +126,19 @@ int work_queue(int qid, struct work_s *work, worker_t worker, void *arg, uint32_
 
 	work_lock(qid);
 	work->qtime  = clock_systimer(); /* Time work queued */
+	work->deadline = hrt_absolute_time() + (uint64_t)delay * USEC_PER_TICK;
 
-	dq_addlast((dq_entry_t *)work, &wqueue->q);
-#ifdef __PX4_QURT
-	px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-	px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
-#endif
+	int ret = work_heap_insert(wqueue, work);
+
+	if (ret != PX4_OK) {
+		work->worker = NULL;
+
+	} else if (work->heap_index == 0 && px4_getpid() != wqueue->pid) {
+		work_heap_wakeup(wqueue);      /* Wake up the worker thread */
+	}
 
 	work_unlock(qid);
-	return PX4_OK;
+	return ret;
 }
 
 #endif /* CONFIG_SCHED_WORKQUEUE */
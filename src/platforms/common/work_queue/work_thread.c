@@ -50,6 +50,7 @@
 #include <pthread.h>
 #include <drivers/drv_hrt.h>
 #include "work_lock.h"
+#include "work_heap.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -77,114 +78,6 @@ px4_sem_t _work_lock[NWORKERS];
  * Private Functions
  ****************************************************************************/
 
-/****************************************************************************
- * Name: work_process
- *
- * Description:
- *   This is the logic that performs actions placed on any work list.
- *
- * Input parameters:
- *   wqueue - Describes the work queue to be processed
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void work_process(struct wqueue_s *wqueue, int lock_id)
-{
-	volatile struct work_s *work;
-	worker_t  worker;
-	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
-
-	/* Then process queued work.  We need to keep interrupts disabled while
-	 * we process items in the work list.
-	 */
-
-	next  = CONFIG_SCHED_WORKPERIOD;
-
-	work_lock(lock_id);
-
-	work  = (struct work_s *)wqueue->q.head;
-
-	while (work) {
-		/* Is this work ready?  It is ready if there is no delay or if
-		 * the delay has elapsed. qtime is the time that the work was added
-		 * to the work queue.  It will always be greater than or equal to
-		 * zero.  Therefore a delay of zero will always execute immediately.
-		 */
-
-		elapsed = USEC2TICK(clock_systimer() - work->qtime);
-
-		//printf("work_process: in ticks elapsed=%lu delay=%u\n", elapsed, work->delay);
-		if (elapsed >= work->delay) {
-			/* Remove the ready-to-execute work from the list */
-
-			(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
-
-			/* Extract the work description from the entry (in case the work
-			 * instance by the re-used after it has been de-queued).
-			 */
-
-			worker = work->worker;
-			arg    = work->arg;
-
-			/* Mark the work as no longer being queued */
-
-			work->worker = NULL;
-
-			/* Do the work.  Re-enable interrupts while the work is being
-			 * performed... we don't have any idea how long that will take!
-			 */
-
-			work_unlock(lock_id);
-
-			if (!worker) {
-				PX4_WARN("MESSED UP: worker = 0\n");
-
-			} else {
-				worker(arg);
-			}
-
-			/* Now, unfortunately, since we re-enabled interrupts we don't
-			 * know the state of the work list and we will have to start
-			 * back at the head of the list.
-			 */
-
-			work_lock(lock_id);
-			work  = (struct work_s *)wqueue->q.head;
-
-		} else {
-			/* This one is not ready.. will it be ready before the next
-			 * scheduled wakeup interval?
-			 */
-
-			/* Here: elapsed < work->delay */
-			remaining = USEC_PER_TICK * (work->delay - elapsed);
-
-			if (remaining < next) {
-				/* Yes.. Then schedule to wake up when the work is ready */
-
-				next = remaining;
-			}
-
-			/* Then try the next in the list. */
-
-			work = (struct work_s *)work->dq.flink;
-		}
-	}
-
-	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
-	 */
-	work_unlock(lock_id);
-
-	usleep(next);
-}
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -196,6 +89,10 @@ void work_queues_init(void)
 	px4_sem_init(&_work_lock[USRWORK], 0, 1);
 #endif
 
+	for (int i = 0; i < NWORKERS; i++) {
+		work_heap_init(&g_work[i]);
+	}
+
 	// Create high priority worker thread
 	g_work[HPWORK].pid = px4_task_spawn_cmd("hpwork",
 						SCHED_DEFAULT,
@@ -263,11 +160,9 @@ int work_hpthread(int argc, char *argv[])
 		sched_garbagecollection();
 #endif
 
-		/* Then process queued work.  We need to keep interrupts disabled while
-		 * we process items in the work list.
-		 */
+		/* Then process queued work, sleeping until the earliest deadline */
 
-		work_process(&g_work[HPWORK], HPWORK);
+		work_heap_process(&g_work[HPWORK], &_work_lock[HPWORK], CONFIG_SCHED_WORKPERIOD);
 	}
 
 	return PX4_OK; /* To keep some compilers happy */
@@ -289,11 +184,9 @@ int work_lpthread(int argc, char *argv[])
 
 		//sched_garbagecollection();
 
-		/* Then process queued work.  We need to keep interrupts disabled while
-		 * we process items in the work list.
-		 */
+		/* Then process queued work, sleeping until the earliest deadline */
 
-		work_process(&g_work[LPWORK], LPWORK);
+		work_heap_process(&g_work[LPWORK], &_work_lock[LPWORK], CONFIG_SCHED_WORKPERIOD);
 	}
 
 	return PX4_OK; /* To keep some compilers happy */
@@ -317,11 +210,9 @@ int work_usrthread(int argc, char *argv[])
 #endif
 
 	for (;;) {
-		/* Then process queued work.  We need to keep interrupts disabled while
-		 * we process items in the work list.
-		 */
+		/* Then process queued work, sleeping until the earliest deadline */
 
-		work_process(&g_work[USRWORK], USRWORK);
+		work_heap_process(&g_work[USRWORK], &_work_lock[USRWORK], CONFIG_SCHED_WORKPERIOD);
 	}
 
 	return PX4_OK; /* To keep some compilers happy */
@@ -60,7 +60,7 @@
 #include <drivers/device/ringbuffer.h>
 
 #include <board_config.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/LowPassFilter2pVector3.hpp>
 #include <lib/conversion/rotation.h>
 #include <VirtDevObj.hpp>
 
@@ -138,9 +138,7 @@ private:
 	perf_counter_t		_bad_registers;
 	perf_counter_t		_bad_values;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
+	math::LowPassFilter2pVector3	_accel_filter;
 
 	enum Rotation		_rotation;
 
@@ -260,9 +258,7 @@ ACCELSIM::ACCELSIM(const char *path, enum Rotation rotation) :
 	_accel_reschedules(perf_alloc(PC_COUNT, "sim_accel_resched")),
 	_bad_registers(perf_alloc(PC_COUNT, "sim_bad_registers")),
 	_bad_values(perf_alloc(PC_COUNT, "sim_bad_values")),
-	_accel_filter_x(ACCELSIM_ACCEL_DEFAULT_RATE, ACCELSIM_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(ACCELSIM_ACCEL_DEFAULT_RATE, ACCELSIM_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(ACCELSIM_ACCEL_DEFAULT_RATE, ACCELSIM_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_accel_filter(ACCELSIM_ACCEL_DEFAULT_RATE, ACCELSIM_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
 	_rotation(rotation),
 	_constant_accel_count(0),
 	_last_temperature(0)
@@ -528,7 +524,7 @@ ACCELSIM::devIOCTL(unsigned long cmd, unsigned long arg)
 					}
 
 					/* adjust filters */
-					accel_set_driver_lowpass_filter((float)ul_arg, _accel_filter_x.get_cutoff_freq());
+					accel_set_driver_lowpass_filter((float)ul_arg, _accel_filter.get_cutoff_freq());
 
 					bool want_start = (m_sample_interval_usecs == 0);
 
@@ -750,9 +746,7 @@ ACCELSIM::mag_set_range(unsigned max_ga)
 int
 ACCELSIM::accel_set_driver_lowpass_filter(float samplerate, float bandwidth)
 {
-	_accel_filter_x.set_cutoff_frequency(samplerate, bandwidth);
-	_accel_filter_y.set_cutoff_frequency(samplerate, bandwidth);
-	_accel_filter_z.set_cutoff_frequency(samplerate, bandwidth);
+	_accel_filter.set_cutoff_frequency(samplerate, bandwidth);
 
 	return OK;
 }
@@ -80,6 +80,29 @@ typedef struct pollfd px4_pollfd_struct_t;
 
 #define  PX4_STACK_OVERHEAD	0
 
+/* NuttX has no persistent poll sets, a set just remembers the array for poll() */
+typedef struct {
+	px4_pollfd_struct_t *fds;
+	nfds_t nfds;
+} px4_pollset_t;
+
+static inline int px4_pollset_init(px4_pollset_t *set, px4_pollfd_struct_t *fds, nfds_t nfds)
+{
+	set->fds = fds;
+	set->nfds = nfds;
+	return 0;
+}
+
+static inline int px4_pollset_wait(px4_pollset_t *set, int timeout)
+{
+	return _GLOBAL poll(set->fds, set->nfds, timeout);
+}
+
+static inline void px4_pollset_destroy(px4_pollset_t *set)
+{
+	(void)set;
+}
+
 #elif defined(__PX4_POSIX)
 
 #define  PX4_F_RDONLY O_RDONLY
@@ -102,12 +125,29 @@ typedef struct {
 	void   *priv;     	/* For use by drivers */
 } px4_pollfd_struct_t;
 
+/**
+ * Persistent poll set: the fds are set up with their devices once in
+ * px4_pollset_init() and stay registered until px4_pollset_destroy(), so
+ * each px4_pollset_wait() only re-checks the device state and blocks.
+ * The fds array must stay valid and its descriptors open for the lifetime
+ * of the set; revents are written back to it by px4_pollset_wait().
+ */
+typedef struct {
+	px4_pollfd_struct_t *fds;        /* Caller's array, receives revents */
+	px4_pollfd_struct_t *registered; /* Copies registered with the devices */
+	nfds_t               nfds;
+	px4_sem_t            sem;        /* Posted by the devices on new events */
+} px4_pollset_t;
+
 __EXPORT int 		px4_open(const char *path, int flags, ...);
 __EXPORT int 		px4_close(int fd);
 __EXPORT ssize_t	px4_read(int fd, void *buffer, size_t buflen);
 __EXPORT ssize_t	px4_write(int fd, const void *buffer, size_t buflen);
 __EXPORT int		px4_ioctl(int fd, int cmd, unsigned long arg);
 __EXPORT int		px4_poll(px4_pollfd_struct_t *fds, nfds_t nfds, int timeout);
+__EXPORT int		px4_pollset_init(px4_pollset_t *set, px4_pollfd_struct_t *fds, nfds_t nfds);
+__EXPORT int		px4_pollset_wait(px4_pollset_t *set, int timeout);
+__EXPORT void		px4_pollset_destroy(px4_pollset_t *set);
 __EXPORT int		px4_fsync(int fd);
 __EXPORT int		px4_access(const char *pathname, int mode);
 __EXPORT px4_task_t	px4_getpid(void);
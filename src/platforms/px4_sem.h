@@ -50,7 +50,7 @@
 #define sem_setprotocol(s,p)
 #endif
 
-#if defined(__PX4_DARWIN) || defined(__PX4_CYGWIN)
+#if defined(__PX4_DARWIN) || defined(__PX4_CYGWIN) || defined(ENABLE_LOCKSTEP_SCHEDULER)
 
 __BEGIN_DECLS
 
@@ -58,6 +58,7 @@ typedef struct {
 	pthread_mutex_t lock;
 	pthread_cond_t wait;
 	int value;
+	int wakeups; /* posts handed to blocked waiters but not yet taken */
 } px4_sem_t;
 
 __EXPORT int		px4_sem_init(px4_sem_t *s, int pshared, unsigned value);
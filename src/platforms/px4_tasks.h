@@ -43,6 +43,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __PX4_ROS
 
@@ -187,6 +188,34 @@ __EXPORT bool px4_task_is_running(const char *taskname);
 __EXPORT int px4_prctl(int option, const char *arg2, px4_task_t pid);
 #endif
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+/**
+ * Place threads whose name starts with name: pin them to the CPUs in cpu_mask
+ * (bit n for CPU n, 0 keeps the affinity) and run them as SCHED_FIFO with
+ * priority (negative keeps the priority). "*" matches every thread no other
+ * rule matches. Running threads move immediately, new ones when they set
+ * their name. Only supported on Linux.
+ * @return 0 on success, negative errno otherwise
+ */
+__EXPORT int px4_task_set_placement(const char *name, uint64_t cpu_mask, int priority);
+
+/** Apply the placement rule matching name to the calling thread **/
+__EXPORT void px4_task_apply_placement(const char *name);
+
+/** Show the task placement rules **/
+__EXPORT void px4_show_task_placement(void);
+
+/**
+ * Track the stack and heap usage of the calling thread: paints the unused
+ * part of its stack and, with glibc, counts its heap allocations.
+ * @param stack_size stack size argument the task was spawned with
+ */
+__EXPORT void px4_task_memory_register(const char *name, int stack_size);
+
+/** Show stack high-water marks, recommended stack sizes and heap usage per task **/
+__EXPORT void px4_show_task_memory(void);
+#endif
+
 /** return the name of the current task */
 __EXPORT const char *px4_get_taskname(void);
 
@@ -29,9 +29,87 @@ __EXPORT unsigned int sleep(unsigned int sec);
 
 __END_DECLS
 
+#elif defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+__BEGIN_DECLS
+
+/* follows the simulated clock once lockstep is active, see px4_lockstep_set_time() */
+__EXPORT int px4_clock_gettime(clockid_t clk_id, struct timespec *tp);
+
+__END_DECLS
+
+#define px4_clock_settime clock_settime
+
 #else
 
 #define px4_clock_gettime clock_gettime
 #define px4_clock_settime clock_settime
 
 #endif
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER) && !defined(__PX4_QURT)
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+
+__BEGIN_DECLS
+
+/**
+ * Advance the simulated time (in hrt microseconds) and wake every timed wait
+ * that expired. The first call switches the whole system from the host clock
+ * to the simulated clock; time never goes backwards.
+ */
+__EXPORT void px4_lockstep_set_time(uint64_t time_us);
+
+/** true once the simulator drives the clock */
+__EXPORT bool px4_lockstep_active(void);
+
+/** current simulated time, only valid if px4_lockstep_active() */
+__EXPORT uint64_t px4_lockstep_get_time(void);
+
+/**
+ * PX4 tasks are lockstep participants: the simulator waits for them to block
+ * before acknowledging a step. A task is counted as runnable from before it is
+ * created (px4_lockstep_task_spawning(), undone by px4_lockstep_task_spawn_failed()),
+ * and registers itself once it runs. Tasks waiting on the host (sockets, the
+ * simulator itself) must unregister.
+ */
+__EXPORT void px4_lockstep_task_spawning(void);
+__EXPORT void px4_lockstep_task_spawn_failed(void);
+__EXPORT void px4_lockstep_register_thread(void);
+__EXPORT void px4_lockstep_unregister_thread(void);
+
+/** block until every participant waits in px4_lockstep_cond_timedwait() */
+__EXPORT void px4_lockstep_wait_idle(void);
+
+/**
+ * pthread_cond_timedwait() on the simulated clock: the caller holds lock and
+ * wakes up on px4_lockstep_cond_broadcast() of cond or when the simulated time
+ * reaches time_us. UINT64_MAX waits without timeout and works before lockstep
+ * is active, the calling participant is counted as blocked meanwhile.
+ * @return 0 when signalled, ETIMEDOUT on timeout
+ */
+__EXPORT int px4_lockstep_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *lock, uint64_t time_us);
+
+/**
+ * pthread_cond_broadcast() which also counts the woken participants as runnable,
+ * must be called with the lock of the waiters held.
+ */
+__EXPORT int px4_lockstep_cond_broadcast(pthread_cond_t *cond);
+
+/** usleep() on the simulated clock, usleep() and sleep() of the whole binary end up here */
+__EXPORT int px4_usleep(useconds_t usec);
+
+/** usleep() on the host clock, for the threads driving the simulated one */
+__EXPORT int system_usleep(useconds_t usec);
+
+__END_DECLS
+
+#else
+
+#define px4_usleep usleep
+#define system_usleep usleep
+
+#endif
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_trace.h
+ *
+ * Timeline tracing of publications, poll wakeups, work queue items and perf
+ * regions into a ring buffer, exported in the Chrome trace event format
+ * (chrome://tracing, ui.perfetto.dev). See the trace command.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <px4_defines.h>
+
+typedef enum {
+	PX4_TRACE_PUBLISH,	/**< instant: topic data was written */
+	PX4_TRACE_WAKEUP,	/**< instant: a poll returned because of this device */
+	PX4_TRACE_PERF,		/**< duration: a perf_begin/perf_end region */
+	PX4_TRACE_WORK		/**< duration: a work queue item ran */
+} px4_trace_type_t;
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+
+__BEGIN_DECLS
+
+/** true while tracing, checked before every record */
+__EXPORT extern bool px4_trace_enabled;
+
+/**
+ * Start recording into a ring of num_events events, the oldest are overwritten.
+ * @return 0 on success, negative errno otherwise
+ */
+__EXPORT int px4_trace_start(unsigned num_events);
+
+__EXPORT void px4_trace_stop(void);
+
+/**
+ * Stop recording and write the ring to path as Chrome trace event JSON.
+ * @return number of events written, negative errno on failure
+ */
+__EXPORT int px4_trace_dump(const char *path);
+
+__EXPORT void px4_trace_status(void);
+
+/** name must stay valid until the trace is dumped; start is in hrt time, 0 for now */
+__EXPORT void px4_trace_record(px4_trace_type_t type, const char *name, uint64_t start, uint32_t duration);
+
+/** like px4_trace_record(), named after the symbol of function when the trace is dumped */
+__EXPORT void px4_trace_record_function(px4_trace_type_t type, const void *function, uint64_t start,
+					uint32_t duration);
+
+__END_DECLS
+
+static inline void px4_trace_instant(px4_trace_type_t type, const char *name)
+{
+	if (__atomic_load_n(&px4_trace_enabled, __ATOMIC_ACQUIRE)) {
+		px4_trace_record(type, name, 0, 0);
+	}
+}
+
+static inline void px4_trace_duration(px4_trace_type_t type, const char *name, uint64_t start, uint32_t duration)
+{
+	if (__atomic_load_n(&px4_trace_enabled, __ATOMIC_ACQUIRE)) {
+		px4_trace_record(type, name, start, duration);
+	}
+}
+
+static inline void px4_trace_function(px4_trace_type_t type, const void *function, uint64_t start, uint32_t duration)
+{
+	if (__atomic_load_n(&px4_trace_enabled, __ATOMIC_ACQUIRE)) {
+		px4_trace_record_function(type, function, start, duration);
+	}
+}
+
+#else
+
+static inline void px4_trace_instant(px4_trace_type_t type, const char *name) {}
+static inline void px4_trace_duration(px4_trace_type_t type, const char *name, uint64_t start, uint32_t duration) {}
+static inline void px4_trace_function(px4_trace_type_t type, const void *function, uint64_t start, uint32_t duration) {}
+
+#endif
@@ -44,11 +44,14 @@
 #elif defined(__PX4_POSIX)
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 #include <px4_platform_types.h>
 
 #ifdef __PX4_QURT
 #include <dspal_types.h>
+#else
+#include <pthread.h>
 #endif
 
 __BEGIN_DECLS
@@ -57,9 +60,19 @@ __BEGIN_DECLS
 #define LPWORK 1
 #define NWORKERS 2
 
+struct work_s;
+
 struct wqueue_s {
-	pid_t             pid; /* The task ID of the worker thread */
-	struct dq_queue_s q;   /* The queue of pending work */
+	pid_t             pid;          /* The task ID of the worker thread */
+	struct work_s   **heap;         /* Pending work, binary min-heap ordered by deadline */
+	unsigned          count;        /* Number of pending work items */
+	unsigned          capacity;     /* Number of allocated heap slots */
+	uint32_t          seq;          /* Enqueue counter, keeps FIFO order for equal deadlines */
+#ifndef __PX4_QURT
+	pthread_mutex_t   wake_lock;    /* Protects wake_pending */
+	pthread_cond_t    wake;         /* Signalled when the earliest deadline moves forward */
+	bool              wake_pending; /* Set by a wakeup that arrived before the worker waited */
+#endif
 };
 
 extern struct wqueue_s g_work[NWORKERS];
@@ -69,11 +82,13 @@ extern struct wqueue_s g_work[NWORKERS];
 typedef void (*worker_t)(void *arg);
 
 struct work_s {
-	struct dq_entry_s dq;  /* Implements a doubly linked list */
 	worker_t  worker;      /* Work callback */
 	void *arg;             /* Callback argument */
 	uint64_t  qtime;       /* Time work queued */
 	uint32_t  delay;       /* Delay until work performed */
+	uint64_t  deadline;    /* Absolute time (usec) at which the work is ready */
+	uint32_t  seq;         /* Enqueue order, breaks deadline ties */
+	uint32_t  heap_index;  /* Position in the pending work heap */
 };
 
 /****************************************************************************
@@ -157,6 +157,66 @@ fail:
 	return -1;
 }
 
+static int
+test_range(void)
+{
+	static struct mission_item_s items[NUM_MISSIONS_TEST];
+	struct mission_item_s item;
+
+	for (unsigned i = 0; i < NUM_MISSIONS_TEST; i++) {
+		memset(&items[i], i, sizeof(items[i]));
+	}
+
+	hrt_abstime wstart = hrt_absolute_time();
+
+	if (dm_write_range(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, NUM_MISSIONS_TEST, DM_PERSIST_VOLATILE, items,
+			   sizeof(items[0])) != NUM_MISSIONS_TEST) {
+		PX4_ERR("range write failed");
+		return -1;
+	}
+
+	hrt_abstime rstart = hrt_absolute_time();
+
+	/* the items are the same as written one by one */
+	for (unsigned i = 0; i < NUM_MISSIONS_TEST; i++) {
+		if (dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item)) != sizeof(item) ||
+		    memcmp(&item, &items[i], sizeof(item)) != 0) {
+			PX4_ERR("range write verification failed, index %d", i);
+			return -1;
+		}
+	}
+
+	memset(items, 0, sizeof(items));
+	hrt_abstime rrange = hrt_absolute_time();
+
+	if (dm_read_range(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, NUM_MISSIONS_TEST, items, sizeof(items[0])) != NUM_MISSIONS_TEST) {
+		PX4_ERR("range read failed");
+		return -1;
+	}
+
+	hrt_abstime rend = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_MISSIONS_TEST; i++) {
+		memset(&item, i, sizeof(item));
+
+		if (memcmp(&item, &items[i], sizeof(item)) != 0) {
+			PX4_ERR("range read verification failed, index %d", i);
+			return -1;
+		}
+	}
+
+	/* a range stops at the end of the item type */
+	if (dm_read_range(DM_KEY_SAFE_POINTS, DM_KEY_SAFE_POINTS_MAX - 1, 2, items, sizeof(struct mission_save_point_s)) > 1) {
+		PX4_ERR("range read past the end failed");
+		return -1;
+	}
+
+	PX4_INFO("range pass, io time write %lluus, read %lluus, %d single reads %lluus",
+		 rstart - wstart, rend - rrange, NUM_MISSIONS_TEST, rrange - rstart);
+
+	return 0;
+}
+
 int test_dataman(int argc, char *argv[])
 {
 	int i = 0;
@@ -234,5 +294,12 @@ int test_dataman(int argc, char *argv[])
 		}
 	}
 
+	if (test_range() != 0) {
+		return -1;
+	}
+
+	/* the range test items are volatile */
+	dm_restart(DM_INIT_REASON_POWER_ON);
+
 	return 0;
 }
@@ -51,6 +51,8 @@
 #include <string.h>
 #include <time.h>
 #include <mathlib/mathlib.h>
+#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/LowPassFilter2pVector3.hpp>
 #include <systemlib/err.h>
 #include <drivers/drv_hrt.h>
 
@@ -73,6 +75,7 @@ private:
 	bool testQuaternionfrom_dcm();
 	bool testQuaternionfrom_euler();
 	bool testQuaternionRotate();
+	bool testLowPassFilter2pVector3();
 };
 
 #define TEST_OP(_title, _op) { unsigned int n = 30000; hrt_abstime t0, t1; t0 = hrt_absolute_time(); for (unsigned int j = 0; j < n; j++) { _op; }; t1 = hrt_absolute_time(); PX4_INFO(_title ": %.6fus", (double)(t1 - t0) / n); }
@@ -419,6 +422,58 @@ bool MathlibTest::testQuaternionRotate()
 	return true;
 }
 
+bool MathlibTest::testLowPassFilter2pVector3()
+{
+	const float sample_freq = 1000.0f;
+
+	// the low pass has to match the scalar filter bit for bit on every axis
+	LowPassFilter2pVector3 filter(sample_freq, 30.0f);
+	LowPassFilter2p filter_scalar[3] = {{sample_freq, 30.0f}, {sample_freq, 30.0f}, {sample_freq, 30.0f}};
+
+	for (unsigned i = 0; i < 200; i++) {
+		float samples[2][3];
+
+		for (unsigned n = 0; n < 2; n++) {
+			for (unsigned axis = 0; axis < 3; axis++) {
+				samples[n][axis] = sinf(0.01f * (2 * i + n) * (axis + 1)) + axis;
+			}
+		}
+
+		filter.apply(samples, 2);
+
+		for (unsigned n = 0; n < 2; n++) {
+			for (unsigned axis = 0; axis < 3; axis++) {
+				float expected = filter_scalar[axis].apply(sinf(0.01f * (2 * i + n) * (axis + 1)) + axis);
+				ut_assert("low pass differs from scalar filter", samples[n][axis] == expected);
+			}
+		}
+	}
+
+	// a notch removes its center frequency and passes DC
+	LowPassFilter2pVector3 notch(sample_freq, 0.0f);
+	ut_assert("notch setup failed", notch.set_notch_frequency(0, 100.0f, 20.0f));
+	ut_assert("invalid notch accepted", !notch.set_notch_frequency(LowPassFilter2pVector3::MAX_NOTCH_STAGES, 100.0f, 20.0f));
+
+	float amplitude = 0.0f;
+	float sample[3] = {};
+
+	for (unsigned i = 0; i < 2000; i++) {
+		sample[0] = sinf(2.0f * M_PI_F * 100.0f * i / sample_freq);
+		sample[1] = 1.0f;
+		sample[2] = 0.0f;
+		notch.apply(sample);
+
+		if (i > 1000) {
+			amplitude = math::max(amplitude, fabsf(sample[0]));
+		}
+	}
+
+	ut_assert("notch does not attenuate", amplitude < 0.01f);
+	ut_assert("notch changes DC", fabsf(sample[1] - 1.0f) < 1e-3f);
+
+	return true;
+}
+
 bool MathlibTest::run_tests()
 {
 	ut_run_test(testVector2);
@@ -432,6 +487,7 @@ bool MathlibTest::run_tests()
 	ut_run_test(testQuaternionfrom_dcm);
 	ut_run_test(testQuaternionfrom_euler);
 	ut_run_test(testQuaternionRotate);
+	ut_run_test(testLowPassFilter2pVector3);
 
 	return (_tests_failed == 0);
 }
@@ -51,9 +51,11 @@
 #include <time.h>
 #include <limits.h>
 #include <math.h>
+#include <float.h>
 
 #include <systemlib/err.h>
 #include <lib/mixer/mixer.h>
+#include <mathlib/math/Limits.hpp>
 #include <systemlib/pwm_limit/pwm_limit.h>
 #include <drivers/drv_hrt.h>
 #include <drivers/drv_pwm_output.h>
@@ -66,6 +68,9 @@
 
 #include <unit_test.h>
 
+// rotor tables of the geometries, generated by px_generate_mixers.py
+#include "mixer_multirotor_normalized.generated.h"
+
 static int	mixer_callback(uintptr_t handle,
 			       uint8_t control_group,
 			       uint8_t control_index,
@@ -116,6 +121,9 @@ private:
 	bool loadQuadTest();
 	bool loadComplexTest();
 	bool loadAllTest();
+	bool multirotorEquivalenceTest();
+	bool allocationMixerTest();
+	bool allocationMixerPriorityTest();
 	bool load_mixer(const char *filename, unsigned expected_count, bool verbose = false);
 	bool load_mixer(const char *filename, const char *buf, unsigned loaded, unsigned expected_count,
 			const unsigned chunk_size, bool verbose);
@@ -137,6 +145,9 @@ bool MixerTest::run_tests()
 	ut_run_test(loadComplexTest);
 	ut_run_test(loadAllTest);
 	ut_run_test(mixerTest);
+	ut_run_test(multirotorEquivalenceTest);
+	ut_run_test(allocationMixerTest);
+	ut_run_test(allocationMixerPriorityTest);
 
 	return (_tests_failed == 0);
 }
@@ -235,6 +246,316 @@ bool MixerTest::loadAllTest()
 	return true;
 }
 
+/**
+ * Reference implementation of the multirotor mixing strategy, using the rotor table row by row.
+ * Used to check that the structure-of-arrays mixer core in MultirotorMixer::mix() yields the same outputs.
+ */
+static void
+multirotor_mix_reference(const MultirotorMixer::Rotor *rotors, unsigned rotor_count, float roll, float pitch,
+			 float yaw, float thrust, float idle_speed, float thrust_factor, float *outputs)
+{
+	float min_out = 1.0f;
+	float max_out = 0.0f;
+	float thrust_increase_factor = 1.5f;
+	float thrust_decrease_factor = 0.6f;
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float out = roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale + thrust * rotors[i].thrust_scale;
+
+		if (out < min_out) {
+			min_out = out;
+		}
+
+		if (out > max_out) {
+			max_out = out;
+		}
+
+		outputs[i] = out;
+	}
+
+	float boost = 0.0f;
+	float roll_pitch_scale = 1.0f;
+
+	if (min_out < 0.0f && max_out < 1.0f && -min_out <= 1.0f - max_out) {
+		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
+
+		if (max_thrust_diff >= -min_out) {
+			boost = -min_out;
+
+		} else {
+			boost = max_thrust_diff;
+			roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+		}
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out >= max_out - 1.0f) {
+		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
+
+		if (max_thrust_diff >= max_out - 1.0f) {
+			boost = -(max_out - 1.0f);
+
+		} else {
+			boost = -max_thrust_diff;
+			roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+		}
+
+	} else if (min_out < 0.0f && max_out < 1.0f && -min_out > 1.0f - max_out) {
+		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
+		boost = math::constrain(-min_out - (1.0f - max_out) / 2.0f, 0.0f, max_thrust_diff);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out < max_out - 1.0f) {
+		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
+		boost = math::constrain(-(max_out - 1.0f - min_out) / 2.0f, -max_thrust_diff, 0.0f);
+		roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+
+	} else if (min_out < 0.0f && max_out > 1.0f) {
+		boost = math::constrain(-(max_out - 1.0f + min_out) / 2.0f, thrust_decrease_factor * thrust - thrust,
+					thrust_increase_factor * thrust - thrust);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+	}
+
+	float thrust_reduction = 0.0f;
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float out = (roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale) * roll_pitch_scale +
+			    yaw * rotors[i].yaw_scale + (thrust + boost) * rotors[i].thrust_scale;
+
+		if (out < 0.0f) {
+			if (fabsf(rotors[i].yaw_scale) <= FLT_EPSILON) {
+				yaw = 0.0f;
+
+			} else {
+				yaw = -((roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale) *
+					roll_pitch_scale + thrust + boost) / rotors[i].yaw_scale;
+			}
+
+		} else if (out > 1.0f) {
+			float prop_reduction = fminf(0.15f, out - 1.0f);
+			thrust_reduction = fmaxf(thrust_reduction, prop_reduction);
+
+			if (fabsf(rotors[i].yaw_scale) <= FLT_EPSILON) {
+				yaw = 0.0f;
+
+			} else {
+				yaw = (1.0f - ((roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale) *
+					       roll_pitch_scale + (thrust - thrust_reduction) + boost)) / rotors[i].yaw_scale;
+			}
+		}
+	}
+
+	thrust -= thrust_reduction;
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		outputs[i] = (roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale) * roll_pitch_scale +
+			     yaw * rotors[i].yaw_scale + (thrust + boost) * rotors[i].thrust_scale;
+
+		if (thrust_factor > 0.0f) {
+			outputs[i] = -(1.0f - thrust_factor) / (2.0f * thrust_factor) + sqrtf((1.0f - thrust_factor) *
+					(1.0f - thrust_factor) / (4.0f * thrust_factor * thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
+							thrust_factor));
+		}
+
+		outputs[i] = math::constrain(idle_speed + (outputs[i] * (1.0f - idle_speed)), idle_speed, 1.0f);
+	}
+}
+
+bool MixerTest::multirotorEquivalenceTest()
+{
+	const unsigned iterations = 2000;
+	const float thrust_factors[] = { 0.0f, 0.3f };
+	const float idle_speed = 0.1f;
+	const float tolerance = 1e-5f;
+
+	srand(0x1234);
+
+	for (MultirotorGeometryUnderlyingType geometry = 0;
+	     geometry < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY; geometry++) {
+
+		const unsigned rotor_count = _config_rotor_count[geometry];
+
+		for (unsigned t = 0; t < sizeof(thrust_factors) / sizeof(thrust_factors[0]); t++) {
+			MultirotorMixer mixer(mixer_callback, 0, (MultirotorGeometry)geometry, 1.0f, 1.0f, 1.0f, idle_speed);
+
+			for (unsigned n = 0; n < iterations; n++) {
+				// random demands, exceeding the unit range on purpose to exercise the saturation handling
+				for (unsigned i = 0; i < 3; i++) {
+					actuator_controls[i] = 2.4f * ((float)rand() / RAND_MAX) - 1.2f;
+				}
+
+				actuator_controls[3] = 1.2f * ((float)rand() / RAND_MAX) - 0.1f;
+
+				float outputs[output_max * 2];
+				float outputs_ref[output_max * 2];
+
+				mixer.set_thrust_factor(thrust_factors[t]);
+				unsigned mixed = mixer.mix(outputs, sizeof(outputs) / sizeof(outputs[0]));
+
+				ut_compare("rotor count", mixed, rotor_count);
+
+				multirotor_mix_reference(_config_index[geometry], rotor_count,
+							 math::constrain(actuator_controls[0], -1.0f, 1.0f),
+							 math::constrain(actuator_controls[1], -1.0f, 1.0f),
+							 math::constrain(actuator_controls[2], -1.0f, 1.0f),
+							 math::constrain(actuator_controls[3], 0.0f, 1.0f),
+							 -1.0f + idle_speed * 2.0f, thrust_factors[t], outputs_ref);
+
+				for (unsigned i = 0; i < rotor_count; i++) {
+					if (fabsf(outputs[i] - outputs_ref[i]) > tolerance) {
+						PX4_ERR("geometry %s rotor %u: %.6f, expected %.6f", _config_key[geometry], i,
+							(double)outputs[i], (double)outputs_ref[i]);
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MixerTest::allocationMixerTest()
+{
+	const unsigned iterations = 2000;
+	const float idle_speed = 0.1f;
+	const float tolerance = 1e-5f;
+	const float budget_us = 125.0f;	// one cycle at 8 kHz
+
+	/* the allocation mixer is loaded from the same definition as the multirotor mixer */
+	const char *text = "A: 4x 10000 10000 10000 0\n";
+	unsigned text_length = strlen(text);
+	mixer_group.reset();
+	ut_compare("load allocation mixer", mixer_group.load_from_buf(text, text_length), 0);
+	ut_compare("allocation mixer count", mixer_group.count(), 1);
+	mixer_group.reset();
+
+	srand(0x4321);
+
+	for (MultirotorGeometryUnderlyingType geometry = 0;
+	     geometry < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY; geometry++) {
+
+		const unsigned rotor_count = _config_rotor_count[geometry];
+
+		AllocationMixer mixer(mixer_callback, 0, (MultirotorGeometry)geometry, 1.0f, 1.0f, 1.0f, idle_speed);
+		MultirotorMixer reference(mixer_callback, 0, (MultirotorGeometry)geometry, 1.0f, 1.0f, 1.0f, idle_speed);
+
+		hrt_abstime elapsed_max = 0;
+		hrt_abstime elapsed_total = 0;
+
+		for (unsigned n = 0; n < iterations; n++) {
+			// every other demand saturates, the others stay well within range
+			const bool saturating = (n % 2) == 1;
+
+			for (unsigned i = 0; i < 3; i++) {
+				actuator_controls[i] = (saturating ? 2.4f : 0.2f) * ((float)rand() / RAND_MAX - 0.5f);
+			}
+
+			actuator_controls[3] = saturating ? (float)rand() / RAND_MAX : 0.4f + 0.2f * ((float)rand() / RAND_MAX);
+
+			float outputs[output_max * 2];
+			float outputs_ref[output_max * 2];
+
+			hrt_abstime start = hrt_absolute_time();
+			unsigned mixed = mixer.mix(outputs, sizeof(outputs) / sizeof(outputs[0]));
+			hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+			elapsed_max = (elapsed > elapsed_max) ? elapsed : elapsed_max;
+			elapsed_total += elapsed;
+
+			ut_compare("rotor count", mixed, rotor_count);
+
+			reference.mix(outputs_ref, sizeof(outputs_ref) / sizeof(outputs_ref[0]));
+
+			for (unsigned i = 0; i < rotor_count; i++) {
+				ut_assert("output in range", PX4_ISFINITE(outputs[i]) &&
+					  outputs[i] >= -1.0f + idle_speed * 2.0f - tolerance && outputs[i] <= 1.0f + tolerance);
+
+				// without saturation, both mixers apply the plain rotor mix
+				if (!saturating && fabsf(outputs[i] - outputs_ref[i]) > tolerance) {
+					PX4_ERR("geometry %s rotor %u: %.6f, expected %.6f", _config_key[geometry], i,
+						(double)outputs[i], (double)outputs_ref[i]);
+					return false;
+				}
+			}
+		}
+
+		const float elapsed_avg = (float)elapsed_total / iterations;
+
+		PX4_INFO("allocation mixer %s: %.2f us average, %u us max", _config_key[geometry], (double)elapsed_avg,
+			 (unsigned)elapsed_max);
+
+		ut_assert("average mix time within budget", elapsed_avg < budget_us);
+	}
+
+	return true;
+}
+
+bool MixerTest::allocationMixerPriorityTest()
+{
+	const unsigned rotor_count = 4;
+
+	/* roll, pitch, yaw, thrust: roll and pitch are feasible, yaw on top saturates the rotors */
+	const float demands[][4] = {
+		{ 0.3f, 0.2f, 0.8f, 0.5f },
+		{ 0.6f, 0.0f, 0.5f, 0.5f },
+		{ 0.2f, 0.2f, -0.9f, 0.2f },
+	};
+
+	MultirotorGeometryUnderlyingType geometry = 0;
+
+	while (geometry < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY &&
+	       strcmp(_config_key[geometry], "4x") != 0) {
+		geometry++;
+	}
+
+	ut_assert("quad x geometry", geometry < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY);
+
+	AllocationMixer mixer(mixer_callback, 0, (MultirotorGeometry)geometry, 1.0f, 1.0f, 1.0f, 0.0f);
+
+	for (unsigned n = 0; n < sizeof(demands) / sizeof(demands[0]); n++) {
+		for (unsigned k = 0; k < 4; k++) {
+			actuator_controls[k] = demands[n][k];
+		}
+
+		float outputs[output_max];
+		ut_compare("rotor count", mixer.mix(outputs, output_max), rotor_count);
+
+		bool saturated = false;
+
+		for (unsigned i = 0; i < rotor_count; i++) {
+			saturated |= (outputs[i] < -1.0f + 1e-3f) || (outputs[i] > 1.0f - 1e-3f);
+		}
+
+		ut_assert("outputs saturated", saturated);
+
+		/* the axes achieved by the outputs, the quad x rotor mix has orthogonal columns */
+		float achieved[4];
+
+		for (unsigned k = 0; k < 4; k++) {
+			float dot = 0.0f;
+			float norm = 0.0f;
+
+			for (unsigned i = 0; i < rotor_count; i++) {
+				const MultirotorMixer::Rotor &rotor = _config_quad_x[i];
+				const float scales[4] = { rotor.roll_scale, rotor.pitch_scale, rotor.yaw_scale, rotor.thrust_scale };
+				dot += scales[k] * (outputs[i] + 1.0f) * 0.5f;
+				norm += scales[k] * scales[k];
+			}
+
+			achieved[k] = dot / norm;
+		}
+
+		PX4_INFO("demand %.2f %.2f %.2f %.2f, achieved %.2f %.2f %.2f %.2f",
+			 (double)demands[n][0], (double)demands[n][1], (double)demands[n][2], (double)demands[n][3],
+			 (double)achieved[0], (double)achieved[1], (double)achieved[2], (double)achieved[3]);
+
+		ut_assert("roll tracked", fabsf(achieved[0] - demands[n][0]) < 0.01f);
+		ut_assert("pitch tracked", fabsf(achieved[1] - demands[n][1]) < 0.01f);
+		ut_assert("yaw given up", fabsf(achieved[2] - demands[n][2]) > 0.3f);
+	}
+
+	return true;
+}
+
 bool MixerTest::load_mixer(const char *filename, unsigned expected_count, bool verbose)
 {
 	char buf[2048];
@@ -0,0 +1,555 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_mixer_bench.cpp
+ *
+ * Mixer benchmark and text parser fuzzer.
+ *
+ * Runs every multirotor geometry and every mixer file in the ROMFS against a canned
+ * flight profile and random control inputs, and reports the mean time per mix, the worst
+ * case latency of a single mix and which saturation flags have been exercised.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include <lib/mixer/mixer.h>
+#include <drivers/drv_hrt.h>
+
+#include "tests_main.h"
+
+#include <unit_test.h>
+
+// This file is generated by the px_generate_mixers.py script which is invoked during the build process
+#include "mixer_multirotor_normalized.generated.h"
+
+#ifndef PATH_MAX
+#ifdef __PX4_NUTTX
+#define PATH_MAX 512
+#else
+#define PATH_MAX 4096
+#endif
+#endif
+
+#if defined(CONFIG_ARCH_BOARD_SITL)
+#define MIXER_ONBOARD_PATH "ROMFS/px4fmu_common/mixers"
+#else
+#define MIXER_ONBOARD_PATH "/etc/mixers"
+#endif
+
+namespace
+{
+
+const unsigned control_max = 8;
+const unsigned output_max = 32;
+
+/**
+ * Inputs are generated in blocks before the timer is started, so that the time of the
+ * random number generator is not measured.
+ */
+const unsigned input_block = 64;
+float bench_inputs[input_block][control_max];
+const float *bench_controls = bench_inputs[0];
+
+int bench_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
+{
+	if (control_index >= control_max) {
+		control = 0.0f;
+		return -1;
+	}
+
+	/* all control groups see the same inputs */
+	control = bench_controls[control_index];
+	return 0;
+}
+
+/**
+ * Canned flight profile: roll, pitch, yaw, thrust setpoints covering hover, aggressive
+ * manoeuvres, full throttle climbs and idle descents.
+ */
+const float flight_profile[][4] = {
+	{  0.00f,  0.00f,  0.00f, 0.00f },	// armed, idle
+	{  0.00f,  0.00f,  0.00f, 0.30f },	// spool up
+	{  0.02f, -0.01f,  0.00f, 0.50f },	// hover
+	{ -0.03f,  0.02f,  0.01f, 0.52f },
+	{  0.40f,  0.00f,  0.00f, 0.55f },	// roll step
+	{ -0.60f,  0.10f,  0.05f, 0.55f },
+	{  0.00f,  0.80f,  0.00f, 0.60f },	// pitch step
+	{  0.10f, -0.90f,  0.10f, 0.60f },
+	{  0.00f,  0.00f,  0.70f, 0.50f },	// yaw spin
+	{  0.00f,  0.00f, -1.00f, 0.50f },
+	{  0.05f,  0.05f,  0.00f, 1.00f },	// full throttle climb
+	{  0.50f, -0.50f,  0.30f, 0.95f },
+	{  0.00f,  0.00f,  0.00f, 0.05f },	// idle descent
+	{ -0.40f,  0.40f, -0.30f, 0.08f },
+	{  1.00f,  1.00f,  1.00f, 1.00f },	// everything saturated
+	{ -1.00f, -1.00f, -1.00f, 0.00f },
+};
+
+const unsigned flight_profile_length = sizeof(flight_profile) / sizeof(flight_profile[0]);
+
+/**
+ * Valid mixer definitions used as seeds for the fuzzer.
+ */
+const char *const fuzz_seeds[] = {
+	"R: 4x 10000 10000 10000 0\n",
+	"R: 6+ 7500 7500 5000 1000\n",
+	"R: 8cw 10000 10000 10000 0\n",
+	"M: 1\nO: 10000 10000 0 -10000 10000\nS: 3 5 10000 10000 0 -10000 10000\n",
+	"M: 2\nO: 10000 10000 0 -10000 10000\nS: 0 0 -6000 -6000 0 -10000 10000\nS: 0 1 6500 6500 0 -10000 10000\n",
+	"M: 0\nO: 10000 10000 0 -10000 10000\n",
+};
+
+const unsigned fuzz_seed_count = sizeof(fuzz_seeds) / sizeof(fuzz_seeds[0]);
+
+/* characters the fuzzer inserts, weighted towards the ones meaningful to the parsers */
+const char fuzz_alphabet[] = "RMOSZAH: -0123456789\n\r\t4x+e.";
+
+}
+
+class MixerBench : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool geometryBenchTest();
+	bool romfsBenchTest();
+	bool fuzzMultirotorTextTest();
+	bool fuzzSimpleTextTest();
+
+	/**
+	 * Benchmark a loaded mixer group.
+	 *
+	 * @param name			Name printed with the results.
+	 * @param group			The mixers to run.
+	 * @param saturation		Set to all saturation flags reported during the run.
+	 * @return			false if a mixer produced an invalid output.
+	 */
+	bool bench(const char *name, MixerGroup &group, uint16_t &saturation);
+
+	/**
+	 * Create a random mutation of a fuzzer seed in buf, always null terminated.
+	 *
+	 * @return			Length of the mutated text.
+	 */
+	unsigned mutate(char *buf, unsigned buf_size);
+
+	static const unsigned _random_iterations = 5000;
+	static const unsigned _fuzz_iterations = 20000;
+	static const unsigned _budget_us = 125;		///< one cycle at 8 kHz
+};
+
+bool MixerBench::run_tests()
+{
+	ut_run_test(geometryBenchTest);
+	ut_run_test(romfsBenchTest);
+	ut_run_test(fuzzMultirotorTextTest);
+	ut_run_test(fuzzSimpleTextTest);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test_c(test_mixer_bench, MixerBench)
+
+bool MixerBench::bench(const char *name, MixerGroup &group, uint16_t &saturation)
+{
+	float outputs[output_max];
+	unsigned mixes = 0;
+	hrt_abstime elapsed_total = 0;
+	hrt_abstime elapsed_max = 0;
+
+	saturation = 0;
+
+	/* the first pass over all inputs runs back to back for the mean, the second measures every single mix */
+	for (unsigned pass = 0; pass < 2; pass++) {
+		const bool single = (pass == 1);
+		const unsigned input_count = flight_profile_length + _random_iterations;
+
+		srand(0x6d6978);
+
+		for (unsigned block = 0; block < input_count; block += input_block) {
+			const unsigned block_length = (input_count - block < input_block) ? input_count - block : input_block;
+
+			for (unsigned k = 0; k < block_length; k++) {
+				const unsigned n = block + k;
+
+				if (n < flight_profile_length) {
+					memset(bench_inputs[k], 0, sizeof(bench_inputs[k]));
+					memcpy(bench_inputs[k], flight_profile[n], sizeof(flight_profile[n]));
+
+				} else {
+					// random demands, exceeding the unit range on purpose to exercise the saturation handling
+					for (unsigned i = 0; i < control_max; i++) {
+						bench_inputs[k][i] = 2.4f * ((float)rand() / RAND_MAX) - 1.2f;
+					}
+
+					bench_inputs[k][3] = 1.2f * ((float)rand() / RAND_MAX) - 0.1f;
+				}
+			}
+
+			hrt_abstime block_start = hrt_absolute_time();
+
+			for (unsigned k = 0; k < block_length; k++) {
+				bench_controls = bench_inputs[k];
+
+				hrt_abstime start = single ? hrt_absolute_time() : 0;
+
+				unsigned mixed = group.mix(outputs, output_max);
+
+				if (single) {
+					hrt_abstime elapsed = hrt_elapsed_time(&start);
+					elapsed_max = (elapsed > elapsed_max) ? elapsed : elapsed_max;
+
+					saturation |= group.get_saturation_status();
+
+					for (unsigned i = 0; i < mixed; i++) {
+						if (!PX4_ISFINITE(outputs[i])) {
+							PX4_ERR("%s: output %u not finite for input %u", name, i, block + k);
+							return false;
+						}
+					}
+				}
+			}
+
+			if (!single) {
+				elapsed_total += hrt_elapsed_time(&block_start);
+				mixes += block_length;
+			}
+		}
+	}
+
+	const float ns_per_mix = (mixes > 0) ? 1000.0f * elapsed_total / mixes : 0.0f;
+
+	/* bits 1..10 of the multirotor saturation status, bit 0 only flags it as valid */
+	unsigned flags_seen = 0;
+
+	for (unsigned bit = 1; bit <= 10; bit++) {
+		if (saturation & (1 << bit)) {
+			flags_seen++;
+		}
+	}
+
+	PX4_INFO("%-28s %8.1f ns/mix  worst %4u us  saturation %2u/10 (0x%04x)", name, (double)ns_per_mix,
+		 (unsigned)elapsed_max, flags_seen, saturation);
+
+	ut_assert("mean mix time within budget", ns_per_mix < _budget_us * 1000.0f);
+
+	return true;
+}
+
+bool MixerBench::geometryBenchTest()
+{
+	const char tags[] = { 'R', 'A' };
+
+	for (MultirotorGeometryUnderlyingType geometry = 0;
+	     geometry < (MultirotorGeometryUnderlyingType)MultirotorGeometry::MAX_GEOMETRY; geometry++) {
+
+		for (unsigned t = 0; t < sizeof(tags); t++) {
+			char text[64];
+			snprintf(text, sizeof(text), "%c: %s 10000 10000 10000 0\n", tags[t], _config_key[geometry]);
+
+			MixerGroup group(bench_callback, 0);
+			unsigned text_length = strlen(text);
+
+			if (group.load_from_buf(text, text_length) != 0 || group.count() != 1) {
+				PX4_ERR("failed to load '%s'", text);
+				return false;
+			}
+
+			char name[32];
+			snprintf(name, sizeof(name), "%s %s", (tags[t] == 'R') ? "multirotor" : "allocation", _config_key[geometry]);
+
+			uint16_t saturation;
+
+			if (!bench(name, group, saturation)) {
+				return false;
+			}
+
+			/* the inputs must exercise every saturation flag the geometry can raise */
+			MultirotorMixer::saturation_status expected;
+			expected.value = 0;
+			expected.flags.valid = true;
+			expected.flags.motor_pos = true;
+			expected.flags.motor_neg = true;
+			expected.flags.thrust_pos = true;
+			expected.flags.thrust_neg = true;
+
+			for (unsigned i = 0; i < _config_rotor_count[geometry]; i++) {
+				const MultirotorMixer::Rotor &rotor = _config_index[geometry][i];
+
+				if (fabsf(rotor.roll_scale) > 0.0f) {
+					expected.flags.roll_pos = true;
+					expected.flags.roll_neg = true;
+				}
+
+				if (fabsf(rotor.pitch_scale) > 0.0f) {
+					expected.flags.pitch_pos = true;
+					expected.flags.pitch_neg = true;
+				}
+
+				if (fabsf(rotor.yaw_scale) > 0.0f) {
+					expected.flags.yaw_pos = true;
+					expected.flags.yaw_neg = true;
+				}
+			}
+
+			if ((saturation & expected.value) != expected.value) {
+				PX4_ERR("%s: saturation flags 0x%04x not exercised", name, expected.value & ~saturation);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MixerBench::romfsBenchTest()
+{
+	DIR *dp = opendir(MIXER_ONBOARD_PATH);
+
+	if (dp == nullptr) {
+		PX4_ERR("File open failed");
+		return false;
+	}
+
+	struct dirent *result = nullptr;
+	bool ret = true;
+
+	while (ret && (result = readdir(dp)) != nullptr) {
+#ifdef __PX4_NUTTX
+
+		if (result->d_type != DTYPE_FILE) {
+#else
+
+		if (result->d_type != DT_REG) {
+#endif
+			continue;
+		}
+
+		const unsigned name_length = strlen(result->d_name);
+
+		if (name_length < 4 || strcmp(&result->d_name[name_length - 4], ".mix") != 0) {
+			continue;
+		}
+
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/%s", MIXER_ONBOARD_PATH, result->d_name);
+
+		char buf[2048];
+
+		if (load_mixer_file(path, &buf[0], sizeof(buf)) != 0) {
+			PX4_ERR("failed to read %s", path);
+			ret = false;
+			break;
+		}
+
+		MixerGroup group(bench_callback, 0);
+		unsigned buf_length = strlen(buf);
+		group.load_from_buf(&buf[0], buf_length);
+
+		if (group.count() == 0) {
+			PX4_ERR("no mixers loaded from %s", path);
+			ret = false;
+			break;
+		}
+
+		uint16_t saturation;
+		ret = bench(result->d_name, group, saturation);
+	}
+
+	closedir(dp);
+
+	return ret;
+}
+
+unsigned MixerBench::mutate(char *buf, unsigned buf_size)
+{
+	strncpy(buf, fuzz_seeds[rand() % fuzz_seed_count], buf_size - 1);
+	buf[buf_size - 1] = '\0';
+
+	unsigned length = strlen(buf);
+	const unsigned mutations = 1 + rand() % 4;
+
+	for (unsigned m = 0; m < mutations; m++) {
+		const unsigned pos = (length > 0) ? rand() % length : 0;
+
+		switch (rand() % 6) {
+		case 0:
+			/* replace a character */
+			if (length > 0) {
+				buf[pos] = fuzz_alphabet[rand() % (sizeof(fuzz_alphabet) - 1)];
+			}
+
+			break;
+
+		case 1:
+
+			/* insert a character */
+			if (length + 1 < buf_size) {
+				memmove(&buf[pos + 1], &buf[pos], length - pos + 1);
+				buf[pos] = fuzz_alphabet[rand() % (sizeof(fuzz_alphabet) - 1)];
+				length++;
+			}
+
+			break;
+
+		case 2:
+
+			/* delete a character */
+			if (length > 0) {
+				memmove(&buf[pos], &buf[pos + 1], length - pos);
+				length--;
+			}
+
+			break;
+
+		case 3:
+
+			/* truncate */
+			length = pos;
+			buf[length] = '\0';
+			break;
+
+		case 4: {
+				/* insert a number out of the usual range */
+				static const char *const numbers[] = { "4294967295", "-2147483648", "99999999999", "-0", "32", "33" };
+				const char *number = numbers[rand() % (sizeof(numbers) / sizeof(numbers[0]))];
+				const unsigned number_length = strlen(number);
+
+				if (length + number_length < buf_size) {
+					memmove(&buf[pos + number_length], &buf[pos], length - pos + 1);
+					memcpy(&buf[pos], number, number_length);
+					length += number_length;
+				}
+			}
+			break;
+
+		default:
+
+			/* flip a bit */
+			if (length > 0) {
+				buf[pos] ^= (char)(1 << (rand() % 8));
+
+				if (buf[pos] == '\0') {
+					buf[pos] = ' ';
+				}
+			}
+
+			break;
+		}
+	}
+
+	return length;
+}
+
+bool MixerBench::fuzzMultirotorTextTest()
+{
+	char buf[256];
+	unsigned parsed = 0;
+
+	srand(0x52);
+
+	for (unsigned n = 0; n < _fuzz_iterations; n++) {
+		const unsigned length = mutate(buf, sizeof(buf));
+
+		/* the parsers must also cope with the buffer length cutting the text short */
+		unsigned buflen = (n % 4 == 0 && length > 0) ? rand() % length : length;
+		const unsigned buflen_in = buflen;
+
+		MultirotorMixer *mixer = MultirotorMixer::from_text(bench_callback, 0, buf, buflen);
+
+		if (mixer != nullptr) {
+			float outputs[output_max];
+			const unsigned mixed = mixer->mix(outputs, output_max);
+			bool finite = true;
+
+			for (unsigned i = 0; i < mixed && i < output_max; i++) {
+				finite = finite && PX4_ISFINITE(outputs[i]);
+			}
+
+			/* release the mixer before an assertion can return */
+			delete mixer;
+			parsed++;
+
+			ut_assert("consumed no more than available", buflen <= buflen_in);
+			ut_assert("rotor count", mixed <= output_max);
+			ut_assert("output finite", finite);
+		}
+	}
+
+	PX4_INFO("multirotor parser: %u of %u mutations accepted", parsed, _fuzz_iterations);
+
+	return true;
+}
+
+bool MixerBench::fuzzSimpleTextTest()
+{
+	char buf[256];
+	unsigned parsed = 0;
+
+	srand(0x4d);
+
+	for (unsigned n = 0; n < _fuzz_iterations; n++) {
+		const unsigned length = mutate(buf, sizeof(buf));
+
+		unsigned buflen = (n % 4 == 0 && length > 0) ? rand() % length : length;
+		const unsigned buflen_in = buflen;
+
+		SimpleMixer *mixer = SimpleMixer::from_text(bench_callback, 0, buf, buflen);
+
+		if (mixer != nullptr) {
+			float output;
+			mixer->mix(&output, 1);
+
+			delete mixer;
+			parsed++;
+
+			ut_assert("consumed no more than available", buflen <= buflen_in);
+		}
+	}
+
+	PX4_INFO("simple parser: %u of %u mutations accepted", parsed, _fuzz_iterations);
+
+	return true;
+}
@@ -2,6 +2,9 @@
 
 #include <px4_defines.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 class ParameterTest : public UnitTest
 {
@@ -30,14 +33,18 @@ private:
 
 	bool _set_all_int_parameters_to(int32_t value);
 
+	bool _read_file(const char *name, uint8_t *buf, size_t size, size_t *length);
+
 	// tests on the test parameters (TEST_RC_X, TEST_RC2_X, TEST_1, TEST_2, TEST_3)
 	bool SimpleFind();
+	bool FindAll();
 	bool ResetAll();
 	bool ResetAllExcludesOne();
 	bool ResetAllExcludesTwo();
 	bool ResetAllExcludesBoundaryCheck();
 	bool ResetAllExcludesWildcard();
 	bool exportImport();
+	bool journalAppend();
 
 	// tests on system parameters
 	// WARNING, can potentially trash your system
@@ -96,6 +103,21 @@ bool ParameterTest::SimpleFind()
 	return true;
 }
 
+bool ParameterTest::FindAll()
+{
+	// every parameter must be found by its name through the hash tables
+	for (unsigned i = 0; i < param_count(); i++) {
+		param_t param = param_for_index(i);
+		ut_compare("param_find returned a different parameter", param, param_find_no_notification(param_name(param)));
+	}
+
+	ut_compare("unknown parameter found", PARAM_INVALID, param_find_no_notification("TEST_NOT_A_PARAM"));
+	ut_compare("unknown parameter found", PARAM_INVALID, param_find_no_notification("TEST_1_"));
+	ut_compare("unknown parameter found", PARAM_INVALID, param_find_no_notification(""));
+
+	return true;
+}
+
 bool ParameterTest::ResetAll()
 {
 	_set_all_int_parameters_to(50);
@@ -307,6 +329,101 @@ bool ParameterTest::exportImport()
 	return ret;
 }
 
+bool ParameterTest::_read_file(const char *name, uint8_t *buf, size_t size, size_t *length)
+{
+	int fd = open(name, O_RDONLY);
+
+	if (fd < 0) {
+		PX4_ERR("open '%s' failed (%i)", name, errno);
+		return false;
+	}
+
+	ssize_t n = read(fd, buf, size);
+	close(fd);
+
+	if (n < 0 || (size_t)n == size) {
+		PX4_ERR("reading '%s' failed", name);
+		return false;
+	}
+
+	*length = n;
+	return true;
+}
+
+bool ParameterTest::journalAppend()
+{
+	static constexpr size_t FILE_SIZE_MAX = 8192;
+	const char *test_file_name = PX4_ROOTFSDIR "/fs/microsd/param_journal_test";
+
+	// remember the current default file, it is restored at the end
+	char *default_file_name = strdup(param_get_default_file());
+	uint8_t *first = (uint8_t *)malloc(FILE_SIZE_MAX);
+	uint8_t *second = (uint8_t *)malloc(FILE_SIZE_MAX);
+	size_t first_length = 0;
+	size_t second_length = 0;
+	bool ret = false;
+
+	if (default_file_name == nullptr || first == nullptr || second == nullptr) {
+		PX4_ERR("out of memory");
+		goto out;
+	}
+
+	unlink(test_file_name);
+	param_set_default_file(test_file_name);
+
+	// the first save writes the whole file and starts the journal
+	if (param_save_default() != PX4_OK || !_read_file(test_file_name, first, FILE_SIZE_MAX, &first_length)) {
+		PX4_ERR("first save failed");
+		goto out;
+	}
+
+	{
+		const int32_t value = 77;
+		param_set_no_notification(p2, &value);
+	}
+
+	// the second save only appends a record for TEST_1
+	if (param_save_default() != PX4_OK || !_read_file(test_file_name, second, FILE_SIZE_MAX, &second_length)) {
+		PX4_ERR("second save failed");
+		goto out;
+	}
+
+	if (second_length <= first_length) {
+		PX4_ERR("second save did not append (%u -> %u bytes)", (unsigned)first_length, (unsigned)second_length);
+		goto out;
+	}
+
+	// the file ends in a terminating record of the appended size, the document before it is unchanged
+	if (memcmp(first, second, first_length - (second_length - first_length)) != 0) {
+		PX4_ERR("second save rewrote the document");
+		goto out;
+	}
+
+	// the appended record is applied on load
+	param_reset(p2);
+
+	if (param_load_default() != PX4_OK) {
+		PX4_ERR("param_load_default failed");
+		goto out;
+	}
+
+	ret = _assert_parameter_int_value(p2, 77);
+
+out:
+	param_reset(p2);
+
+	if (default_file_name != nullptr) {
+		param_set_default_file(default_file_name);
+	}
+
+	unlink(test_file_name);
+	free(default_file_name);
+	free(first);
+	free(second);
+
+	return ret;
+}
+
 bool ParameterTest::exportImportAll()
 {
 	static constexpr float MAGIC_FLOAT_VAL = 0.217828f;
@@ -490,12 +607,14 @@ bool ParameterTest::run_tests()
 
 	ut_run_test(ResetAll);
 	ut_run_test(SimpleFind);
+	ut_run_test(FindAll);
 	ut_run_test(ResetAll);
 	ut_run_test(ResetAllExcludesOne);
 	ut_run_test(ResetAllExcludesTwo);
 	ut_run_test(ResetAllExcludesBoundaryCheck);
 	ut_run_test(ResetAllExcludesWildcard);
 	ut_run_test(exportImport);
+	ut_run_test(journalAppend);
 
 	// WARNING, can potentially trash your system
 #ifdef __PX4_POSIX
@@ -65,5 +65,29 @@ test_perf(int argc, char *argv[])
 	perf_free(cc);
 	perf_free(ec);
 
+	perf_counter_t hc = perf_alloc(PC_ELAPSED_HIST, "test_hist");
+
+	if (hc == NULL) {
+		printf("perf: histogram counter alloc failed\n");
+		return 1;
+	}
+
+	for (int i = 1; i <= 1000; i++) {
+		perf_set_elapsed(hc, i);
+	}
+
+	/* buckets are an upper bound within 25% */
+	uint32_t p50 = perf_percentile(hc, 0.5f);
+	uint32_t p99 = perf_percentile(hc, 0.99f);
+
+	if (perf_event_count(hc) != 1000 || p50 < 500 || p50 > 625 || p99 < 990 || p99 > 1000) {
+		printf("perf: unexpected percentiles p50 %u p99 %u\n", (unsigned)p50, (unsigned)p99);
+		perf_free(hc);
+		return 1;
+	}
+
+	perf_print_counter(hc);
+	perf_free(hc);
+
 	return OK;
 }
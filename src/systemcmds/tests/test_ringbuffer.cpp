@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_ringbuffer.cpp
+ * Tests for the ringbuffer used between sensor drivers and their readers.
+ */
+
+#include <unit_test.h>
+
+#include <drivers/device/ringbuffer.h>
+
+#include <pthread.h>
+#include <string.h>
+
+class RingBufferTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool _single();
+	bool _wrap();
+	bool _batch();
+	bool _force();
+	bool _threaded();
+
+	static void *_producer(void *arg);
+
+	static constexpr unsigned THREADED_ITEMS = 20000;
+};
+
+bool RingBufferTest::run_tests()
+{
+	ut_run_test(_single);
+	ut_run_test(_wrap);
+	ut_run_test(_batch);
+	ut_run_test(_force);
+	ut_run_test(_threaded);
+
+	return (_tests_failed == 0);
+}
+
+bool RingBufferTest::_single()
+{
+	ringbuffer::RingBuffer rb(4, sizeof(uint32_t));
+	uint32_t val = 0;
+
+	ut_assert_true(rb.empty());
+	ut_assert_false(rb.get(val));
+	ut_compare("size", rb.size(), 4);
+	ut_compare("space", rb.space(), 4);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		ut_assert_true(rb.put(i));
+	}
+
+	ut_assert_true(rb.full());
+	ut_assert_false(rb.put((uint32_t)4));
+	ut_compare("count", rb.count(), 4);
+
+	for (uint32_t i = 0; i < 4; i++) {
+		ut_assert_true(rb.get(val));
+		ut_compare("order", val, i);
+	}
+
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+bool RingBufferTest::_wrap()
+{
+	ringbuffer::RingBuffer rb(3, sizeof(uint32_t));
+	uint32_t next_put = 0;
+	uint32_t next_get = 0;
+	uint32_t val;
+
+	// move the indices around the end of the storage many times
+	for (unsigned i = 0; i < 50; i++) {
+		ut_assert_true(rb.put(next_put++));
+		ut_assert_true(rb.put(next_put++));
+		ut_assert_true(rb.get(val));
+		ut_compare("order", val, next_get++);
+		ut_assert_true(rb.get(val));
+		ut_compare("order", val, next_get++);
+	}
+
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+bool RingBufferTest::_batch()
+{
+	ringbuffer::RingBuffer rb(5, sizeof(uint32_t));
+	uint32_t in[8];
+	uint32_t out[8];
+
+	for (uint32_t i = 0; i < 8; i++) {
+		in[i] = i;
+	}
+
+	// a batch larger than the free space is truncated
+	ut_compare("put_n", rb.put_n(in, 8), 5);
+	ut_assert_true(rb.full());
+	ut_compare("put_n full", rb.put_n(in, 1), 0);
+
+	ut_compare("get_n", rb.get_n(out, 3), 3);
+	ut_assert_true(memcmp(out, in, 3 * sizeof(uint32_t)) == 0);
+
+	// this batch wraps around the end of the storage
+	ut_compare("put_n wrap", rb.put_n(&in[5], 3), 3);
+	ut_compare("count", rb.count(), 5);
+
+	memset(out, 0, sizeof(out));
+	ut_compare("get_n wrap", rb.get_n(out, 8), 5);
+	ut_assert_true(memcmp(out, &in[3], 5 * sizeof(uint32_t)) == 0);
+	ut_compare("get_n empty", rb.get_n(out, 8), 0);
+
+	// discarding a batch
+	ut_compare("put_n", rb.put_n(in, 4), 4);
+	ut_compare("get_n discard", rb.get_n(nullptr, 2), 2);
+	ut_compare("count", rb.count(), 2);
+	rb.flush();
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+bool RingBufferTest::_force()
+{
+	ringbuffer::RingBuffer rb(2, sizeof(uint32_t));
+	uint32_t val;
+
+	ut_assert_false(rb.force((uint32_t)1));
+	ut_assert_false(rb.force((uint32_t)2));
+
+	// the oldest item is dropped
+	ut_assert_true(rb.force((uint32_t)3));
+
+	ut_assert_true(rb.get(val));
+	ut_compare("oldest kept", val, 2);
+	ut_assert_true(rb.get(val));
+	ut_compare("newest", val, 3);
+	ut_assert_false(rb.get(val));
+
+	return true;
+}
+
+void *RingBufferTest::_producer(void *arg)
+{
+	ringbuffer::RingBuffer *rb = (ringbuffer::RingBuffer *)arg;
+	uint32_t batch[7];
+	uint32_t next = 0;
+
+	while (next < THREADED_ITEMS) {
+		unsigned num = 0;
+
+		while (num < 7 && next + num < THREADED_ITEMS) {
+			batch[num] = next + num;
+			num++;
+		}
+
+		// alternate between batches and single items
+		if (next % 2 == 0) {
+			next += rb->put_n(batch, num);
+
+		} else if (rb->put(batch[0])) {
+			next++;
+		}
+	}
+
+	return nullptr;
+}
+
+bool RingBufferTest::_threaded()
+{
+	ringbuffer::RingBuffer rb(16, sizeof(uint32_t));
+	pthread_t producer;
+
+	ut_assert_true(pthread_create(&producer, nullptr, &RingBufferTest::_producer, &rb) == 0);
+
+	uint32_t expected = 0;
+	bool in_order = true;
+
+	while (expected < THREADED_ITEMS) {
+		uint32_t out[5];
+		unsigned got = rb.get_n(out, 5);
+
+		for (unsigned i = 0; i < got; i++) {
+			if (out[i] != expected) {
+				in_order = false;
+			}
+
+			expected++;
+		}
+	}
+
+	pthread_join(producer, nullptr);
+
+	ut_assert_true(in_order);
+	ut_assert_true(rb.empty());
+
+	return true;
+}
+
+ut_declare_test_c(test_ringbuffer, RingBufferTest)
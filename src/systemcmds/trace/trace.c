@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.c
+ *
+ * Control the timeline trace and export it for chrome://tracing or Perfetto.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_log.h>
+#include <px4_module.h>
+#include <px4_trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+__EXPORT int trace_main(int argc, char *argv[]);
+
+
+static void print_usage(void)
+{
+	PRINT_MODULE_DESCRIPTION("Record uORB publications, poll wakeups, work queue items and perf regions "
+				 "into a ring and export them for chrome://tracing or ui.perfetto.dev (timestamps in hrt us)");
+
+	PRINT_MODULE_USAGE_NAME_SIMPLE("trace", "command");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Start recording");
+	PRINT_MODULE_USAGE_PARAM_INT('n', 65536, 1, 10000000, "Ring size in events, the oldest are overwritten", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("stop", "Stop recording");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("dump", "Stop recording and write the trace");
+	PRINT_MODULE_USAGE_ARG("<file>", "Output file (default: trace.json)", true);
+	PRINT_MODULE_USAGE_COMMAND("status");
+}
+
+
+int trace_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		print_usage();
+		return -1;
+	}
+
+	if (strcmp(argv[1], "start") == 0) {
+		unsigned num_events = 65536;
+		int myoptind = 1;
+		int ch;
+		const char *myoptarg = NULL;
+
+		while ((ch = px4_getopt(argc - 1, &argv[1], "n:", &myoptind, &myoptarg)) != EOF) {
+			switch (ch) {
+			case 'n':
+				num_events = strtoul(myoptarg, NULL, 10);
+				break;
+
+			default:
+				print_usage();
+				return -1;
+			}
+		}
+
+		int ret = px4_trace_start(num_events);
+
+		if (ret < 0) {
+			PX4_ERR("start failed (%i)", ret);
+			return -1;
+		}
+
+		return 0;
+
+	} else if (strcmp(argv[1], "stop") == 0) {
+		px4_trace_stop();
+		return 0;
+
+	} else if (strcmp(argv[1], "dump") == 0) {
+		const char *path = argc > 2 ? argv[2] : "trace.json";
+		int ret = px4_trace_dump(path);
+
+		if (ret < 0) {
+			PX4_ERR("dump to %s failed (%i)", path, ret);
+			return -1;
+		}
+
+		PX4_INFO("wrote %i events to %s", ret, path);
+		return 0;
+
+	} else if (strcmp(argv[1], "status") == 0) {
+		px4_trace_status();
+		return 0;
+	}
+
+	print_usage();
+	return -1;
+}